@@ -125,6 +125,11 @@ if ("${CMAKE_CXX_COMPILER_ID}" MATCHES "GNU" OR "${CMAKE_CXX_COMPILER_ID}" MATCH
         $<$<PLATFORM_ID:Darwin>:
             -pthread
         >
+
+        # Enables AVX kernels, e.g., for the cuboid expansion
+        $<$<BOOL:${OPTION_NATIVE_ARCH}>:
+            -march=native
+        >
         
         # Required for CMake < 3.1; should be removed if minimum required CMake version is raised.
         $<$<VERSION_LESS:${CMAKE_VERSION},3.1>:
@@ -0,0 +1,24 @@
+#version 330
+
+uniform isamplerBuffer granuleOrigins;
+uniform int granularity;
+
+in uint in_block;
+
+out int v_type;
+out int v_visibleFaces;
+
+void main()
+{
+    // Each granule of the chunk ranges belongs to a single chunk, see ChunkRanges
+    ivec3 chunkOrigin = texelFetch(granuleOrigins, gl_VertexID / granularity).xyz;
+    
+    // The position within the chunk is stored in 5 bits per axis, the visible faces in bits 16 to 21,
+    // and the type in the upper 8 bits
+    ivec3 position = chunkOrigin + ivec3(in_block & 31u, (in_block >> 5) & 31u, (in_block >> 10) & 31u);
+    
+    gl_Position = vec4(position, 1.0);
+    
+    v_type = int(in_block) >> 24;
+    v_visibleFaces = int((in_block >> 16) & 63u);
+}
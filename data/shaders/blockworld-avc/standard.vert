@@ -3,10 +3,13 @@
 in ivec4  in_positionAndType;
 
 out int v_type;
+out int v_visibleFaces;
 
 void main()
 {
     gl_Position = vec4(in_positionAndType.xyz, 1.0);
     
-    v_type = in_positionAndType.w;
+    // The type is stored in the lower 8 bits, the visible faces in the 6 bits above
+    v_type = (in_positionAndType.w << 24) >> 24;
+    v_visibleFaces = (in_positionAndType.w >> 8) & 63;
 }
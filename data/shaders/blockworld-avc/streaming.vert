@@ -0,0 +1,25 @@
+#version 330
+
+uniform isamplerBuffer pageOrigins;
+uniform int pageSize;
+
+// Position the blocks are drawn relative to, split into whole blocks and the rest
+uniform ivec3 streamOrigin;
+uniform vec3 streamFraction;
+
+in uint in_block;
+
+out int v_type;
+out int v_visibleFaces;
+
+void main()
+{
+    // Each page of the pool belongs to a single chunk; the block layout is the one of packed.vert
+    ivec3 chunkOrigin = texelFetch(pageOrigins, gl_VertexID / pageSize).xyz;
+    ivec3 position = chunkOrigin - streamOrigin + ivec3(in_block & 31u, (in_block >> 5) & 31u, (in_block >> 10) & 31u);
+    
+    gl_Position = vec4(vec3(position) - streamFraction, 1.0);
+    
+    v_type = int(in_block) >> 24;
+    v_visibleFaces = int((in_block >> 16) & 63u);
+}
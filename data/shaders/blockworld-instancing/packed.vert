@@ -0,0 +1,40 @@
+#version 330
+
+uniform mat4 viewProjection;
+uniform isamplerBuffer granuleOrigins;
+uniform int granularity;
+
+in vec3 in_vertex;
+in vec3 in_normal;
+in uint in_block;
+
+uniform float blockSize;
+
+flat out vec3 g_normal;
+flat out int  g_type;
+     out vec3 g_localCoord;
+
+void main()
+{
+    // Six vertices per face in the order of the face bits; hidden faces collapse to a point and are never rasterized,
+    // as do all faces of the free room between the chunks
+    int visibleFaces = int((in_block >> 16) & 63u);
+    
+    if ((visibleFaces & (1 << (gl_VertexID / 6))) == 0)
+    {
+        gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+    
+    // Each granule of the chunk ranges belongs to a single chunk, see ChunkRanges
+    ivec3 chunkOrigin = texelFetch(granuleOrigins, gl_InstanceID / granularity).xyz;
+    
+    // The position within the chunk is stored in 5 bits per axis and the type in the upper 8 bits
+    ivec3 position = chunkOrigin + ivec3(in_block & 31u, (in_block >> 5) & 31u, (in_block >> 10) & 31u);
+    
+    gl_Position = viewProjection * vec4((in_vertex + vec3(position)) * blockSize, 1.0);
+    
+    g_normal = in_normal;
+    g_type = int(in_block) >> 24;
+    g_localCoord = in_vertex * 2.0;
+}
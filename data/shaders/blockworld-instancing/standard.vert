@@ -14,9 +14,18 @@ flat out int  g_type;
 
 void main()
 {
+    // Six vertices per face in the order of the face bits; hidden faces collapse to a point and are never rasterized
+    int visibleFaces = (in_positionAndType.w >> 8) & 63;
+    
+    if ((visibleFaces & (1 << (gl_VertexID / 6))) == 0)
+    {
+        gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+    
     gl_Position = viewProjection * vec4((in_vertex + vec3(in_positionAndType.xyz)) * blockSize, 1.0);
     
     g_normal = in_normal;
-    g_type = in_positionAndType.w;
+    g_type = (in_positionAndType.w << 24) >> 24;
     g_localCoord = in_vertex * 2.0;
 }
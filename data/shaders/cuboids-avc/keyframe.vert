@@ -0,0 +1,39 @@
+#version 330
+
+// Both keyframes of each cuboid, in the attribute order of standard.vert
+layout (location = 0) in vec2  in_center0;
+layout (location = 1) in vec2  in_extent0;
+layout (location = 2) in vec2  in_heightRange0;
+layout (location = 3) in float in_colorValue0;
+layout (location = 4) in vec2  in_center1;
+layout (location = 5) in vec2  in_extent1;
+layout (location = 6) in vec2  in_heightRange1;
+layout (location = 7) in float in_colorValue1;
+layout (location = 8) in float in_rotation0;
+layout (location = 9) in float in_rotation1;
+
+uniform sampler1D gradient;
+
+// Blend weight of the second keyframe
+uniform float interpolation;
+
+out vec2 v_extent;
+out vec3 v_color;
+out float v_height;
+out float v_rotation;
+
+void main()
+{
+    vec2 center = mix(in_center0, in_center1, interpolation);
+    vec2 heightRange = mix(in_heightRange0, in_heightRange1, interpolation);
+    
+    gl_Position = vec4(center.x, heightRange.x, center.y, 1.0);
+    
+    v_extent = mix(in_extent0, in_extent1, interpolation);
+    v_color = texture(gradient, mix(in_colorValue0, in_colorValue1, interpolation)).rgb;
+    v_height = heightRange.y;
+    
+    // Along the shorter arc, as a cuboid looks the same after a full turn
+    float turn = in_rotation1 - in_rotation0;
+    v_rotation = in_rotation0 + (turn - 6.28318530718 * round(turn / 6.28318530718)) * interpolation;
+}
@@ -0,0 +1,33 @@
+#version 330
+
+in vec2  in_center;
+in vec2  in_extent;
+in vec2  in_heightRange;
+in float in_colorValue;
+in float in_rotation;
+
+uniform sampler1D gradient;
+
+// World space ranges of the normalized attributes
+uniform vec3 origin;
+uniform vec3 positionScale;
+uniform vec3 extentScale;
+
+out vec2 v_extent;
+out vec3 v_color;
+out float v_height;
+out float v_rotation;
+
+void main()
+{
+    vec2 center = origin.xz + in_center * positionScale.xz;
+    float bottom = origin.y + in_heightRange.x * positionScale.y;
+    
+    gl_Position = vec4(center.x, bottom, center.y, 1.0);
+    
+    // Extents are stored as square roots
+    v_extent = in_extent * in_extent * extentScale.xz;
+    v_color = texture(gradient, in_colorValue).rgb;
+    v_height = in_heightRange.y * in_heightRange.y * extentScale.y;
+    v_rotation = in_rotation * 6.28318530718;
+}
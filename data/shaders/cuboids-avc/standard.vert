@@ -4,12 +4,14 @@ in vec2  in_center;
 in vec2  in_extent;
 in vec2  in_heightRange;
 in float in_colorValue;
+in float in_rotation;
 
 uniform sampler1D gradient;
 
 out vec2 v_extent;
 out vec3 v_color;
 out float v_height;
+out float v_rotation;
 
 void main()
 {
@@ -18,4 +20,5 @@ void main()
     v_extent = in_extent;
     v_color = texture(gradient, in_colorValue).rgb;
     v_height = in_heightRange.y;
+    v_rotation = in_rotation;
 }
@@ -7,6 +7,7 @@ in vec3  in_normal;
 in vec3  in_position;
 in vec3  in_scale;
 in float in_colorValue;
+in float in_rotation;
 
 uniform sampler1D gradient;
 
@@ -15,8 +16,13 @@ flat out vec3 g_normal;
 
 void main()
 {
-    gl_Position = viewProjection * vec4(in_vertex * in_scale + in_position, 1.0);
+    // Yaw around the vertical axis
+    float c = cos(in_rotation);
+    float s = sin(in_rotation);
+    mat3 orientation = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c);
+    
+    gl_Position = viewProjection * vec4(orientation * (in_vertex * in_scale) + in_position, 1.0);
     
     g_color = texture(gradient, in_colorValue).rgb;
-    g_normal = in_normal;
+    g_normal = orientation * in_normal;
 }
@@ -11,6 +11,7 @@
 #include <glbinding/gl/gl.h>
 
 #include "common.h"
+#include "PrimitiveGrid.h"
 
 #include "ArcVertexCloud.h"
 //#include "ArcTriangles.h"
@@ -47,10 +48,22 @@ ArcRendering::~ArcRendering()
 {
 }
 
+Implementation * ArcRendering::createImplementation(size_t index)
+{
+    switch (index)
+    {
+    case 0: return new ArcVertexCloud(false);
+    case 1: return new ArcVertexCloud(true);
+    default: return nullptr;
+    }
+}
+
 void ArcRendering::onInitialize()
 {
-    addImplementation(new ArcVertexCloud(false));
-    addImplementation(new ArcVertexCloud(true));
+    for (auto index = size_t(0); auto implementation = createImplementation(index); ++index)
+    {
+        addImplementation(implementation);
+    }
 
     glGenTextures(1, &m_gradientTexture);
 
@@ -77,26 +90,25 @@ void ArcRendering::onDeinitialize()
 
 void ArcRendering::onCreateGeometry()
 {
-    const auto arcGridSize = static_cast<std::size_t>(m_gridSize);
-    const auto arcCount = arcGridSize * arcGridSize * arcGridSize;
-    const auto worldScale = glm::vec3(1.0f) / glm::vec3(arcGridSize, arcGridSize, arcGridSize);
+    createGeometry(m_primitiveCount, geometryImplementations());
+}
 
+void ArcRendering::createGeometry(size_t arcCount, const std::vector<Implementation *> & implementations)
+{
+    auto grid = PrimitiveGrid(arcCount);
+    const auto worldScale = glm::vec3(1.0f) / glm::vec3(grid.size());
 
-    for (auto implementation : m_implementations)
+    for (auto implementation : implementations)
     {
         implementation->resize(arcCount);
     }
 
-    std::array<std::vector<float>, 7> noise;
-    for (auto i = size_t(0); i < noise.size(); ++i)
-    {
-        noise[i] = loadNoise("/noise-"+std::to_string(arcGridSize)+"-"+std::to_string(i)+".raw");
-    }
+    grid.loadNoise(7);
 
 //#pragma omp parallel for
     for (size_t i = 0; i < arcCount; ++i)
     {
-        const auto position = glm::ivec3(i % arcGridSize, (i / arcGridSize) % arcGridSize, i / arcGridSize / arcGridSize);
+        const auto position = grid.position(i);
         const auto offset = glm::vec3(
             (position.y + position.z) % 2 ? gridOffset : 0.0f,
             (position.x + position.z) % 2 ? gridOffset : 0.0f,
@@ -106,20 +118,20 @@ void ArcRendering::onCreateGeometry()
         Arc a;
         a.center = glm::vec2(-0.5f, -0.5f) + (glm::vec2(position.x, position.z) + glm::vec2(offset.x, offset.z)) * glm::vec2(worldScale.x, worldScale.z);
 
-        a.heightRange.x = -0.5f + (position.y + offset.y - 0.5f * noise[0][i]) * worldScale.y;
-        a.heightRange.y = -0.5f + (position.y + offset.y + 0.5f * noise[0][i]) * worldScale.y;
+        a.heightRange.x = -0.5f + (position.y + offset.y - 0.5f * grid.noise(0, i)) * worldScale.y;
+        a.heightRange.y = -0.5f + (position.y + offset.y + 0.5f * grid.noise(0, i)) * worldScale.y;
 
-        a.angleRange.x = -0.5f * glm::pi<float>() + 0.75f * glm::pi<float>() * noise[1][i];
-        a.angleRange.y = 0.25f * glm::pi<float>() + 0.5f * glm::pi<float>() * noise[2][i];
+        a.angleRange.x = -0.5f * glm::pi<float>() + 0.75f * glm::pi<float>() * grid.noise(1, i);
+        a.angleRange.y = 0.25f * glm::pi<float>() + 0.5f * glm::pi<float>() * grid.noise(2, i);
 
-        a.radiusRange.x = 0.3f * noise[3][i] * worldScale.x;
-        a.radiusRange.y = a.radiusRange.x + 0.5f * noise[4][i] * worldScale.x;
+        a.radiusRange.x = 0.3f * grid.noise(3, i) * worldScale.x;
+        a.radiusRange.y = a.radiusRange.x + 0.5f * grid.noise(4, i) * worldScale.x;
 
-        a.colorValue = noise[5][i];
+        a.colorValue = grid.noise(5, i);
 
-        a.tessellationCount = glm::round(1.0f / worldScale.x * (a.angleRange.y - a.angleRange.x) * a.radiusRange.y * glm::mix(4.0f, 64.0f, noise[6][i]) / (2.0f * glm::pi<float>()));
+        a.tessellationCount = glm::round(1.0f / worldScale.x * (a.angleRange.y - a.angleRange.x) * a.radiusRange.y * glm::mix(4.0f, 64.0f, grid.noise(6, i)) / (2.0f * glm::pi<float>()));
 
-        for (auto implementation : m_implementations)
+        for (auto implementation : implementations)
         {
             static_cast<ArcImplementation*>(implementation)->setArc(i, a);
         }
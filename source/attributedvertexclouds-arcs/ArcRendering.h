@@ -1,4 +1,6 @@
 
+#pragma once
+
 #include <glbinding/gl/types.h>
 
 #include "Rendering.h"
@@ -10,6 +12,12 @@ public:
     ArcRendering();
     virtual ~ArcRendering();
 
+    // Fills the implementations with the given number of arcs on a grid; needs no GL context
+    static void createGeometry(size_t primitiveCount, const std::vector<Implementation *> & implementations);
+
+    // Creates the technique at the given position of the demo's list, or nullptr past its end; needs no GL context
+    static Implementation * createImplementation(size_t index);
+
 protected:
     gl::GLuint m_gradientTexture;
 
@@ -22,6 +22,11 @@ ArcVertexCloud::ArcVertexCloud(bool useAlternativeShaders)
 
 ArcVertexCloud::~ArcVertexCloud()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteVertexArrays(1, &m_vao);
     glDeleteShader(m_vertexShader);
@@ -214,6 +219,21 @@ void ArcVertexCloud::resize(size_t count)
     m_tessellationCount.resize(count);
 }
 
+size_t ArcVertexCloud::cpuByteSize() const
+{
+    return containerByteSize(m_center)
+        + containerByteSize(m_heightRange)
+        + containerByteSize(m_angleRange)
+        + containerByteSize(m_radiusRange)
+        + containerByteSize(m_colorValue)
+        + containerByteSize(m_tessellationCount);
+}
+
+std::vector<gl::GLuint> ArcVertexCloud::buffers() const
+{
+    return { m_vertices };
+}
+
 void ArcVertexCloud::onRender()
 {
     glBindVertexArray(m_vao);
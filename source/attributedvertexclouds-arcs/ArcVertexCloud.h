@@ -30,9 +30,12 @@ public:
     virtual size_t byteSize() const override;
     virtual size_t vertexByteSize() const override;
     virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
 
     virtual void resize(size_t count) override;
 
+    virtual std::vector<gl::GLuint> buffers() const override;
+
     virtual gl::GLuint program() const override;
 public:
     bool m_alternativeShaders;
@@ -1,5 +1,7 @@
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 // C++ library for creating windows with OpenGL contexts and receiving 
 // input and events http://www.glfw.org/ 
@@ -11,6 +13,9 @@
 #include <glbinding/gl/gl.h>
 #include <glbinding/glbinding.h>
 
+#include "common.h"
+#include "HeadlessContext.h"
+
 #include "ArcRendering.h"
 
 
@@ -63,6 +68,21 @@ void keyCallback(GLFWwindow * /*window*/, int key, int /*scancode*/, int action,
         rendering.spaceMeasurement();
     }
 
+    if (key == GLFW_KEY_F9 && action == GLFW_RELEASE)
+    {
+        rendering.toggleContinuousTiming();
+    }
+
+    if (key == GLFW_KEY_F10 && action == GLFW_RELEASE)
+    {
+        rendering.toggleTracing();
+    }
+
+    if (key == GLFW_KEY_F11 && action == GLFW_RELEASE)
+    {
+        rendering.toggleRecording();
+    }
+
     if (key == GLFW_KEY_F12 && action == GLFW_RELEASE)
     {
         rendering.takeScreenshot();
@@ -104,13 +124,23 @@ void errorCallback(int errnum, const char * errmsg)
 
 int main(int argc, char ** argv)
 {
-    if (!glfwInit())
-    {
-        return 1;
-    }
-
-    int gridSize = 16;
+    size_t primitiveCount = rendering.gridPrimitiveCount(16);
     bool fullScreen = false;
+    bool benchmark = false;
+    bool trace = false;
+    bool record = false;
+    std::string replayFilename;
+    std::string cameraPathFilename;
+    std::vector<size_t> benchmarkPrimitiveCounts;
+    bool sweep = false;
+    size_t sweepMinPrimitiveCount = 0;
+    size_t sweepMaxPrimitiveCount = 0;
+    size_t sweepSteps = 0;
+    std::string saveBaselineFilename;
+    std::string compareBaselineFilename;
+    double regressionThreshold = 0.05;
+    bool strictComparison = false;
+    int exitCode = 0;
 
     for (int i = 1; i < argc; ++i)
     {
@@ -120,32 +150,108 @@ int main(int argc, char ** argv)
         {
             fullScreen = true;
         }
+        else if (argument == "--benchmark")
+        {
+            benchmark = true;
+        }
+        else if (argument == "--trace")
+        {
+            trace = true;
+        }
+        else if (argument == "--record")
+        {
+            record = true;
+        }
+        else if (argument == "--replay" && i + 1 < argc)
+        {
+            replayFilename = argv[++i];
+        }
+        else if (argument == "--camera-path" && i + 1 < argc)
+        {
+            cameraPathFilename = argv[++i];
+        }
+        else if (argument == "--save-baseline" && i + 1 < argc)
+        {
+            benchmark = true;
+            saveBaselineFilename = argv[++i];
+        }
+        else if (argument == "--compare" && i + 1 < argc)
+        {
+            benchmark = true;
+            compareBaselineFilename = argv[++i];
+        }
+        else if (argument == "--strict")
+        {
+            strictComparison = true;
+        }
+        else if (argument == "--threshold" && i + 1 < argc)
+        {
+            auto percent = 0.0;
+
+            if (!parseNonNegative(argv[++i], percent))
+            {
+                std::cerr << "Regression thresholds have to be non-negative percentages, e.g., 5 or 2.5" << std::endl;
+
+                glfwTerminate();
+
+                return 1;
+            }
+
+            regressionThreshold = percent / 100.0;
+        }
+        else if (argument == "--count" && i + 1 < argc)
+        {
+            primitiveCount = parseCount(argv[++i]);
+            benchmarkPrimitiveCounts.push_back(primitiveCount);
+        }
+        else if (argument == "--sweep" && i + 3 < argc)
+        {
+            sweep = true;
+            sweepMinPrimitiveCount = parseCount(argv[++i]);
+            sweepMaxPrimitiveCount = parseCount(argv[++i]);
+            sweepSteps = parseCount(argv[++i]);
+        }
         else if (argument == "xxs")
         {
-            gridSize = 2;
+            primitiveCount = rendering.gridPrimitiveCount(2);
+            benchmarkPrimitiveCounts.push_back(primitiveCount);
         }
         else if (argument == "xs")
         {
-            gridSize = 8;
+            primitiveCount = rendering.gridPrimitiveCount(8);
+            benchmarkPrimitiveCounts.push_back(primitiveCount);
         }
         else if (argument == "s")
         {
-            gridSize = 16;
+            primitiveCount = rendering.gridPrimitiveCount(16);
+            benchmarkPrimitiveCounts.push_back(primitiveCount);
         }
         else if (argument == "m")
         {
-            gridSize = 32;
+            primitiveCount = rendering.gridPrimitiveCount(32);
+            benchmarkPrimitiveCounts.push_back(primitiveCount);
         }
         else if (argument == "l")
         {
-            gridSize = 48;
+            primitiveCount = rendering.gridPrimitiveCount(48);
+            benchmarkPrimitiveCounts.push_back(primitiveCount);
         }
         else if (argument == "xl")
         {
-            gridSize = 100;
+            primitiveCount = rendering.gridPrimitiveCount(100);
+            benchmarkPrimitiveCounts.push_back(primitiveCount);
         }
     }
 
+    if (primitiveCount == 0 || (sweep && (sweepMinPrimitiveCount == 0 || sweepMaxPrimitiveCount < sweepMinPrimitiveCount || sweepSteps == 0)))
+    {
+        std::cerr << "Primitive counts have to be positive, e.g., 250000, 10k or 2M" << std::endl;
+
+        glfwTerminate();
+
+        return 1;
+    }
+
     std::cout << "Choose Techniques" << std::endl;
     std::cout << " [1] Attributed Vertex Cloud (gs instancing)" << std::endl;
     std::cout << " [2] Attributed Vertex Cloud (tes instancing)" << std::endl;
@@ -160,6 +266,20 @@ int main(int argc, char ** argv)
     std::cout << " [F6] FPS Measurement" << std::endl;
     std::cout << " [F7] Performance Measurement" << std::endl;
     std::cout << " [F8] Memory Comparison" << std::endl;
+    std::cout << " [F9] Toggle Continuous GPU Timing" << std::endl;
+    std::cout << " [F10] Start/Stop Trace Recording" << std::endl;
+    std::cout << " [F11] Start/Stop Interaction Recording" << std::endl;
+    std::cout << " [--benchmark] Offscreen run over all techniques, primitive counts and camera presets" << std::endl;
+    std::cout << " [--count <n>] Number of primitives instead of a grid size preset, e.g., 10k or 200M" << std::endl;
+    std::cout << " [--sweep <min> <max> <steps>] Benchmark primitive counts from min to max and fit their scaling" << std::endl;
+    std::cout << " [--trace] Record a trace from startup on" << std::endl;
+    std::cout << " [--record] Record the interaction from startup on" << std::endl;
+    std::cout << " [--replay <file>] Replay a recorded interaction and quit" << std::endl;
+    std::cout << " [--camera-path <file>] Keyframes replacing the camera path of preset [F1]" << std::endl;
+    std::cout << " [--save-baseline <file>] Benchmark and store the results as baseline" << std::endl;
+    std::cout << " [--compare <file>] Benchmark and fail on regressions against a baseline" << std::endl;
+    std::cout << " [--threshold <percent>] Tolerated regression, defaults to 5" << std::endl;
+    std::cout << " [--strict] Also fail on baseline entries that were not benchmarked" << std::endl;
     std::cout << std::endl;
     std::cout << "Debugging" << std::endl;
     std::cout << " [r] Enable/Disable rasterizer" << std::endl;
@@ -168,39 +288,71 @@ int main(int argc, char ** argv)
 
     glfwSetErrorCallback(errorCallback);
 
-    glfwDefaultWindowHints();
-
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, true);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Benchmarks render into offscreen framebuffers only, so with EGL they need no window system
+    const auto headless = (benchmark || sweep) && HeadlessContext::available();
 
+    HeadlessContext headlessContext;
     GLFWwindow * window = nullptr;
 
-    if (fullScreen)
+    int width = canvasWidth;
+    int height = canvasHeight;
+
+    if (headless)
     {
-        const GLFWvidmode * mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+        if (!headlessContext.create(4, 0))
+        {
+            return 2;
+        }
 
-        window = glfwCreateWindow(mode->width, mode->height, "", glfwGetPrimaryMonitor(), nullptr);
+        glbinding::initialize(HeadlessContext::procAddress, false);
     }
     else
     {
-        window = glfwCreateWindow(canvasWidth, canvasHeight, "", nullptr, nullptr);
-    }
+        if (!glfwInit())
+        {
+            return 1;
+        }
 
-    if (!window)
-    {
-        glfwTerminate();
+        glfwDefaultWindowHints();
 
-        return 2;
-    }
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, true);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        if (benchmark || sweep)
+        {
+            // The benchmark renders into an offscreen framebuffer, the window is never shown
+            glfwWindowHint(GLFW_VISIBLE, false);
+        }
+
+        if (fullScreen && !benchmark && !sweep)
+        {
+            const GLFWvidmode * mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
 
-    glfwSetFramebufferSizeCallback(window, resizeCallback);
-    glfwSetKeyCallback(window, keyCallback);
+            window = glfwCreateWindow(mode->width, mode->height, "", glfwGetPrimaryMonitor(), nullptr);
+        }
+        else
+        {
+            window = glfwCreateWindow(canvasWidth, canvasHeight, "", nullptr, nullptr);
+        }
+
+        if (!window)
+        {
+            glfwTerminate();
+
+            return 2;
+        }
 
-    glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, resizeCallback);
+        glfwSetKeyCallback(window, keyCallback);
 
-    glbinding::initialize(glfwGetProcAddress, false);
+        glfwMakeContextCurrent(window);
+
+        glbinding::initialize(glfwGetProcAddress, false);
+
+        glfwGetFramebufferSize(window, &width, &height);
+    }
 
 #ifndef NDEBUG
     glbinding::setAfterCallback([](const glbinding::FunctionCall & functionCall) {
@@ -215,29 +367,103 @@ int main(int argc, char ** argv)
 
     glbinding::setCallbackMaskExcept(glbinding::CallbackMask::After, { "glGetError" });
 
-    int width, height;
-    glfwGetFramebufferSize(window, &width, &height);
-
-    rendering.setGridSize(gridSize);
     rendering.resize(width, height);
-    rendering.initialize();
 
-    while (!glfwWindowShouldClose(window)) // main loop
+    if (trace)
+    {
+        rendering.startTracing();
+    }
+
+    if (!cameraPathFilename.empty() && !rendering.loadCameraPath(cameraPathFilename))
+    {
+        glfwTerminate();
+
+        return 3;
+    }
+
+    if (benchmark || sweep)
+    {
+        if (sweep)
+        {
+            rendering.sweep(sweepMinPrimitiveCount, sweepMaxPrimitiveCount, sweepSteps);
+        }
+        else
+        {
+            if (benchmarkPrimitiveCounts.empty())
+            {
+                for (const auto gridSize : { 2, 8, 16, 32, 48, 100 })
+                {
+                    benchmarkPrimitiveCounts.push_back(rendering.gridPrimitiveCount(gridSize));
+                }
+            }
+
+            rendering.benchmark(benchmarkPrimitiveCounts);
+        }
+
+        rendering.stopTracing();
+
+        if (!saveBaselineFilename.empty() && !rendering.saveBaseline(saveBaselineFilename))
+        {
+            exitCode = 3;
+        }
+
+        if (!compareBaselineFilename.empty())
+        {
+            const auto comparison = rendering.compareToBaseline(compareBaselineFilename, regressionThreshold, strictComparison);
+
+            // Unreadable files are a broken setup rather than a regression
+            if (comparison == BaselineComparison::Unreadable)
+            {
+                exitCode = 3;
+            }
+            else if (comparison == BaselineComparison::Regressed)
+            {
+                exitCode = 4;
+            }
+        }
+    }
+    else
     {
-        glfwPollEvents();
+        rendering.setPrimitiveCount(primitiveCount);
 
-        rendering.render();
+        if (!replayFilename.empty() && !rendering.startReplay(replayFilename))
+        {
+            glfwTerminate();
 
-        glfwSwapBuffers(window);
+            return 3;
+        }
+
+        if (record)
+        {
+            rendering.startRecording();
+        }
+
+        rendering.initialize();
+
+        while (!glfwWindowShouldClose(window) && !rendering.replayFinished()) // main loop
+        {
+            glfwPollEvents();
+
+            rendering.render();
+
+            glfwSwapBuffers(window);
+        }
+
+        rendering.stopRecording();
+        rendering.stopTracing();
+        rendering.deinitialize();
     }
 
-    rendering.deinitialize();
+    if (window)
+    {
+        glfwMakeContextCurrent(nullptr);
 
-    glfwMakeContextCurrent(nullptr);
+        glfwDestroyWindow(window);
+    }
 
-    glfwDestroyWindow(window);
+    headlessContext.destroy();
 
     glfwTerminate();
 
-    return 0;
+    return exitCode;
 }
@@ -2,7 +2,55 @@
 #include "Block.h"
 
 
+namespace
+{
+
+
+// Per face: the normal and two tangents u and v with cross(u, v) = normal
+static const glm::vec3 faceAxes[Block::faceCount][3] = {
+    { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+    { glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+    { glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f) },
+    { glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+    { glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+    { glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f) }
+};
+
+
+} // namespace
+
+
+const size_t Block::faceCount;
+
 Block::Block()
 : type(0)
+, visibleFaces(AllFaces)
+{
+}
+
+glm::vec3 Block::faceNormal(size_t face)
 {
+    return faceAxes[face][0];
+}
+
+glm::vec3 Block::faceCorner(size_t face, size_t corner)
+{
+    const auto u = (corner & 1) ? 1.0f : -1.0f;
+    const auto v = (corner & 2) ? 1.0f : -1.0f;
+
+    return faceAxes[face][0] + u * faceAxes[face][1] + v * faceAxes[face][2];
+}
+
+int Block::packedType() const
+{
+    return (type & 0xff) | (visibleFaces << 8);
+}
+
+unsigned int Block::packedBlock() const
+{
+    const auto x = static_cast<unsigned int>(position.x) & 31u;
+    const auto y = static_cast<unsigned int>(position.y) & 31u;
+    const auto z = static_cast<unsigned int>(position.z) & 31u;
+
+    return x | (y << 5) | (z << 10) | (static_cast<unsigned int>(visibleFaces) << 16) | ((static_cast<unsigned int>(type) & 0xffu) << 24);
 }
@@ -7,8 +7,39 @@
 class Block
 {
 public:
+    // Bits of visibleFaces; bit i belongs to face i of faceNormal() and faceCorner()
+    enum Face
+    {
+        PositiveX = 1 << 0,
+        NegativeX = 1 << 1,
+        PositiveY = 1 << 2,
+        NegativeY = 1 << 3,
+        PositiveZ = 1 << 4,
+        NegativeZ = 1 << 5,
+        AllFaces = (1 << 6) - 1
+    };
+
+    static const size_t faceCount = 6;
+
     Block();
 
+    static glm::vec3 faceNormal(size_t face);
+
+    // Corners of a face in local coordinates within [-1, 1], in triangle strip order
+    // and counter-clockwise when seen from outside
+    static glm::vec3 faceCorner(size_t face, size_t corner);
+
+    // Type in the lower 8 bits (sign-extended when decoded) and the visible faces in the 6 bits above,
+    // as the vertex cloud and instancing techniques store it next to the position
+    int packedType() const;
+
+    // The whole block in 32 bits: the position modulo 32 (within its chunk of a BlockWorld) in 5 bits per axis,
+    // the visible faces in bits 16 to 21, and the type in the upper 8 bits, as the packed techniques store it
+    unsigned int packedBlock() const;
+
     glm::ivec3 position;
     int type;
+
+    // Faces that do not border a solid block, see Face; the world is padded with air, so faces at its end are visible
+    int visibleFaces;
 };
@@ -0,0 +1,634 @@
+
+#include "BlockWorld.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <glm/common.hpp>
+
+
+namespace
+{
+
+
+static const auto chunkVolume = static_cast<size_t>(BlockWorld::chunkSize) * BlockWorld::chunkSize * BlockWorld::chunkSize;
+static const auto columnCount = static_cast<size_t>(BlockWorld::chunkSize) * BlockWorld::chunkSize;
+
+// Offsets to the neighbor behind each face, in the order of the face bits
+static const glm::ivec3 neighborOffsets[Block::faceCount] = {
+    glm::ivec3(1, 0, 0), glm::ivec3(-1, 0, 0),
+    glm::ivec3(0, 1, 0), glm::ivec3(0, -1, 0),
+    glm::ivec3(0, 0, 1), glm::ivec3(0, 0, -1)
+};
+
+
+// Largest multiple of the chunk size up to value
+int chunkFloor(int value, int chunkSize)
+{
+    return value >= 0 ? value / chunkSize * chunkSize : -((chunkSize - 1 - value) / chunkSize * chunkSize);
+}
+
+
+} // namespace
+
+
+const int BlockWorld::chunkSize;
+const int BlockWorld::paddedChunkSize;
+const int BlockWorld::airType;
+
+
+BlockWorld::BlockWorld()
+: m_lower(0)
+, m_extent(0)
+, m_origin(0)
+, m_chunks(0)
+, m_threshold(0)
+{
+}
+
+void BlockWorld::reset(const glm::ivec3 & lower, const glm::ivec3 & extent)
+{
+    m_lower = lower;
+    m_extent = extent;
+    m_origin = glm::ivec3(chunkFloor(lower.x, chunkSize), chunkFloor(lower.y, chunkSize), chunkFloor(lower.z, chunkSize));
+    m_chunks = (lower + extent - m_origin + glm::ivec3(chunkSize - 1)) / chunkSize;
+
+    m_stored.clear();
+    m_dirty.clear();
+    m_chunkIndices.clear();
+}
+
+void BlockWorld::generate(const std::function<int(const glm::ivec3 &)> & type)
+{
+    generateChunks([this, &type](const glm::ivec3 & origin, std::vector<signed char> & types) {
+        auto begin = glm::ivec3();
+        auto end = glm::ivec3();
+        chunkBounds(origin, begin, end);
+
+        for (auto z = begin.z; z < end.z; ++z)
+        {
+            for (auto y = begin.y; y < end.y; ++y)
+            {
+                for (auto x = begin.x; x < end.x; ++x)
+                {
+                    const auto position = glm::ivec3(x, y, z);
+
+                    types[cellIndex(position - origin)] = static_cast<signed char>(type(position));
+                }
+            }
+        }
+
+        return true;
+    });
+}
+
+void BlockWorld::generateChunks(const std::function<bool(const glm::ivec3 &, std::vector<signed char> &)> & fill)
+{
+    const auto gridCount = static_cast<size_t>(m_chunks.x) * m_chunks.y * m_chunks.z;
+
+    auto generated = std::vector<std::pair<size_t, Chunk>>();
+
+#pragma omp parallel
+    {
+        auto types = std::vector<signed char>(chunkVolume, static_cast<signed char>(airType));
+        auto local = std::vector<std::pair<size_t, Chunk>>();
+
+#pragma omp for schedule(dynamic, 64) nowait
+        for (long index = 0; index < static_cast<long>(gridCount); ++index)
+        {
+            const auto origin = gridOrigin(index);
+
+            if (!fill(origin, types))
+            {
+                continue;
+            }
+
+            auto begin = glm::ivec3();
+            auto end = glm::ivec3();
+            chunkBounds(origin, begin, end);
+
+            // Chunks at the bounds keep air outside of them, row by row along x
+            if (end - begin != glm::ivec3(chunkSize))
+            {
+                const auto first = begin - origin;
+                const auto last = end - origin;
+
+                for (auto z = 0; z < chunkSize; ++z)
+                {
+                    for (auto y = 0; y < chunkSize; ++y)
+                    {
+                        const auto row = types.begin() + cellIndex(glm::ivec3(0, y, z));
+                        const auto inside = y >= first.y && y < last.y && z >= first.z && z < last.z;
+
+                        std::fill(row, row + (inside ? first.x : chunkSize), static_cast<signed char>(airType));
+                        std::fill(row + (inside ? last.x : chunkSize), row + chunkSize, static_cast<signed char>(airType));
+                    }
+                }
+            }
+
+            auto chunk = encode(origin, types);
+
+            std::fill(types.begin(), types.end(), static_cast<signed char>(airType));
+
+            if (chunk.runs.empty() && chunk.uniformType == airType)
+            {
+                continue;
+            }
+
+            local.push_back(std::make_pair(static_cast<size_t>(index), std::move(chunk)));
+        }
+
+#pragma omp critical
+        generated.insert(generated.end(), std::make_move_iterator(local.begin()), std::make_move_iterator(local.end()));
+    }
+
+    // Store the chunks in grid order, independent of the thread count
+    std::sort(generated.begin(), generated.end(), [](const std::pair<size_t, Chunk> & a, const std::pair<size_t, Chunk> & b) {
+        return a.first < b.first;
+    });
+
+    for (auto & entry : generated)
+    {
+        m_chunkIndices[entry.first] = m_stored.size();
+        m_stored.push_back(std::move(entry.second));
+        m_dirty.push_back(0);
+    }
+}
+
+int BlockWorld::threshold() const
+{
+    return m_threshold;
+}
+
+void BlockWorld::setThreshold(int threshold)
+{
+    m_threshold = threshold;
+}
+
+const glm::ivec3 & BlockWorld::lower() const
+{
+    return m_lower;
+}
+
+const glm::ivec3 & BlockWorld::extent() const
+{
+    return m_extent;
+}
+
+bool BlockWorld::contains(const glm::ivec3 & position) const
+{
+    const auto cell = position - m_lower;
+
+    return cell.x >= 0 && cell.y >= 0 && cell.z >= 0 && cell.x < m_extent.x && cell.y < m_extent.y && cell.z < m_extent.z;
+}
+
+int BlockWorld::type(const glm::ivec3 & position) const
+{
+    if (!contains(position))
+    {
+        return airType;
+    }
+
+    const auto chunk = find(position);
+
+    return chunk ? chunkType(*chunk, position - chunk->origin) : airType;
+}
+
+bool BlockWorld::solid(const glm::ivec3 & position) const
+{
+    return type(position) > m_threshold;
+}
+
+int BlockWorld::visibleFaces(const glm::ivec3 & position) const
+{
+    if (!solid(position))
+    {
+        return 0;
+    }
+
+    auto faces = 0;
+
+    for (auto face = size_t(0); face < Block::faceCount; ++face)
+    {
+        faces |= solid(position + neighborOffsets[face]) ? 0 : 1 << face;
+    }
+
+    return faces;
+}
+
+void BlockWorld::setType(const glm::ivec3 & position, int type)
+{
+    if (!contains(position))
+    {
+        return;
+    }
+
+    const auto index = gridIndex(position);
+    auto stored = m_chunkIndices.find(index);
+
+    if (stored == m_chunkIndices.end())
+    {
+        if (type == airType)
+        {
+            return;
+        }
+
+        auto chunk = Chunk();
+        chunk.origin = gridOrigin(index);
+        chunk.uniformType = static_cast<signed char>(airType);
+
+        stored = m_chunkIndices.insert(std::make_pair(index, m_stored.size())).first;
+        m_stored.push_back(chunk);
+        m_dirty.push_back(0);
+    }
+
+    auto & chunk = m_stored[stored->second];
+
+    setChunkType(chunk, position - chunk.origin, type);
+
+    // The neighbors may gain or lose visible faces, also across the chunk border
+    m_dirty[stored->second] = 1;
+
+    for (auto face = size_t(0); face < Block::faceCount; ++face)
+    {
+        const auto neighbor = position + neighborOffsets[face];
+
+        if (!contains(neighbor))
+        {
+            continue;
+        }
+
+        const auto neighborChunk = m_chunkIndices.find(gridIndex(neighbor));
+
+        if (neighborChunk != m_chunkIndices.end())
+        {
+            m_dirty[neighborChunk->second] = 1;
+        }
+    }
+}
+
+size_t BlockWorld::chunkCount() const
+{
+    return m_stored.size();
+}
+
+glm::ivec3 BlockWorld::chunkOrigin(size_t chunk) const
+{
+    return m_stored[chunk].origin;
+}
+
+std::vector<Block> BlockWorld::visibleBlocks(size_t chunk) const
+{
+    const auto & stored = m_stored[chunk];
+    const auto origin = stored.origin;
+
+    auto blocks = std::vector<Block>();
+
+    // Uniform chunks are either air or, surrounded by solid chunks, entirely hidden
+    if (stored.runs.empty())
+    {
+        if (stored.uniformType <= m_threshold)
+        {
+            return blocks;
+        }
+
+        auto hidden = true;
+
+        for (auto face = size_t(0); face < Block::faceCount && hidden; ++face)
+        {
+            hidden = solidChunk(origin + neighborOffsets[face] * chunkSize);
+        }
+
+        if (hidden)
+        {
+            return blocks;
+        }
+    }
+
+    // The types of the chunk with a border of the neighboring layers; positions outside the bounds are stored as air
+    auto types = std::vector<signed char>(chunkVolume);
+    auto padded = std::vector<signed char>(static_cast<size_t>(paddedChunkSize) * paddedChunkSize * paddedChunkSize, static_cast<signed char>(airType));
+
+    decode(stored, types);
+
+    for (auto z = 0; z < chunkSize; ++z)
+    {
+        for (auto y = 0; y < chunkSize; ++y)
+        {
+            std::copy(types.begin() + cellIndex(glm::ivec3(0, y, z)), types.begin() + cellIndex(glm::ivec3(0, y, z)) + chunkSize, padded.begin() + paddedIndex(glm::ivec3(0, y, z)));
+        }
+    }
+
+    for (auto face = size_t(0); face < Block::faceCount; ++face)
+    {
+        const auto neighborOrigin = origin + neighborOffsets[face] * chunkSize;
+        const auto neighbor = gridContains(neighborOrigin) ? find(neighborOrigin) : nullptr;
+
+        if (!neighbor)
+        {
+            continue;
+        }
+
+        // The layer of the neighbor that touches this chunk, spanned by the two other axes
+        const auto axis = static_cast<int>(face / 2);
+        const auto u = (axis + 1) % 3;
+        const auto v = (axis + 2) % 3;
+
+        for (auto j = 0; j < chunkSize; ++j)
+        {
+            for (auto i = 0; i < chunkSize; ++i)
+            {
+                auto cell = glm::ivec3();
+                cell[axis] = neighborOffsets[face][axis] > 0 ? chunkSize : -1;
+                cell[u] = i;
+                cell[v] = j;
+
+                padded[paddedIndex(cell)] = static_cast<signed char>(chunkType(*neighbor, cell - neighborOffsets[face] * chunkSize));
+            }
+        }
+    }
+
+    auto begin = glm::ivec3();
+    auto end = glm::ivec3();
+    chunkBounds(origin, begin, end);
+
+    return visibleBlocks(origin, padded, begin - origin, end - origin, m_threshold);
+}
+
+size_t BlockWorld::paddedIndex(const glm::ivec3 & cell)
+{
+    return static_cast<size_t>(cell.x + 1) + paddedChunkSize * (static_cast<size_t>(cell.y + 1) + paddedChunkSize * static_cast<size_t>(cell.z + 1));
+}
+
+std::vector<Block> BlockWorld::visibleBlocks(const glm::ivec3 & origin, const std::vector<signed char> & padded, const glm::ivec3 & begin, const glm::ivec3 & end, int threshold)
+{
+    const int strides[Block::faceCount] = { 1, -1, paddedChunkSize, -paddedChunkSize, paddedChunkSize * paddedChunkSize, -paddedChunkSize * paddedChunkSize };
+
+    auto blocks = std::vector<Block>();
+
+    for (auto z = begin.z; z < end.z; ++z)
+    {
+        for (auto y = begin.y; y < end.y; ++y)
+        {
+            for (auto x = begin.x; x < end.x; ++x)
+            {
+                const auto cell = glm::ivec3(x, y, z);
+                const auto index = paddedIndex(cell);
+                const auto type = static_cast<int>(padded[index]);
+
+                if (type <= threshold)
+                {
+                    continue;
+                }
+
+                auto faces = 0;
+
+                for (auto face = size_t(0); face < Block::faceCount; ++face)
+                {
+                    faces |= padded[index + strides[face]] > threshold ? 0 : 1 << face;
+                }
+
+                if (faces == 0)
+                {
+                    continue;
+                }
+
+                Block b;
+                b.position = origin + cell;
+                b.type = type;
+                b.visibleFaces = faces;
+
+                blocks.push_back(b);
+            }
+        }
+    }
+
+    return blocks;
+}
+
+std::vector<size_t> BlockWorld::takeDirtyChunks()
+{
+    auto chunks = std::vector<size_t>();
+
+    for (auto i = size_t(0); i < m_dirty.size(); ++i)
+    {
+        if (m_dirty[i])
+        {
+            chunks.push_back(i);
+        }
+    }
+
+    std::fill(m_dirty.begin(), m_dirty.end(), 0);
+
+    return chunks;
+}
+
+size_t BlockWorld::byteSize() const
+{
+    auto result = m_stored.capacity() * sizeof(Chunk) + m_dirty.capacity();
+
+    for (const auto & chunk : m_stored)
+    {
+        result += chunk.columns.capacity() * sizeof(unsigned short) + chunk.runs.capacity() * sizeof(Run);
+    }
+
+    // One node per entry and one pointer per bucket
+    result += m_chunkIndices.size() * (sizeof(std::pair<const size_t, size_t>) + sizeof(void *)) + m_chunkIndices.bucket_count() * sizeof(void *);
+
+    return result;
+}
+
+size_t BlockWorld::gridIndex(const glm::ivec3 & position) const
+{
+    const auto chunk = (position - m_origin) / chunkSize;
+
+    return static_cast<size_t>(chunk.x) + static_cast<size_t>(m_chunks.x) * (static_cast<size_t>(chunk.y) + static_cast<size_t>(m_chunks.y) * chunk.z);
+}
+
+glm::ivec3 BlockWorld::gridOrigin(size_t index) const
+{
+    const auto x = index % m_chunks.x;
+    const auto y = (index / m_chunks.x) % m_chunks.y;
+    const auto z = index / m_chunks.x / m_chunks.y;
+
+    return m_origin + glm::ivec3(static_cast<int>(x), static_cast<int>(y), static_cast<int>(z)) * chunkSize;
+}
+
+const BlockWorld::Chunk * BlockWorld::find(const glm::ivec3 & position) const
+{
+    const auto stored = m_chunkIndices.find(gridIndex(position));
+
+    return stored != m_chunkIndices.end() ? &m_stored[stored->second] : nullptr;
+}
+
+void BlockWorld::chunkBounds(const glm::ivec3 & origin, glm::ivec3 & begin, glm::ivec3 & end) const
+{
+    begin = glm::max(origin, m_lower);
+    end = glm::min(origin + glm::ivec3(chunkSize), m_lower + m_extent);
+}
+
+bool BlockWorld::gridContains(const glm::ivec3 & origin) const
+{
+    const auto grid = (origin - m_origin) / chunkSize;
+
+    return grid.x >= 0 && grid.y >= 0 && grid.z >= 0 && grid.x < m_chunks.x && grid.y < m_chunks.y && grid.z < m_chunks.z;
+}
+
+bool BlockWorld::solidChunk(const glm::ivec3 & origin) const
+{
+    if (!gridContains(origin))
+    {
+        return false;
+    }
+
+    const auto chunk = find(origin);
+
+    return chunk && chunk->runs.empty() && chunk->uniformType > m_threshold;
+}
+
+size_t BlockWorld::cellIndex(const glm::ivec3 & cell)
+{
+    return static_cast<size_t>(cell.x) + chunkSize * (static_cast<size_t>(cell.y) + chunkSize * static_cast<size_t>(cell.z));
+}
+
+BlockWorld::Chunk BlockWorld::encode(const glm::ivec3 & origin, const std::vector<signed char> & types)
+{
+    auto chunk = Chunk();
+    chunk.origin = origin;
+    chunk.uniformType = types[0];
+
+    if (std::find_if(types.begin(), types.end(), [&chunk](signed char type) { return type != chunk.uniformType; }) == types.end())
+    {
+        return chunk;
+    }
+
+    chunk.columns.resize(columnCount + 1);
+
+    for (auto column = size_t(0); column < columnCount; ++column)
+    {
+        chunk.columns[column] = static_cast<unsigned short>(chunk.runs.size());
+
+        for (auto y = 0; y < chunkSize; ++y)
+        {
+            const auto type = types[cellIndex(glm::ivec3(column % chunkSize, y, column / chunkSize))];
+
+            if (chunk.runs.size() > chunk.columns[column] && chunk.runs.back().type == type)
+            {
+                ++chunk.runs.back().length;
+            }
+            else
+            {
+                chunk.runs.push_back({ type, 1 });
+            }
+        }
+    }
+
+    chunk.columns[columnCount] = static_cast<unsigned short>(chunk.runs.size());
+    chunk.runs.shrink_to_fit();
+
+    return chunk;
+}
+
+void BlockWorld::decode(const Chunk & chunk, std::vector<signed char> & types)
+{
+    if (chunk.runs.empty())
+    {
+        std::fill(types.begin(), types.end(), chunk.uniformType);
+
+        return;
+    }
+
+    for (auto column = size_t(0); column < columnCount; ++column)
+    {
+        auto y = 0;
+
+        for (auto run = size_t(chunk.columns[column]); run < chunk.columns[column + 1]; ++run)
+        {
+            for (auto i = 0; i < chunk.runs[run].length; ++i, ++y)
+            {
+                types[cellIndex(glm::ivec3(column % chunkSize, y, column / chunkSize))] = chunk.runs[run].type;
+            }
+        }
+    }
+}
+
+int BlockWorld::chunkType(const Chunk & chunk, const glm::ivec3 & cell)
+{
+    if (chunk.runs.empty())
+    {
+        return chunk.uniformType;
+    }
+
+    const auto column = static_cast<size_t>(cell.x) + chunkSize * static_cast<size_t>(cell.z);
+
+    auto y = cell.y;
+    auto run = size_t(chunk.columns[column]);
+
+    while (y >= chunk.runs[run].length)
+    {
+        y -= chunk.runs[run].length;
+        ++run;
+    }
+
+    return chunk.runs[run].type;
+}
+
+void BlockWorld::setChunkType(Chunk & chunk, const glm::ivec3 & cell, int type)
+{
+    if (chunk.runs.empty())
+    {
+        if (chunk.uniformType == type)
+        {
+            return;
+        }
+
+        // Expand to one run per column
+        chunk.columns.resize(columnCount + 1);
+        chunk.runs.assign(columnCount, Run{ chunk.uniformType, static_cast<unsigned char>(chunkSize) });
+
+        for (auto column = size_t(0); column <= columnCount; ++column)
+        {
+            chunk.columns[column] = static_cast<unsigned short>(column);
+        }
+    }
+
+    // Re-encode the column of the cell and splice its runs in
+    const auto column = static_cast<size_t>(cell.x) + chunkSize * static_cast<size_t>(cell.z);
+    const auto first = chunk.runs.begin() + chunk.columns[column];
+    const auto last = chunk.runs.begin() + chunk.columns[column + 1];
+
+    signed char types[chunkSize];
+    auto y = 0;
+
+    for (auto run = first; run != last; ++run)
+    {
+        std::fill(types + y, types + y + run->length, run->type);
+        y += run->length;
+    }
+
+    types[cell.y] = static_cast<signed char>(type);
+
+    auto runs = std::vector<Run>();
+
+    for (auto i = 0; i < chunkSize; ++i)
+    {
+        if (!runs.empty() && runs.back().type == types[i])
+        {
+            ++runs.back().length;
+        }
+        else
+        {
+            runs.push_back({ types[i], 1 });
+        }
+    }
+
+    const auto delta = static_cast<int>(runs.size()) - static_cast<int>(last - first);
+
+    chunk.runs.insert(chunk.runs.erase(first, last), runs.begin(), runs.end());
+
+    for (auto i = column + 1; i <= columnCount; ++i)
+    {
+        chunk.columns[i] = static_cast<unsigned short>(chunk.columns[i] + delta);
+    }
+}
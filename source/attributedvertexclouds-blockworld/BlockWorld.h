@@ -0,0 +1,143 @@
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "Block.h"
+
+
+// Block types of a world with fixed bounds, stored in chunks of chunkSize³ blocks.
+// Chunks are aligned to multiples of chunkSize, so the position of a block within its chunk is its position modulo chunkSize.
+// Only chunks with blocks other than air are stored, each as runs of equal types along y, so the memory follows the
+// content instead of the bounds; chunks are numbered in the order they are stored in.
+// Blocks with a type up to the threshold are air, as are all positions outside the bounds.
+// Edits mark the chunks whose visible blocks change as dirty.
+class BlockWorld
+{
+public:
+    static const int chunkSize = 32;
+
+    static_assert(chunkSize == 32, "Block::packedBlock() stores positions within a chunk in 5 bits per axis");
+
+    // Edge length of the types of a chunk with a border of the neighboring layers, see paddedIndex()
+    static const int paddedChunkSize = chunkSize + 2;
+
+    // Type that stays air for every threshold
+    static const int airType = 0;
+
+    BlockWorld();
+
+    // Resets the world to air within [lower, lower + extent)
+    void reset(const glm::ivec3 & lower, const glm::ivec3 & extent);
+
+    // Sets the type of every position within the bounds, one chunk per task; marks no chunk as dirty
+    void generate(const std::function<int(const glm::ivec3 &)> & type);
+
+    // Lets fill write the types of each chunk within the bounds, chunkSize³ values in the order x, y, z from the
+    // given chunk origin, one chunk per task. The values are air when fill is called; fill returns false without writing
+    // for chunks of air only. Types outside the bounds are ignored. Marks no chunk as dirty.
+    void generateChunks(const std::function<bool(const glm::ivec3 &, std::vector<signed char> &)> & fill);
+
+    int threshold() const;
+    void setThreshold(int threshold);
+
+    const glm::ivec3 & lower() const;
+    const glm::ivec3 & extent() const;
+
+    bool contains(const glm::ivec3 & position) const;
+
+    // Types are stored in 8 bits
+    int type(const glm::ivec3 & position) const;
+    bool solid(const glm::ivec3 & position) const;
+
+    // Faces of a solid block that border air, see Block::Face; zero for air
+    int visibleFaces(const glm::ivec3 & position) const;
+
+    // Marks the chunk of the block and those of its neighbors as dirty; positions outside the bounds are ignored.
+    // A solid type in a chunk of air stores a new chunk.
+    void setType(const glm::ivec3 & position, int type);
+
+    // Stored chunks
+    size_t chunkCount() const;
+
+    // Position of the first block of a chunk, which may lie outside the bounds
+    glm::ivec3 chunkOrigin(size_t chunk) const;
+
+    // Solid blocks of a chunk with at least one visible face
+    std::vector<Block> visibleBlocks(size_t chunk) const;
+
+    // Index of a cell within the types of a chunk with a border, for cells within [-1, chunkSize]
+    static size_t paddedIndex(const glm::ivec3 & cell);
+
+    // Solid blocks with at least one visible face among the cells [begin, end) of the chunk at origin, from the types of the
+    // chunk with a border of the neighboring layers; also used for chunks generated outside of a world
+    static std::vector<Block> visibleBlocks(const glm::ivec3 & origin, const std::vector<signed char> & padded, const glm::ivec3 & begin, const glm::ivec3 & end, int threshold);
+
+    // Chunks edited since the last call
+    std::vector<size_t> takeDirtyChunks();
+
+    // Memory of the stored chunks and the chunk table in bytes
+    size_t byteSize() const;
+
+protected:
+    // Equal types along y within one column of a chunk
+    struct Run
+    {
+        signed char type;
+        unsigned char length;
+    };
+
+    // Runs column after column, for x and then z; a chunk without runs has the uniform type throughout
+    struct Chunk
+    {
+        glm::ivec3 origin;
+        signed char uniformType;
+
+        // First run of each column, followed by the run count
+        std::vector<unsigned short> columns;
+        std::vector<Run> runs;
+    };
+
+    glm::ivec3 m_lower;
+    glm::ivec3 m_extent;
+
+    // Origin of the chunk grid and the chunk count per axis
+    glm::ivec3 m_origin;
+    glm::ivec3 m_chunks;
+
+    int m_threshold;
+
+    std::vector<Chunk> m_stored;
+    std::vector<unsigned char> m_dirty;
+
+    // Stored chunk of each chunk grid index that holds one
+    std::unordered_map<size_t, size_t> m_chunkIndices;
+
+    // Chunk grid index of a position within the chunk grid
+    size_t gridIndex(const glm::ivec3 & position) const;
+    glm::ivec3 gridOrigin(size_t index) const;
+
+    // Stored chunk of a position within the chunk grid, nullptr for air
+    const Chunk * find(const glm::ivec3 & position) const;
+
+    // Positions of a chunk within the bounds, [begin, end)
+    void chunkBounds(const glm::ivec3 & origin, glm::ivec3 & begin, glm::ivec3 & end) const;
+
+    // Whether a chunk origin lies within the chunk grid
+    bool gridContains(const glm::ivec3 & origin) const;
+
+    // Whether a neighboring chunk is stored and solid throughout
+    bool solidChunk(const glm::ivec3 & origin) const;
+
+    // Cells are positions relative to their chunk origin
+    static size_t cellIndex(const glm::ivec3 & cell);
+
+    static Chunk encode(const glm::ivec3 & origin, const std::vector<signed char> & types);
+    static void decode(const Chunk & chunk, std::vector<signed char> & types);
+    static int chunkType(const Chunk & chunk, const glm::ivec3 & cell);
+    static void setChunkType(Chunk & chunk, const glm::ivec3 & cell, int type);
+};
@@ -0,0 +1,430 @@
+
+#include "BlockWorldGreedyMeshing.h"
+
+#include <limits>
+
+#include <glm/common.hpp>
+
+#include <glbinding/gl/gl.h>
+
+#include "common.h"
+
+using namespace gl;
+
+
+namespace
+{
+
+
+// Marks cells without a visible face in the current direction
+static const auto noFace = std::numeric_limits<int>::min();
+
+
+// Rectangle of merged faces; origin is the cell of its first block, size its extent along the face tangents
+struct Quad
+{
+    glm::ivec3 origin;
+    glm::ivec2 size;
+    int type;
+};
+
+
+// Axis of a unit vector along one of the coordinate axes
+int axis(const glm::vec3 & direction)
+{
+    return direction.x != 0.0f ? 0 : (direction.y != 0.0f ? 1 : 2);
+}
+
+size_t cellIndex(const glm::ivec3 & cell, const glm::ivec3 & extent)
+{
+    return static_cast<size_t>(cell.x) + static_cast<size_t>(extent.x) * (static_cast<size_t>(cell.y) + static_cast<size_t>(extent.y) * cell.z);
+}
+
+// Merges the faces of one slice greedily: each rectangle grows along the first tangent as long as the type matches,
+// then along the second one as long as the whole row matches
+std::vector<Quad> meshSlice(const std::vector<int> & volume, const glm::ivec3 & extent, size_t face, int slice)
+{
+    const auto u = (Block::faceCorner(face, 1) - Block::faceCorner(face, 0)) / 2.0f;
+    const auto v = (Block::faceCorner(face, 2) - Block::faceCorner(face, 0)) / 2.0f;
+
+    const auto normalAxis = axis(Block::faceNormal(face));
+    const auto uAxis = axis(u);
+    const auto vAxis = axis(v);
+
+    const auto width = extent[uAxis];
+    const auto height = extent[vAxis];
+
+    auto types = std::vector<int>(static_cast<size_t>(width) * height, noFace);
+
+    for (auto j = 0; j < height; ++j)
+    {
+        for (auto i = 0; i < width; ++i)
+        {
+            auto cell = glm::ivec3(0);
+            cell[normalAxis] = slice;
+            cell[uAxis] = i;
+            cell[vAxis] = j;
+
+            const auto packedType = volume[cellIndex(cell, extent)];
+
+            // The type is stored in the lower 8 bits, the visible faces in the 6 bits above
+            if ((packedType >> 8) & (1 << face))
+            {
+                types[i + j * width] = static_cast<signed char>(packedType & 0xff);
+            }
+        }
+    }
+
+    auto quads = std::vector<Quad>();
+
+    for (auto j = 0; j < height; ++j)
+    {
+        for (auto i = 0; i < width; ++i)
+        {
+            const auto type = types[i + j * width];
+
+            if (type == noFace)
+            {
+                continue;
+            }
+
+            auto w = 1;
+            while (i + w < width && types[i + w + j * width] == type)
+            {
+                ++w;
+            }
+
+            auto h = 1;
+            for (; j + h < height; ++h)
+            {
+                auto k = 0;
+                while (k < w && types[i + k + (j + h) * width] == type)
+                {
+                    ++k;
+                }
+
+                if (k < w)
+                {
+                    break;
+                }
+            }
+
+            for (auto y = j; y < j + h; ++y)
+            {
+                std::fill(types.begin() + i + y * width, types.begin() + i + w + y * width, noFace);
+            }
+
+            auto quad = Quad();
+            quad.origin[normalAxis] = slice;
+            quad.origin[uAxis] = i;
+            quad.origin[vAxis] = j;
+            quad.size = glm::ivec2(w, h);
+            quad.type = type;
+
+            quads.push_back(quad);
+
+            i += w - 1;
+        }
+    }
+
+    return quads;
+}
+
+
+} // namespace
+
+
+BlockWorldGreedyMeshing::BlockWorldGreedyMeshing()
+: BlockWorldImplementation("Greedy Meshing")
+, m_vertices(0)
+, m_vao(0)
+, m_vertexShader(0)
+, m_fragmentShader(0)
+{
+}
+
+BlockWorldGreedyMeshing::~BlockWorldGreedyMeshing()
+{
+    if (!initialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_vertices);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteShader(m_vertexShader);
+    glDeleteShader(m_fragmentShader);
+    glDeleteProgram(m_program);
+}
+
+void BlockWorldGreedyMeshing::onInitialize()
+{
+    glGenBuffers(1, &m_vertices);
+    glGenVertexArrays(1, &m_vao);
+
+    initializeVAO();
+
+    m_vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    m_fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+    m_program = glCreateProgram();
+
+    glAttachShader(m_program, m_vertexShader);
+    glAttachShader(m_program, m_fragmentShader);
+
+    loadShader();
+}
+
+void BlockWorldGreedyMeshing::buildMesh()
+{
+    m_vertex.clear();
+    m_normal.clear();
+    m_localCoords.clear();
+    m_type.clear();
+
+    if (m_positionAndType.empty())
+    {
+        return;
+    }
+
+    // Dense volume over the bounds of the blocks; cells without a block have no visible faces
+    auto lower = glm::ivec3(std::numeric_limits<int>::max());
+    auto upper = glm::ivec3(std::numeric_limits<int>::min());
+
+    for (const auto & positionAndType : m_positionAndType)
+    {
+        lower = glm::min(lower, glm::ivec3(positionAndType));
+        upper = glm::max(upper, glm::ivec3(positionAndType));
+    }
+
+    const auto extent = upper - lower + glm::ivec3(1);
+
+    auto volume = std::vector<int>(static_cast<size_t>(extent.x) * extent.y * extent.z, 0);
+
+#pragma omp parallel for
+    for (long i = 0; i < static_cast<long>(m_positionAndType.size()); ++i)
+    {
+        volume[cellIndex(glm::ivec3(m_positionAndType[i]) - lower, extent)] = m_positionAndType[i].w;
+    }
+
+    // One task per face direction and slice along its normal
+    auto faces = std::vector<size_t>();
+    auto slices = std::vector<int>();
+
+    for (auto face = size_t(0); face < Block::faceCount; ++face)
+    {
+        for (auto slice = 0; slice < extent[axis(Block::faceNormal(face))]; ++slice)
+        {
+            faces.push_back(face);
+            slices.push_back(slice);
+        }
+    }
+
+    auto quads = std::vector<std::vector<Quad>>(slices.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for (long i = 0; i < static_cast<long>(slices.size()); ++i)
+    {
+        quads[i] = meshSlice(volume, extent, faces[i], slices[i]);
+    }
+
+    // Two triangles per rectangle, written in parallel behind the rectangles of the preceding slices
+    auto offsets = std::vector<size_t>(slices.size() + 1, 0);
+
+    for (auto i = size_t(0); i < slices.size(); ++i)
+    {
+        offsets[i + 1] = offsets[i] + quads[i].size() * 6;
+    }
+
+    m_vertex.resize(offsets.back());
+    m_normal.resize(offsets.back());
+    m_localCoords.resize(offsets.back());
+    m_type.resize(offsets.back());
+
+#pragma omp parallel for
+    for (long i = 0; i < static_cast<long>(slices.size()); ++i)
+    {
+        static const size_t corners[6] = { 0, 1, 2, 2, 1, 3 };
+
+        const auto face = faces[i];
+        const auto normal = Block::faceNormal(face);
+        const auto u = (Block::faceCorner(face, 1) - Block::faceCorner(face, 0)) / 2.0f;
+        const auto v = (Block::faceCorner(face, 2) - Block::faceCorner(face, 0)) / 2.0f;
+
+        auto vertex = offsets[i];
+
+        for (const auto & quad : quads[i])
+        {
+            const auto position = glm::vec3(quad.origin + lower);
+
+            for (const auto corner : corners)
+            {
+                // Along each tangent, the rectangle spans from the first block's lower edge to the last block's upper edge
+                const auto span = glm::vec2((corner & 1) ? quad.size.x : 0, (corner & 2) ? quad.size.y : 0);
+
+                m_vertex[vertex] = (position + 0.5f * normal + (span.x - 0.5f) * u + (span.y - 0.5f) * v) * m_blockSize;
+                m_normal[vertex] = normal;
+                m_localCoords[vertex] = normal + (2.0f * span.x - 1.0f) * u + (2.0f * span.y - 1.0f) * v;
+                m_type[vertex] = quad.type;
+
+                ++vertex;
+            }
+        }
+    }
+}
+
+void BlockWorldGreedyMeshing::initializeVAO()
+{
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_STATIC_DRAW);
+
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 0, verticesCount() * sizeof(float) * 3, m_vertex.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 3, verticesCount() * sizeof(float) * 3, m_normal.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 6, verticesCount() * sizeof(float) * 3, m_localCoords.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 9, verticesCount() * sizeof(float) * 1, m_type.data());
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 0));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 3));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 6));
+    glVertexAttribIPointer(3, 1, GL_INT, sizeof(int), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 9));
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool BlockWorldGreedyMeshing::loadShader()
+{
+    const auto vertexShaderSource = loadShaderSource("/blockworld-triangles/standard.vert");
+    const auto vertexShaderSource_ptr = vertexShaderSource.c_str();
+    if(vertexShaderSource_ptr)
+        glShaderSource(m_vertexShader, 1, &vertexShaderSource_ptr, 0);
+
+    glCompileShader(m_vertexShader);
+
+    bool success = checkForCompilationError(m_vertexShader, "vertex shader");
+
+    const auto fragmentShaderSource = loadShaderSource("/blockworld.frag");
+    const auto fragmentShaderSource_ptr = fragmentShaderSource.c_str();
+    if(fragmentShaderSource_ptr)
+        glShaderSource(m_fragmentShader, 1, &fragmentShaderSource_ptr, 0);
+
+    glCompileShader(m_fragmentShader);
+
+    success &= checkForCompilationError(m_fragmentShader, "fragment shader");
+
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glLinkProgram(m_program);
+
+    success &= checkForLinkerError(m_program, "program");
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glBindFragDataLocation(m_program, 0, "out_color");
+
+    return true;
+}
+
+void BlockWorldGreedyMeshing::setBlock(size_t index, const Block & block)
+{
+    m_positionAndType[index] = glm::ivec4(block.position, block.packedType());
+}
+
+void BlockWorldGreedyMeshing::setChunks(const std::vector<size_t> & /*offsets*/, const std::vector<glm::ivec3> & /*origins*/)
+{
+    // Needs no GL context, so the mesh is built with the geometry, not on initialization
+    buildMesh();
+}
+
+void BlockWorldGreedyMeshing::updateBuffers()
+{
+    initializeVAO();
+}
+
+size_t BlockWorldGreedyMeshing::size() const
+{
+    return m_positionAndType.size();
+}
+
+size_t BlockWorldGreedyMeshing::verticesCount() const
+{
+    return m_vertex.size();
+}
+
+size_t BlockWorldGreedyMeshing::staticByteSize() const
+{
+    return 0;
+}
+
+size_t BlockWorldGreedyMeshing::byteSize() const
+{
+    return verticesCount() * vertexByteSize();
+}
+
+size_t BlockWorldGreedyMeshing::vertexByteSize() const
+{
+    return sizeof(float) * componentCount();
+}
+
+size_t BlockWorldGreedyMeshing::componentCount() const
+{
+    return 10;
+}
+
+void BlockWorldGreedyMeshing::resize(size_t count)
+{
+    m_positionAndType.resize(count);
+}
+
+size_t BlockWorldGreedyMeshing::cpuByteSize() const
+{
+    return containerByteSize(m_positionAndType)
+        + containerByteSize(m_vertex)
+        + containerByteSize(m_normal)
+        + containerByteSize(m_localCoords)
+        + containerByteSize(m_type);
+}
+
+std::vector<gl::GLuint> BlockWorldGreedyMeshing::buffers() const
+{
+    return { m_vertices };
+}
+
+void BlockWorldGreedyMeshing::onRender()
+{
+    glBindVertexArray(m_vao);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    glDisable(GL_CULL_FACE);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    glUseProgram(m_program);
+    glDrawArrays(GL_TRIANGLES, 0, verticesCount());
+
+    glUseProgram(0);
+
+    glBindVertexArray(0);
+}
+
+gl::GLuint BlockWorldGreedyMeshing::program() const
+{
+    return m_program;
+}
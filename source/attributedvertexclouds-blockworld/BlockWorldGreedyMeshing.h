@@ -0,0 +1,65 @@
+
+#pragma once
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <glbinding/gl/types.h>
+
+#include "Block.h"
+#include "BlockWorldImplementation.h"
+
+
+// Triangles of merged faces: once all blocks are set, coplanar adjacent visible faces of the same type
+// are merged into rectangles, one slice of the world per task
+class BlockWorldGreedyMeshing : public BlockWorldImplementation
+{
+public:
+    BlockWorldGreedyMeshing();
+    ~BlockWorldGreedyMeshing();
+
+    virtual void onInitialize() override;
+    virtual void onRender() override;
+
+    virtual bool loadShader() override;
+
+    virtual void setBlock(size_t index, const Block & block) override;
+    virtual void setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & origins) override;
+    virtual void updateBuffers() override;
+
+    virtual size_t size() const override;
+    virtual size_t verticesCount() const override;
+    virtual size_t staticByteSize() const override;
+    virtual size_t byteSize() const override;
+    virtual size_t vertexByteSize() const override;
+    virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
+
+    virtual void resize(size_t count) override;
+
+    virtual std::vector<gl::GLuint> buffers() const override;
+
+    virtual gl::GLuint program() const override;
+public:
+    // Blocks as set, with the packed type and visible faces
+    std::vector<glm::ivec4> m_positionAndType;
+
+    // Mesh of the merged faces, built with the chunks
+    std::vector<glm::vec3> m_vertex;
+    std::vector<glm::vec3> m_normal;
+    std::vector<glm::vec3> m_localCoords;
+    std::vector<int> m_type;
+
+    gl::GLuint m_vertices;
+    gl::GLuint m_vao;
+
+    gl::GLuint m_vertexShader;
+    gl::GLuint m_fragmentShader;
+
+    gl::GLuint m_program;
+
+    void buildMesh();
+    void initializeVAO();
+};
@@ -16,3 +16,24 @@ void BlockWorldImplementation::setBlockSize(float size)
 {
     m_blockSize = size;
 }
+
+void BlockWorldImplementation::setChunks(const std::vector<size_t> & /*offsets*/, const std::vector<glm::ivec3> & /*origins*/)
+{
+}
+
+bool BlockWorldImplementation::updateChunk(size_t /*chunk*/, const glm::ivec3 & /*origin*/, const std::vector<Block> & /*blocks*/)
+{
+    return false;
+}
+
+std::vector<size_t> BlockWorldImplementation::vertexOffsets(const std::vector<unsigned char> & vertexCounts)
+{
+    auto offsets = std::vector<size_t>(vertexCounts.size() + 1, 0);
+
+    for (auto i = size_t(0); i < vertexCounts.size(); ++i)
+    {
+        offsets[i + 1] = offsets[i] + vertexCounts[i];
+    }
+
+    return offsets;
+}
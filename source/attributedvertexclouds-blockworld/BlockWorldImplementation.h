@@ -1,11 +1,25 @@
 
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
+#include <glm/vec3.hpp>
 
 #include "Block.h"
 #include "Implementation.h"
 
 
+// Interleaved vertex of the triangle techniques, so a chunk's vertices are a single range of one buffer
+struct BlockVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec3 localCoord;
+    int type;
+};
+
+
 class BlockWorldImplementation : public Implementation
 {
 public:
@@ -16,6 +30,40 @@ public:
 
     virtual void setBlock(size_t index, const Block & block) = 0;
 
+    // Called once all blocks are set, which come chunk after chunk; offsets holds the first block of each chunk,
+    // followed by the block count, and origins the position of the first block of each chunk, see BlockWorld::chunkOrigin()
+    virtual void setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & origins);
+
+    // Replaces the blocks of a chunk after an edit, or adds the chunk if it is new to the world; returns false if the
+    // technique cannot update single chunks and has to be refilled as a whole
+    virtual bool updateChunk(size_t chunk, const glm::ivec3 & origin, const std::vector<Block> & blocks);
+
+    // Uploads all blocks again after a refill; expects the technique to be initialized
+    virtual void updateBuffers() = 0;
+
 protected:
     float m_blockSize;
+
+    // Exclusive prefix sum of the vertices each block emitted, followed by their total
+    static std::vector<size_t> vertexOffsets(const std::vector<unsigned char> & vertexCounts);
+
+    // Moves the vertices each block wrote to the front of its fixed-size slot back to back, dropping the unused
+    // rest of the slots; offsets holds the first compacted vertex of each block, followed by the total count
+    template <typename T>
+    static void compactVertices(std::vector<T> & values, size_t slotSize, const std::vector<size_t> & offsets);
 };
+
+
+template <typename T>
+void BlockWorldImplementation::compactVertices(std::vector<T> & values, size_t slotSize, const std::vector<size_t> & offsets)
+{
+    auto compacted = std::vector<T>(offsets.back());
+
+#pragma omp parallel for
+    for (long i = 0; i < static_cast<long>(offsets.size()) - 1; ++i)
+    {
+        std::copy(values.begin() + i * slotSize, values.begin() + i * slotSize + (offsets[i + 1] - offsets[i]), compacted.begin() + offsets[i]);
+    }
+
+    values.swap(compacted);
+}
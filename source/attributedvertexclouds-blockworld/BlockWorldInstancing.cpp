@@ -20,6 +20,11 @@ BlockWorldInstancing::BlockWorldInstancing()
 
 BlockWorldInstancing::~BlockWorldInstancing()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteBuffers(1, &m_attributes);
     glDeleteVertexArrays(1, &m_vao);
@@ -53,44 +58,28 @@ void BlockWorldInstancing::initializeVAO()
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
 
-    static const auto NEGATIVE_X = glm::vec3(-1.0, 0.0, 0.0);
-    static const auto NEGATIVE_Y = glm::vec3(0.0, -1.0, 0.0);
-    static const auto NEGATIVE_Z = glm::vec3(0.0, 0.0, -1.0);
-    static const auto POSITIVE_X = glm::vec3(1.0, 0.0, 0.0);
-    static const auto POSITIVE_Y = glm::vec3(0.0, 1.0, 0.0);
-    static const auto POSITIVE_Z = glm::vec3(0.0, 0.0, 1.0);
-
-    const auto vertices = std::array<glm::vec3, 14>{{
-        glm::vec3(-0.5f, 0.5f, -0.5f),
-        glm::vec3(-0.5f, 0.5f, 0.5f),
-        glm::vec3(0.5f, 0.5f, -0.5f),
-        glm::vec3(0.5f, 0.5f, 0.5f),
-        glm::vec3(0.5f, -0.5f, 0.5f),
-        glm::vec3(-0.5f, 0.5f, 0.5f),
-        glm::vec3(-0.5f, -0.5f, 0.5f),
-        glm::vec3(-0.5f, 0.5f, -0.5f),
-        glm::vec3(-0.5f, -0.5f, -0.5f),
-        glm::vec3(0.5f, 0.5f, -0.5f),
-        glm::vec3(0.5f, -0.5f, -0.5f),
-        glm::vec3(0.5f, -0.5f, 0.5f),
-        glm::vec3(-0.5f, -0.5f, -0.5f),
-        glm::vec3(-0.5f, -0.5f, 0.5f)
-    }};
-
-    const auto normals = std::array<glm::vec3, 14>{{
-        POSITIVE_Y, POSITIVE_Y, POSITIVE_Y, POSITIVE_Y,
-        POSITIVE_X, POSITIVE_Z, POSITIVE_Z, NEGATIVE_X,
-        NEGATIVE_X, NEGATIVE_Z, NEGATIVE_Z, POSITIVE_X,
-        NEGATIVE_Y, NEGATIVE_Y
-    }};
-
-    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * 2 * 14, nullptr, GL_STATIC_DRAW);
-
-    glBufferSubData(GL_ARRAY_BUFFER, 14 * sizeof(float) * 0, vertices.size() * sizeof(float) * 3, vertices.data());
-    glBufferSubData(GL_ARRAY_BUFFER, 14 * sizeof(float) * 3, normals.size() * sizeof(float) * 3, normals.data());
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(14 * sizeof(float) * 0));
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(14 * sizeof(float) * 3));
+    // Two triangles per face in the order of the face bits, so the vertex shader can collapse the hidden ones
+    auto vertices = std::array<glm::vec3, 36>();
+    auto normals = std::array<glm::vec3, 36>();
+
+    for (auto face = size_t(0); face < Block::faceCount; ++face)
+    {
+        static const size_t corners[6] = { 0, 1, 2, 2, 1, 3 };
+
+        for (auto i = size_t(0); i < 6; ++i)
+        {
+            vertices[face * 6 + i] = Block::faceCorner(face, corners[i]) * 0.5f;
+            normals[face * 6 + i] = Block::faceNormal(face);
+        }
+    }
+
+    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * 2 * 36, nullptr, GL_STATIC_DRAW);
+
+    glBufferSubData(GL_ARRAY_BUFFER, 36 * sizeof(float) * 0, vertices.size() * sizeof(float) * 3, vertices.data());
+    glBufferSubData(GL_ARRAY_BUFFER, 36 * sizeof(float) * 3, normals.size() * sizeof(float) * 3, normals.data());
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(36 * sizeof(float) * 0));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(36 * sizeof(float) * 3));
 
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
@@ -101,9 +90,9 @@ void BlockWorldInstancing::initializeVAO()
     //glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     glBindBuffer(GL_ARRAY_BUFFER, m_attributes);
-    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_DYNAMIC_DRAW);
 
-    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 0, verticesCount() * sizeof(float) * 4, m_positionAndType.data());
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_positionAndType.size() * sizeof(glm::ivec4), m_positionAndType.data());
 
     glVertexAttribIPointer(2, 4, GL_INT, sizeof(glm::ivec4), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 0));
 
@@ -161,12 +150,52 @@ bool BlockWorldInstancing::loadShader()
 
 void BlockWorldInstancing::setBlock(size_t index, const Block & block)
 {
-    m_positionAndType[index] = glm::ivec4(block.position, block.type);
+    m_positionAndType[index] = glm::ivec4(block.position, block.packedType());
+}
+
+void BlockWorldInstancing::setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & /*origins*/)
+{
+    m_chunks.layout(m_positionAndType, offsets);
+}
+
+bool BlockWorldInstancing::updateChunk(size_t chunk, const glm::ivec3 & /*origin*/, const std::vector<Block> & blocks)
+{
+    auto positionAndType = std::vector<glm::ivec4>(blocks.size());
+
+    for (auto i = size_t(0); i < blocks.size(); ++i)
+    {
+        positionAndType[i] = glm::ivec4(blocks[i].position, blocks[i].packedType());
+    }
+
+    const auto inPlace = m_chunks.replace(m_positionAndType, chunk, positionAndType);
+
+    if (!initialized())
+    {
+        return true;
+    }
+
+    if (!inPlace)
+    {
+        initializeVAO();
+
+        return true;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_attributes);
+    glBufferSubData(GL_ARRAY_BUFFER, m_chunks.starts()[chunk] * sizeof(glm::ivec4), positionAndType.size() * sizeof(glm::ivec4), positionAndType.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+void BlockWorldInstancing::updateBuffers()
+{
+    initializeVAO();
 }
 
 size_t BlockWorldInstancing::size() const
 {
-    return m_positionAndType.size();
+    return m_chunks.blockCount();
 }
 
 size_t BlockWorldInstancing::verticesPerCuboid() const
@@ -181,12 +210,12 @@ size_t BlockWorldInstancing::verticesCount() const
 
 size_t BlockWorldInstancing::staticByteSize() const
 {
-    return sizeof(glm::vec3) * 14 * 2;
+    return sizeof(glm::vec3) * 36 * 2;
 }
 
 size_t BlockWorldInstancing::byteSize() const
 {
-    return verticesCount() * vertexByteSize();
+    return m_positionAndType.size() * vertexByteSize();
 }
 
 size_t BlockWorldInstancing::vertexByteSize() const
@@ -204,6 +233,16 @@ void BlockWorldInstancing::resize(size_t count)
     m_positionAndType.resize(count * verticesPerCuboid());
 }
 
+size_t BlockWorldInstancing::cpuByteSize() const
+{
+    return containerByteSize(m_positionAndType);
+}
+
+std::vector<gl::GLuint> BlockWorldInstancing::buffers() const
+{
+    return { m_vertices, m_attributes };
+}
+
 void BlockWorldInstancing::onRender()
 {
     glBindVertexArray(m_vao);
@@ -218,7 +257,21 @@ void BlockWorldInstancing::onRender()
     glDepthMask(GL_TRUE);
 
     glUseProgram(m_program);
-    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 14, size());
+    // One draw per chunk, with the instance attributes starting at its range
+    glBindBuffer(GL_ARRAY_BUFFER, m_attributes);
+
+    for (auto chunk = size_t(0); chunk < m_chunks.chunkCount(); ++chunk)
+    {
+        if (m_chunks.counts()[chunk] == 0)
+        {
+            continue;
+        }
+
+        glVertexAttribIPointer(2, 4, GL_INT, sizeof(glm::ivec4), reinterpret_cast<void*>(m_chunks.starts()[chunk] * sizeof(glm::ivec4)));
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, m_chunks.counts()[chunk]);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     glUseProgram(0);
 
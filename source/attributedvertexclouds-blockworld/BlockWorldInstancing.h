@@ -10,6 +10,7 @@
 
 #include "Block.h"
 #include "BlockWorldImplementation.h"
+#include "ChunkRanges.h"
 
 
 class BlockWorldInstancing : public BlockWorldImplementation
@@ -24,6 +25,9 @@ public:
     virtual bool loadShader() override;
 
     virtual void setBlock(size_t index, const Block & block) override;
+    virtual void setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & origins) override;
+    virtual bool updateChunk(size_t chunk, const glm::ivec3 & origin, const std::vector<Block> & blocks) override;
+    virtual void updateBuffers() override;
 
     virtual size_t size() const override;
     virtual size_t verticesCount() const override;
@@ -31,12 +35,17 @@ public:
     virtual size_t byteSize() const override;
     virtual size_t vertexByteSize() const override;
     virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
 
     virtual void resize(size_t count) override;
 
+    virtual std::vector<gl::GLuint> buffers() const override;
+
     virtual gl::GLuint program() const override;
 public:
+    // Blocks in one range per chunk, including the free room of each range
     std::vector<glm::ivec4> m_positionAndType;
+    ChunkRanges m_chunks;
 
     gl::GLuint m_vertices;
     gl::GLuint m_attributes;
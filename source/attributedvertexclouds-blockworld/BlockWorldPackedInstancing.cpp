@@ -0,0 +1,301 @@
+
+#include "BlockWorldPackedInstancing.h"
+
+#include <array>
+
+#include <glm/vec4.hpp>
+
+#include <glbinding/gl/gl.h>
+
+#include "common.h"
+
+using namespace gl;
+
+BlockWorldPackedInstancing::BlockWorldPackedInstancing()
+: BlockWorldImplementation("Instancing (Packed)")
+, m_vertices(0)
+, m_attributes(0)
+, m_granuleOrigins(0)
+, m_vao(0)
+, m_granuleOriginTexture(0)
+, m_vertexShader(0)
+, m_fragmentShader(0)
+{
+}
+
+BlockWorldPackedInstancing::~BlockWorldPackedInstancing()
+{
+    if (!initialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_vertices);
+    glDeleteBuffers(1, &m_attributes);
+    glDeleteBuffers(1, &m_granuleOrigins);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteTextures(1, &m_granuleOriginTexture);
+    glDeleteShader(m_vertexShader);
+    glDeleteShader(m_fragmentShader);
+    glDeleteProgram(m_program);
+}
+
+void BlockWorldPackedInstancing::onInitialize()
+{
+    glGenBuffers(1, &m_vertices);
+    glGenBuffers(1, &m_attributes);
+    glGenBuffers(1, &m_granuleOrigins);
+    glGenVertexArrays(1, &m_vao);
+    glGenTextures(1, &m_granuleOriginTexture);
+
+    initializeVAO();
+
+    m_vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    m_fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+    m_program = glCreateProgram();
+
+    glAttachShader(m_program, m_vertexShader);
+    glAttachShader(m_program, m_fragmentShader);
+
+    loadShader();
+}
+
+void BlockWorldPackedInstancing::initializeVAO()
+{
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+
+    // Same cube as the unpacked instancing: two triangles per face in the order of the face bits
+    auto vertices = std::array<glm::vec3, 36>();
+    auto normals = std::array<glm::vec3, 36>();
+
+    for (auto face = size_t(0); face < Block::faceCount; ++face)
+    {
+        static const size_t corners[6] = { 0, 1, 2, 2, 1, 3 };
+
+        for (auto i = size_t(0); i < 6; ++i)
+        {
+            vertices[face * 6 + i] = Block::faceCorner(face, corners[i]) * 0.5f;
+            normals[face * 6 + i] = Block::faceNormal(face);
+        }
+    }
+
+    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * 2 * 36, nullptr, GL_STATIC_DRAW);
+
+    glBufferSubData(GL_ARRAY_BUFFER, 36 * sizeof(float) * 0, vertices.size() * sizeof(float) * 3, vertices.data());
+    glBufferSubData(GL_ARRAY_BUFFER, 36 * sizeof(float) * 3, normals.size() * sizeof(float) * 3, normals.data());
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(36 * sizeof(float) * 0));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(36 * sizeof(float) * 3));
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribDivisor(0, 0);
+    glVertexAttribDivisor(1, 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_attributes);
+    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_DYNAMIC_DRAW);
+
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_blocks.size() * sizeof(GLuint), m_blocks.data());
+
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);
+
+    glVertexAttribDivisor(2, 1);
+
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Chunk origins change only with the layout of the ranges
+    const auto granuleOrigins = m_chunks.granuleOrigins(m_chunkOrigins);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_granuleOrigins);
+    glBufferData(GL_TEXTURE_BUFFER, granuleOrigins.size() * sizeof(glm::ivec4), granuleOrigins.data(), GL_DYNAMIC_DRAW);
+
+    glBindTexture(GL_TEXTURE_BUFFER, m_granuleOriginTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32I, m_granuleOrigins);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+bool BlockWorldPackedInstancing::loadShader()
+{
+    const auto vertexShaderSource = loadShaderSource("/blockworld-instancing/packed.vert");
+    const auto vertexShaderSource_ptr = vertexShaderSource.c_str();
+    if(vertexShaderSource_ptr)
+        glShaderSource(m_vertexShader, 1, &vertexShaderSource_ptr, 0);
+
+    glCompileShader(m_vertexShader);
+
+    bool success = checkForCompilationError(m_vertexShader, "vertex shader");
+
+    const auto fragmentShaderSource = loadShaderSource("/blockworld.frag");
+    const auto fragmentShaderSource_ptr = fragmentShaderSource.c_str();
+    if(fragmentShaderSource_ptr)
+        glShaderSource(m_fragmentShader, 1, &fragmentShaderSource_ptr, 0);
+
+    glCompileShader(m_fragmentShader);
+
+    success &= checkForCompilationError(m_fragmentShader, "fragment shader");
+
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glLinkProgram(m_program);
+
+    success &= checkForLinkerError(m_program, "program");
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glUseProgram(m_program);
+    glUniform1f(glGetUniformLocation(m_program, "blockSize"), m_blockSize);
+    glUniform1i(glGetUniformLocation(m_program, "granularity"), static_cast<GLint>(ChunkRanges::granularity));
+    glUniform1i(glGetUniformLocation(m_program, "granuleOrigins"), 1);
+    glUseProgram(0);
+
+    glBindFragDataLocation(m_program, 0, "out_color");
+
+    return true;
+}
+
+void BlockWorldPackedInstancing::setBlock(size_t index, const Block & block)
+{
+    m_blocks[index] = block.packedBlock();
+}
+
+void BlockWorldPackedInstancing::setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & origins)
+{
+    m_chunks.layout(m_blocks, offsets);
+    m_chunkOrigins = origins;
+}
+
+bool BlockWorldPackedInstancing::updateChunk(size_t chunk, const glm::ivec3 & origin, const std::vector<Block> & blocks)
+{
+    auto packedBlocks = std::vector<GLuint>(blocks.size());
+
+    for (auto i = size_t(0); i < blocks.size(); ++i)
+    {
+        packedBlocks[i] = blocks[i].packedBlock();
+    }
+
+    const auto inPlace = m_chunks.replace(m_blocks, chunk, packedBlocks);
+
+    m_chunkOrigins.resize(m_chunks.chunkCount());
+    m_chunkOrigins[chunk] = origin;
+
+    if (!initialized())
+    {
+        return true;
+    }
+
+    if (!inPlace)
+    {
+        initializeVAO();
+
+        return true;
+    }
+
+    // The whole range, as the draw covers the free room as well
+    glBindBuffer(GL_ARRAY_BUFFER, m_attributes);
+    glBufferSubData(GL_ARRAY_BUFFER, m_chunks.starts()[chunk] * sizeof(GLuint), m_chunks.capacities()[chunk] * sizeof(GLuint), m_blocks.data() + m_chunks.starts()[chunk]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+void BlockWorldPackedInstancing::updateBuffers()
+{
+    initializeVAO();
+}
+
+size_t BlockWorldPackedInstancing::size() const
+{
+    return m_chunks.blockCount();
+}
+
+size_t BlockWorldPackedInstancing::verticesPerCuboid() const
+{
+    return 1;
+}
+
+size_t BlockWorldPackedInstancing::verticesCount() const
+{
+    return size() * verticesPerCuboid();
+}
+
+size_t BlockWorldPackedInstancing::staticByteSize() const
+{
+    return sizeof(glm::vec3) * 36 * 2 + m_blocks.size() / ChunkRanges::granularity * sizeof(glm::ivec4);
+}
+
+size_t BlockWorldPackedInstancing::byteSize() const
+{
+    return m_blocks.size() * vertexByteSize();
+}
+
+size_t BlockWorldPackedInstancing::vertexByteSize() const
+{
+    return sizeof(GLuint) * componentCount();
+}
+
+size_t BlockWorldPackedInstancing::componentCount() const
+{
+    return 1;
+}
+
+void BlockWorldPackedInstancing::resize(size_t count)
+{
+    m_blocks.resize(count * verticesPerCuboid());
+}
+
+size_t BlockWorldPackedInstancing::cpuByteSize() const
+{
+    return containerByteSize(m_blocks) + containerByteSize(m_chunkOrigins);
+}
+
+std::vector<gl::GLuint> BlockWorldPackedInstancing::buffers() const
+{
+    return { m_vertices, m_attributes, m_granuleOrigins };
+}
+
+void BlockWorldPackedInstancing::onRender()
+{
+    glBindVertexArray(m_vao);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, m_granuleOriginTexture);
+
+    glEnable(GL_DEPTH_TEST);
+
+    glDisable(GL_CULL_FACE);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    glUseProgram(m_program);
+
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, static_cast<GLsizei>(m_blocks.size()));
+
+    glUseProgram(0);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(0);
+}
+
+gl::GLuint BlockWorldPackedInstancing::program() const
+{
+    return m_program;
+}
@@ -0,0 +1,66 @@
+
+#pragma once
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include <glbinding/gl/types.h>
+
+#include "Block.h"
+#include "BlockWorldImplementation.h"
+#include "ChunkRanges.h"
+
+
+// Instancing with one 32-bit word per block instance, see Block::packedBlock().
+// One instanced draw covers all chunk ranges; the vertex shader looks up the chunk origin by instance and
+// collapses the default blocks in the free room of the ranges, which have no visible faces.
+class BlockWorldPackedInstancing : public BlockWorldImplementation
+{
+public:
+    BlockWorldPackedInstancing();
+    ~BlockWorldPackedInstancing();
+
+    virtual void onInitialize() override;
+    virtual void onRender() override;
+
+    virtual bool loadShader() override;
+
+    virtual void setBlock(size_t index, const Block & block) override;
+    virtual void setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & origins) override;
+    virtual bool updateChunk(size_t chunk, const glm::ivec3 & origin, const std::vector<Block> & blocks) override;
+    virtual void updateBuffers() override;
+
+    virtual size_t size() const override;
+    virtual size_t verticesCount() const override;
+    virtual size_t staticByteSize() const override;
+    virtual size_t byteSize() const override;
+    virtual size_t vertexByteSize() const override;
+    virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
+
+    virtual void resize(size_t count) override;
+
+    virtual std::vector<gl::GLuint> buffers() const override;
+
+    virtual gl::GLuint program() const override;
+public:
+    // Blocks in one range per chunk, including the free room of each range
+    std::vector<gl::GLuint> m_blocks;
+    std::vector<glm::ivec3> m_chunkOrigins;
+    ChunkRanges m_chunks;
+
+    gl::GLuint m_vertices;
+    gl::GLuint m_attributes;
+    gl::GLuint m_granuleOrigins;
+    gl::GLuint m_vao;
+    gl::GLuint m_granuleOriginTexture;
+
+    gl::GLuint m_vertexShader;
+    gl::GLuint m_fragmentShader;
+
+    gl::GLuint m_program;
+
+    void initializeVAO();
+    size_t verticesPerCuboid() const;
+};
@@ -0,0 +1,279 @@
+
+#include "BlockWorldPackedVertexCloud.h"
+
+#include <glm/vec4.hpp>
+
+#include <glbinding/gl/gl.h>
+
+#include "common.h"
+
+using namespace gl;
+
+BlockWorldPackedVertexCloud::BlockWorldPackedVertexCloud()
+: BlockWorldImplementation("Attributed Vertex Cloud (Packed)")
+, m_vertices(0)
+, m_granuleOrigins(0)
+, m_vao(0)
+, m_granuleOriginTexture(0)
+, m_vertexShader(0)
+, m_geometryShader(0)
+, m_fragmentShader(0)
+{
+}
+
+BlockWorldPackedVertexCloud::~BlockWorldPackedVertexCloud()
+{
+    if (!initialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_vertices);
+    glDeleteBuffers(1, &m_granuleOrigins);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteTextures(1, &m_granuleOriginTexture);
+    glDeleteShader(m_vertexShader);
+    glDeleteShader(m_geometryShader);
+    glDeleteShader(m_fragmentShader);
+    glDeleteProgram(m_program);
+}
+
+void BlockWorldPackedVertexCloud::onInitialize()
+{
+    glGenBuffers(1, &m_vertices);
+    glGenBuffers(1, &m_granuleOrigins);
+    glGenVertexArrays(1, &m_vao);
+    glGenTextures(1, &m_granuleOriginTexture);
+
+    initializeVAO();
+
+    m_vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    m_geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
+    m_fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+    m_program = glCreateProgram();
+
+    glAttachShader(m_program, m_vertexShader);
+    glAttachShader(m_program, m_geometryShader);
+    glAttachShader(m_program, m_fragmentShader);
+
+    loadShader();
+}
+
+void BlockWorldPackedVertexCloud::initializeVAO()
+{
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_DYNAMIC_DRAW);
+
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_blocks.size() * sizeof(GLuint), m_blocks.data());
+
+    glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);
+
+    glEnableVertexAttribArray(0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Chunk origins change only with the layout of the ranges
+    const auto granuleOrigins = m_chunks.granuleOrigins(m_chunkOrigins);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_granuleOrigins);
+    glBufferData(GL_TEXTURE_BUFFER, granuleOrigins.size() * sizeof(glm::ivec4), granuleOrigins.data(), GL_DYNAMIC_DRAW);
+
+    glBindTexture(GL_TEXTURE_BUFFER, m_granuleOriginTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32I, m_granuleOrigins);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+bool BlockWorldPackedVertexCloud::loadShader()
+{
+    const auto vertexShaderSource = loadShaderSource("/blockworld-avc/packed.vert");
+    const auto vertexShaderSource_ptr = vertexShaderSource.c_str();
+    if(vertexShaderSource_ptr)
+        glShaderSource(m_vertexShader, 1, &vertexShaderSource_ptr, 0);
+
+    glCompileShader(m_vertexShader);
+
+    bool success = checkForCompilationError(m_vertexShader, "vertex shader");
+
+
+    const auto geometryShaderSource = loadShaderSource("/blockworld-avc/standard.geom");
+    const auto geometryShaderSource_ptr = geometryShaderSource.c_str();
+    if(geometryShaderSource_ptr)
+        glShaderSource(m_geometryShader, 1, &geometryShaderSource_ptr, 0);
+
+    glCompileShader(m_geometryShader);
+
+    success &= checkForCompilationError(m_geometryShader, "geometry shader");
+
+
+    const auto fragmentShaderSource = loadShaderSource("/blockworld.frag");
+    const auto fragmentShaderSource_ptr = fragmentShaderSource.c_str();
+    if(fragmentShaderSource_ptr)
+        glShaderSource(m_fragmentShader, 1, &fragmentShaderSource_ptr, 0);
+
+    glCompileShader(m_fragmentShader);
+
+    success &= checkForCompilationError(m_fragmentShader, "fragment shader");
+
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glLinkProgram(m_program);
+
+    success &= checkForLinkerError(m_program, "program");
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glUseProgram(m_program);
+    glUniform1f(glGetUniformLocation(m_program, "blockSize"), m_blockSize);
+    glUniform1i(glGetUniformLocation(m_program, "granularity"), static_cast<GLint>(ChunkRanges::granularity));
+    glUniform1i(glGetUniformLocation(m_program, "granuleOrigins"), 1);
+    glUseProgram(0);
+
+    glBindFragDataLocation(m_program, 0, "out_color");
+
+    return true;
+}
+
+void BlockWorldPackedVertexCloud::setBlock(size_t index, const Block & block)
+{
+    m_blocks[index] = block.packedBlock();
+}
+
+void BlockWorldPackedVertexCloud::setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & origins)
+{
+    m_chunks.layout(m_blocks, offsets);
+    m_chunkOrigins = origins;
+}
+
+bool BlockWorldPackedVertexCloud::updateChunk(size_t chunk, const glm::ivec3 & origin, const std::vector<Block> & blocks)
+{
+    auto packedBlocks = std::vector<GLuint>(blocks.size());
+
+    for (auto i = size_t(0); i < blocks.size(); ++i)
+    {
+        packedBlocks[i] = blocks[i].packedBlock();
+    }
+
+    const auto inPlace = m_chunks.replace(m_blocks, chunk, packedBlocks);
+
+    m_chunkOrigins.resize(m_chunks.chunkCount());
+    m_chunkOrigins[chunk] = origin;
+
+    if (!initialized())
+    {
+        return true;
+    }
+
+    if (!inPlace)
+    {
+        initializeVAO();
+
+        return true;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferSubData(GL_ARRAY_BUFFER, m_chunks.starts()[chunk] * sizeof(GLuint), packedBlocks.size() * sizeof(GLuint), packedBlocks.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+void BlockWorldPackedVertexCloud::updateBuffers()
+{
+    initializeVAO();
+}
+
+size_t BlockWorldPackedVertexCloud::size() const
+{
+    return m_chunks.blockCount();
+}
+
+size_t BlockWorldPackedVertexCloud::verticesPerCuboid() const
+{
+    return 1;
+}
+
+size_t BlockWorldPackedVertexCloud::verticesCount() const
+{
+    return size() * verticesPerCuboid();
+}
+
+size_t BlockWorldPackedVertexCloud::staticByteSize() const
+{
+    return m_blocks.size() / ChunkRanges::granularity * sizeof(glm::ivec4);
+}
+
+size_t BlockWorldPackedVertexCloud::byteSize() const
+{
+    return m_blocks.size() * vertexByteSize();
+}
+
+size_t BlockWorldPackedVertexCloud::vertexByteSize() const
+{
+    return sizeof(GLuint) * componentCount();
+}
+
+size_t BlockWorldPackedVertexCloud::componentCount() const
+{
+    return 1;
+}
+
+void BlockWorldPackedVertexCloud::resize(size_t count)
+{
+    m_blocks.resize(count);
+}
+
+size_t BlockWorldPackedVertexCloud::cpuByteSize() const
+{
+    return containerByteSize(m_blocks) + containerByteSize(m_chunkOrigins);
+}
+
+std::vector<gl::GLuint> BlockWorldPackedVertexCloud::buffers() const
+{
+    return { m_vertices, m_granuleOrigins };
+}
+
+void BlockWorldPackedVertexCloud::onRender()
+{
+    glBindVertexArray(m_vao);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, m_granuleOriginTexture);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    glUseProgram(m_program);
+
+    glMultiDrawArrays(GL_POINTS, m_chunks.starts().data(), m_chunks.counts().data(), static_cast<GLsizei>(m_chunks.chunkCount()));
+
+    glUseProgram(0);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(0);
+}
+
+gl::GLuint BlockWorldPackedVertexCloud::program() const
+{
+    return m_program;
+}
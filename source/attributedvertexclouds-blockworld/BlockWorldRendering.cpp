@@ -4,6 +4,10 @@
 #include <iostream>
 #include <chrono>
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
+#include <utility>
 
 #include <glm/gtc/random.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -11,20 +15,67 @@
 #include <glbinding/gl/gl.h>
 
 #include "common.h"
+#include "PrimitiveGrid.h"
+#include "Trace.h"
 
 #include "BlockWorldVertexCloud.h"
 #include "BlockWorldTriangles.h"
 #include "BlockWorldTriangleStrip.h"
 #include "BlockWorldInstancing.h"
+#include "BlockWorldGreedyMeshing.h"
+#include "BlockWorldPackedVertexCloud.h"
+#include "BlockWorldPackedInstancing.h"
+#include "BlockWorldStreamingVertexCloud.h"
 
 
 using namespace gl;
 
 
+namespace
+{
+
+
+// In chunks; streamed chunks are kept up to one more chunk away, so they do not flicker at the border
+static const auto streamRadius = 8;
+static const auto evictionRadius = streamRadius + 1;
+
+// 32 MB of blocks, several times what the chunks within the eviction radius need
+static const auto streamPageCount = size_t(8192);
+
+// Chunks uploaded per frame at most, so a burst of generated chunks spreads over several frames
+static const auto streamUploadBudget = 32;
+
+// Seed of the positions of carved spheres
+static const auto carveSeed = size_t(1);
+
+// Techniques of createImplementation() with one vertex or instance per block: instancing, both vertex clouds and the packed ones.
+// The triangle techniques would need several gigabytes for the visible blocks of a large terrain.
+static const std::array<size_t, 5> terrainImplementations = {{ 2, 3, 4, 8, 9 }};
+
+
+// Chunk coordinate of a block coordinate
+int chunkCoordinate(int value)
+{
+    return value >= 0 ? value / BlockWorld::chunkSize : -((BlockWorld::chunkSize - 1 - value) / BlockWorld::chunkSize);
+}
+
+
+} // namespace
+
+
+const int BlockWorldRendering::initialBlockThreshold;
+
 BlockWorldRendering::BlockWorldRendering()
 : Rendering("BlockWorld")
 , m_terrainTexture(0)
-, m_blockThreshold(7)
+, m_blockThreshold(initialBlockThreshold)
+, m_terrainExtent(0)
+, m_worldBlockCount(0)
+, m_carveCount(0)
+, m_streamSpeed(0.0f)
+, m_streamer(nullptr)
+, m_streaming(nullptr)
+, m_streamDistance(0.0)
 {
 }
 
@@ -32,12 +83,76 @@ BlockWorldRendering::~BlockWorldRendering()
 {
 }
 
+void BlockWorldRendering::setTerrainExtent(int extent)
+{
+    m_terrainExtent = extent;
+}
+
+void BlockWorldRendering::setStreamSpeed(float blocksPerFrame)
+{
+    m_streamSpeed = blocksPerFrame;
+}
+
+Implementation * BlockWorldRendering::createImplementation(size_t index)
+{
+    switch (index)
+    {
+    case 0: return new BlockWorldTriangles;
+    case 1: return new BlockWorldTriangleStrip(StripDrawMode::MultiDraw);
+    case 2: return new BlockWorldInstancing;
+    case 3: return new BlockWorldVertexCloud(false);
+    case 4: return new BlockWorldVertexCloud(true);
+    case 5: return new BlockWorldTriangleStrip(StripDrawMode::PrimitiveRestart);
+    case 6: return new BlockWorldTriangleStrip(StripDrawMode::Degenerate);
+    case 7: return new BlockWorldGreedyMeshing;
+    case 8: return new BlockWorldPackedVertexCloud;
+    case 9: return new BlockWorldPackedInstancing;
+    default: return nullptr;
+    }
+}
+
 void BlockWorldRendering::onInitialize()
 {
-    addImplementation(new BlockWorldTriangles);
-    addImplementation(new BlockWorldTriangleStrip);
-    addImplementation(new BlockWorldInstancing);
-    addImplementation(new BlockWorldVertexCloud);
+    if (m_streamSpeed > 0.0f)
+    {
+        m_streaming = new BlockWorldStreamingVertexCloud(streamPageCount);
+        addImplementation(m_streaming);
+
+        // One core stays with the render thread
+        m_streamer = new ChunkStreamer(std::max(std::thread::hardware_concurrency(), 2u) - 1, m_blockThreshold);
+
+        m_streamOffsets.clear();
+
+        for (auto z = -streamRadius; z <= streamRadius; ++z)
+        {
+            for (auto x = -streamRadius; x <= streamRadius; ++x)
+            {
+                for (auto layer = ChunkStreamer::highestLayer; layer >= ChunkStreamer::lowestLayer && x * x + z * z <= streamRadius * streamRadius; --layer)
+                {
+                    m_streamOffsets.push_back(glm::ivec3(x, layer, z));
+                }
+            }
+        }
+
+        // Layers of a column stay in order from the surface down
+        std::stable_sort(m_streamOffsets.begin(), m_streamOffsets.end(), [](const glm::ivec3 & a, const glm::ivec3 & b) {
+            return a.x * a.x + a.z * a.z < b.x * b.x + b.z * b.z;
+        });
+    }
+    else if (m_terrainExtent > 0)
+    {
+        for (auto index : terrainImplementations)
+        {
+            addImplementation(createImplementation(index));
+        }
+    }
+    else
+    {
+        for (auto index = size_t(0); auto implementation = createImplementation(index); ++index)
+        {
+            addImplementation(implementation);
+        }
+    }
 
     glGenTextures(1, &m_terrainTexture);
 
@@ -58,44 +173,372 @@ void BlockWorldRendering::onInitialize()
 void BlockWorldRendering::onDeinitialize()
 {
     glDeleteTextures(1, &m_terrainTexture);
+
+    // The technique is deleted with the others
+    delete m_streamer;
+
+    m_streamer = nullptr;
+    m_streaming = nullptr;
+    m_streamedChunks.clear();
+    m_pendingChunks.clear();
 }
 
 void BlockWorldRendering::onCreateGeometry()
 {
-    const auto blockGridSize = m_gridSize;
-    const auto blockCount = static_cast<std::size_t>(blockGridSize * blockGridSize * blockGridSize);
-    const auto worldScale = glm::vec3(1.0f) / glm::vec3(blockGridSize, blockGridSize, blockGridSize);
+    // Chunks arrive while rendering
+    if (m_streamer)
+    {
+        m_streaming->setBlockSize(1.0f / (2 * streamRadius * BlockWorld::chunkSize));
+
+        std::cout << "Streaming " << m_streamOffsets.size() << " chunks around the camera with " << m_streamer->workerCount() << " workers" << std::endl;
+
+        return;
+    }
 
-    for (auto implementation : m_implementations)
+    // Edits survive a recreation, e.g., for another block threshold
+    if (m_terrainExtent > 0 ? m_world.extent().x != m_terrainExtent : m_worldBlockCount != m_primitiveCount)
     {
-        implementation->resize(blockCount);
-        static_cast<BlockWorldImplementation*>(implementation)->setBlockSize(worldScale.x);
+        m_world = m_terrainExtent > 0 ? createTerrain(m_terrainExtent) : createWorld(m_primitiveCount);
+        m_worldBlockCount = m_primitiveCount;
+
+        std::cout << "World of " << m_world.chunkCount() << " chunks in " << (m_world.byteSize() / 1024 / 1024) << " MB" << std::endl;
     }
 
-    std::array<std::vector<float>, 1> noise;
-    for (auto i = size_t(0); i < noise.size(); ++i)
+    m_world.setThreshold(m_blockThreshold);
+    m_world.takeDirtyChunks();
+
+    fill(m_world, geometryImplementations());
+
+    m_outdated.clear();
+}
+
+void BlockWorldRendering::createGeometry(size_t blockCount, const std::vector<Implementation *> & implementations, int blockThreshold)
+{
+    auto world = createWorld(blockCount);
+    world.setThreshold(blockThreshold);
+
+    fill(world, implementations);
+}
+
+BlockWorld BlockWorldRendering::createWorld(size_t blockCount)
+{
+    auto grid = PrimitiveGrid(blockCount);
+    const auto size = grid.size();
+    const auto lower = -glm::ivec3(size.x / 2, size.x / 2, size.x / 2);
+
+    grid.loadNoise(1);
+
+    auto world = BlockWorld();
+    world.reset(lower, size);
+
+    // The last layer of the grid may be partially filled
+    world.generate([&grid, size, lower, blockCount](const glm::ivec3 & position) {
+        const auto cell = position - lower;
+        const auto index = static_cast<size_t>(cell.x) + static_cast<size_t>(size.x) * (static_cast<size_t>(cell.y) + static_cast<size_t>(size.y) * cell.z);
+
+        return index < blockCount ? static_cast<int>(glm::round(16.0f * grid.noise(0, index))) : BlockWorld::airType;
+    });
+
+    return world;
+}
+
+BlockWorld BlockWorldRendering::createTerrain(int extent)
+{
+    static const auto grassType = 16;
+    static const auto dirtType = 12;
+    static const auto stoneType = 8;
+
+    const auto depth = std::max(extent * 3 / 200, 8);
+    const auto amplitude = std::max(extent / 100, 4);
+    const auto scale = 16.0f / static_cast<float>(extent);
+
+    auto world = BlockWorld();
+    world.reset(glm::ivec3(-extent / 2, -depth, -extent / 2), glm::ivec3(extent));
+
+    world.generateChunks([amplitude, scale](const glm::ivec3 & origin, std::vector<signed char> & types) {
+        if (origin.y > amplitude)
+        {
+            return false;
+        }
+
+        for (auto z = 0; z < BlockWorld::chunkSize; ++z)
+        {
+            for (auto x = 0; x < BlockWorld::chunkSize; ++x)
+            {
+                // Hills with finer detail on top
+                const auto column = glm::vec3(origin.x + x, origin.z + z, 0.0f) * scale;
+                const auto noise = 0.75f * PrimitiveGrid::valueNoise(column, 0) + 0.25f * PrimitiveGrid::valueNoise(column * 4.0f, 1);
+                const auto height = static_cast<int>(glm::round(amplitude * noise)) - origin.y;
+
+                for (auto y = 0; y < std::min(height + 1, BlockWorld::chunkSize); ++y)
+                {
+                    const auto type = y == height ? grassType : (y + 3 >= height ? dirtType : stoneType);
+
+                    types[x + BlockWorld::chunkSize * (y + BlockWorld::chunkSize * z)] = static_cast<signed char>(type);
+                }
+            }
+        }
+
+        return true;
+    });
+
+    return world;
+}
+
+void BlockWorldRendering::fill(const BlockWorld & world, const std::vector<Implementation *> & implementations)
+{
+    // Only blocks with visible faces are set, chunk after chunk
+    auto chunks = std::vector<std::vector<Block>>(world.chunkCount());
+
+#pragma omp parallel for schedule(dynamic)
+    for (long chunk = 0; chunk < static_cast<long>(chunks.size()); ++chunk)
+    {
+        chunks[chunk] = world.visibleBlocks(chunk);
+    }
+
+    auto offsets = std::vector<size_t>(chunks.size() + 1, 0);
+
+    for (auto chunk = size_t(0); chunk < chunks.size(); ++chunk)
+    {
+        offsets[chunk + 1] = offsets[chunk] + chunks[chunk].size();
+    }
+
+    for (auto implementation : implementations)
     {
-        noise[i] = loadNoise("/noise-"+std::to_string(blockGridSize)+"-"+std::to_string(i)+".raw");
+        implementation->resize(offsets.back());
+        static_cast<BlockWorldImplementation*>(implementation)->setBlockSize(1.0f / world.extent().x);
     }
 
-#pragma omp parallel for
-    for (size_t i = 0; i < blockCount; ++i)
+#pragma omp parallel for schedule(dynamic)
+    for (long chunk = 0; chunk < static_cast<long>(chunks.size()); ++chunk)
     {
-        const auto position = glm::ivec3(i % blockGridSize, (i / blockGridSize) % blockGridSize, i / blockGridSize / blockGridSize) - glm::ivec3(blockGridSize / 2, blockGridSize / 2, blockGridSize / 2);
+        for (auto i = size_t(0); i < chunks[chunk].size(); ++i)
+        {
+            for (auto implementation : implementations)
+            {
+                static_cast<BlockWorldImplementation*>(implementation)->setBlock(offsets[chunk] + i, chunks[chunk][i]);
+            }
+        }
+    }
 
-        Block b;
-        b.position = position;
-        b.type = static_cast<int>(glm::round(16.0f * noise[0][i]));
+    auto origins = std::vector<glm::ivec3>(chunks.size());
+
+    for (auto chunk = size_t(0); chunk < chunks.size(); ++chunk)
+    {
+        origins[chunk] = world.chunkOrigin(chunk);
+    }
+
+    for (auto implementation : implementations)
+    {
+        static_cast<BlockWorldImplementation*>(implementation)->setChunks(offsets, origins);
+    }
+}
+
+void BlockWorldRendering::setBlock(const glm::ivec3 & position, int type)
+{
+    m_world.setType(position, type);
+}
+
+void BlockWorldRendering::removeBlock(const glm::ivec3 & position)
+{
+    m_world.setType(position, BlockWorld::airType);
+}
+
+void BlockWorldRendering::carveSphere()
+{
+    static const auto radius = 6;
+
+    if (m_world.chunkCount() == 0)
+    {
+        return;
+    }
+
+    const auto edit = ++m_carveCount;
+
+    record("carve", static_cast<int>(edit));
+
+    // Within a stored chunk, as most of a sparse world is air; hashed from the edit number, so replays carve the same spheres
+    const auto random = [edit](size_t component) {
+        return hashValue(4 * edit + component, carveSeed);
+    };
+
+    const auto chunk = std::min(static_cast<size_t>(random(0) * m_world.chunkCount()), m_world.chunkCount() - 1);
+    const auto cell = glm::ivec3(glm::vec3(random(1), random(2), random(3)) * static_cast<float>(BlockWorld::chunkSize - 1));
+    const auto center = m_world.chunkOrigin(chunk) + cell;
+
+    for (auto z = -radius; z <= radius; ++z)
+    {
+        for (auto y = -radius; y <= radius; ++y)
+        {
+            for (auto x = -radius; x <= radius; ++x)
+            {
+                if (x * x + y * y + z * z <= radius * radius)
+                {
+                    removeBlock(center + glm::ivec3(x, y, z));
+                }
+            }
+        }
+    }
+
+    std::cout << "Carved a sphere at (" << center.x << ", " << center.y << ", " << center.z << ")" << std::endl;
+}
+
+void BlockWorldRendering::updateChunks()
+{
+    const auto chunks = m_world.takeDirtyChunks();
+
+    if (!chunks.empty())
+    {
+        TraceZone zone("BlockWorldRendering::updateChunks", m_name);
+
+        auto blocks = std::vector<std::vector<Block>>(chunks.size());
+
+#pragma omp parallel for schedule(dynamic)
+        for (long i = 0; i < static_cast<long>(chunks.size()); ++i)
+        {
+            blocks[i] = m_world.visibleBlocks(chunks[i]);
+        }
 
         for (auto implementation : m_implementations)
         {
-            static_cast<BlockWorldImplementation*>(implementation)->setBlock(i, b);
+            for (auto i = size_t(0); i < chunks.size() && m_outdated.count(implementation) == 0; ++i)
+            {
+                if (!static_cast<BlockWorldImplementation*>(implementation)->updateChunk(chunks[i], m_world.chunkOrigin(chunks[i]), blocks[i]))
+                {
+                    m_outdated.insert(implementation);
+                }
+            }
+        }
+    }
+
+    // Techniques without chunks are refilled from the world once they are rendered again
+    if (m_outdated.count(m_current) > 0)
+    {
+        TraceZone zone("BlockWorldRendering::refill", m_current->name());
+
+        fill(m_world, std::vector<Implementation *>(1, m_current));
+        static_cast<BlockWorldImplementation*>(m_current)->updateBuffers();
+
+        m_outdated.erase(m_current);
+    }
+}
+
+void BlockWorldRendering::updateStreaming()
+{
+    TraceZone zone("BlockWorldRendering::updateStreaming", m_name);
+
+    // Uploads need the buffers
+    m_streaming->initialize();
+
+    m_streamDistance += m_streamSpeed;
+
+    const auto whole = std::floor(m_streamDistance);
+    const auto streamOrigin = glm::ivec3(static_cast<int>(whole), 0, 0);
+    const auto center = glm::ivec3(chunkCoordinate(streamOrigin.x), 0, chunkCoordinate(streamOrigin.z));
+
+    m_streaming->setStreamPosition(streamOrigin, glm::vec3(static_cast<float>(m_streamDistance - whole), 0.0f, 0.0f));
+
+    for (auto chunk = m_streamedChunks.begin(); chunk != m_streamedChunks.end(); )
+    {
+        const auto offset = chunk->first / BlockWorld::chunkSize - center;
+
+        if (offset.x * offset.x + offset.z * offset.z <= evictionRadius * evictionRadius)
+        {
+            ++chunk;
+
+            continue;
+        }
+
+        if (chunk->second)
+        {
+            m_streaming->removeChunk(chunk->first);
+        }
+
+        chunk = m_streamedChunks.erase(chunk);
+    }
+
+    auto uploads = 0;
+
+    // Chunks that found too few free pages come first, once evictions freed some
+    for (auto pending = m_pendingChunks.begin(); pending != m_pendingChunks.end() && uploads < streamUploadBudget; )
+    {
+        const auto chunk = m_streamedChunks.find(pending->origin);
+
+        // Evicted while it waited, or added from a later request
+        if (chunk == m_streamedChunks.end() || chunk->second)
+        {
+            pending = m_pendingChunks.erase(pending);
+
+            continue;
+        }
+
+        if (!m_streaming->addChunk(pending->origin, pending->blocks))
+        {
+            ++pending;
+
+            continue;
         }
+
+        chunk->second = true;
+        pending = m_pendingChunks.erase(pending);
+
+        ++uploads;
+    }
+
+    auto generated = ChunkStreamer::GeneratedChunk();
+
+    // While chunks wait for pages, the results stay with the workers
+    for (; uploads < streamUploadBudget && m_pendingChunks.empty() && m_streamer->poll(generated); ++uploads)
+    {
+        const auto chunk = m_streamedChunks.find(generated.origin);
+
+        // Evicted while it was generated, or generated twice after an eviction and a new request and added already
+        if (chunk == m_streamedChunks.end() || chunk->second)
+        {
+            continue;
+        }
+
+        if (m_streaming->addChunk(generated.origin, generated.blocks))
+        {
+            chunk->second = true;
+        }
+        else
+        {
+            // The pool is full; the chunk stays requested, so it is neither generated nor requested again
+            m_pendingChunks.push_back(std::move(generated));
+        }
+    }
+
+    for (const auto & offset : m_streamOffsets)
+    {
+        const auto origin = (center + offset) * BlockWorld::chunkSize;
+
+        if (m_streamedChunks.count(origin) > 0)
+        {
+            continue;
+        }
+
+        // The queues of all workers are full; the remaining chunks are requested in later frames
+        if (!m_streamer->request(origin))
+        {
+            break;
+        }
+
+        m_streamedChunks[origin] = false;
     }
 }
 
 void BlockWorldRendering::onPrepareRendering()
 {
+    if (m_streamer)
+    {
+        updateStreaming();
+    }
+    else
+    {
+        updateChunks();
+    }
+
     GLuint program = m_current->program();
     const auto terrainSamplerLocation = glGetUniformLocation(program, "terrain");
     const auto blockThresholdLocation = glGetUniformLocation(program, "blockThreshold");
@@ -117,10 +560,52 @@ void BlockWorldRendering::onFinalizeRendering()
 
 void BlockWorldRendering::increaseBlockThreshold()
 {
-    m_blockThreshold = glm::min(m_blockThreshold+1, 14);
+    setBlockThreshold(glm::min(m_blockThreshold+1, 14));
 }
 
 void BlockWorldRendering::decreaseBlockThreshold()
 {
-    m_blockThreshold = glm::max(m_blockThreshold-1, 0);
+    setBlockThreshold(glm::max(m_blockThreshold-1, 0));
+}
+
+void BlockWorldRendering::setBlockThreshold(int threshold)
+{
+    if (threshold == m_blockThreshold)
+    {
+        return;
+    }
+
+    m_blockThreshold = threshold;
+
+    record("blockThreshold", m_blockThreshold);
+
+    // The visible faces depend on which blocks are solid
+    recreateGeometry();
+}
+
+void BlockWorldRendering::onStartRecording()
+{
+    record("blockThreshold", m_blockThreshold);
+}
+
+bool BlockWorldRendering::onReplay(const InteractionEvent & event)
+{
+    if (event.command == "blockThreshold")
+    {
+        setBlockThreshold(event.value);
+
+        return true;
+    }
+
+    if (event.command == "carve")
+    {
+        // Continues with the recorded edit number
+        m_carveCount = static_cast<size_t>(std::max(event.value, 1) - 1);
+
+        carveSphere();
+
+        return true;
+    }
+
+    return false;
 }
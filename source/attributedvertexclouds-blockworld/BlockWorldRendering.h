@@ -1,26 +1,108 @@
 
+#pragma once
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
 #include <glbinding/gl/types.h>
 
 #include "Rendering.h"
+#include "BlockWorld.h"
+#include "ChunkStreamer.h"
+
+
+class BlockWorldStreamingVertexCloud;
 
 
 class BlockWorldRendering : public Rendering
 {
 public:
+    // Blocks with a type up to the threshold are air; the demo starts with this one
+    static const int initialBlockThreshold = 7;
+
     BlockWorldRendering();
     virtual ~BlockWorldRendering();
 
+    // Fills the implementations with a block terrain of the given number of blocks; needs no GL context.
+    // Blocks with a type up to the threshold are air, and only faces that border air or the end of the world are visible.
+    static void createGeometry(size_t primitiveCount, const std::vector<Implementation *> & implementations, int blockThreshold);
+
+    // Creates the technique at the given position of the demo's list, or nullptr past its end; needs no GL context.
+    // The streaming technique is not part of the list, as it takes its blocks per chunk.
+    static Implementation * createImplementation(size_t index);
+
+    // Replaces the noise blocks with a heightmap terrain of extent³ blocks, independent of the primitive count; zero switches back.
+    // Terrains only offer the techniques with one vertex or instance per block. Has to be set before initialization.
+    void setTerrainExtent(int extent);
+
+    // Streams an unbounded terrain in chunks around a camera that moves by the given number of blocks per frame, instead of
+    // creating a world; zero switches back. Chunks are generated on worker threads, so no frame waits on generation.
+    // Has to be set before initialization.
+    void setStreamSpeed(float blocksPerFrame);
+
     void increaseBlockThreshold();
     void decreaseBlockThreshold();
 
+    // Block edits; the techniques are updated before the next frame, those with chunks only in the edited chunks
+    // and their neighbors, the others as a whole
+    void setBlock(const glm::ivec3 & position, int type);
+    void removeBlock(const glm::ivec3 & position);
+
+    // Removes the blocks within a sphere at a random position, the same in every session for the n-th sphere
+    void carveSphere();
+
 protected:
     gl::GLuint m_terrainTexture;
 
     int m_blockThreshold;
+    int m_terrainExtent;
+
+    BlockWorld m_world;
+    size_t m_worldBlockCount;
+
+    // Spheres carved so far, which seeds the position of the next one
+    size_t m_carveCount;
+
+    // Techniques that missed edits
+    std::set<Implementation *> m_outdated;
+
+    float m_streamSpeed;
+    ChunkStreamer * m_streamer;
+    BlockWorldStreamingVertexCloud * m_streaming;
+
+    // Requested chunks, and whether they are uploaded yet
+    std::unordered_map<glm::ivec3, bool, ChunkStreamer::OriginHash> m_streamedChunks;
+
+    // Generated chunks that wait for free pages
+    std::vector<ChunkStreamer::GeneratedChunk> m_pendingChunks;
+
+    // Chunk offsets within the streaming radius, nearest first, so chunks are requested in rings around the camera
+    std::vector<glm::ivec3> m_streamOffsets;
+
+    // Distance the camera moved along x, in blocks
+    double m_streamDistance;
+
+    void setBlockThreshold(int threshold);
+
+    static BlockWorld createWorld(size_t blockCount);
+
+    // Fills about 1.5% of the bounds: the surface lies around y = 0, with one block of grass on three of dirt on stone
+    static BlockWorld createTerrain(int extent);
+    static void fill(const BlockWorld & world, const std::vector<Implementation *> & implementations);
+
+    void updateChunks();
+
+    // Evicts the chunks that fell behind, uploads generated ones within a budget per frame, and requests missing ones
+    void updateStreaming();
 
     virtual void onInitialize() override;
     virtual void onDeinitialize() override;
     virtual void onCreateGeometry() override;
     virtual void onPrepareRendering() override;
     virtual void onFinalizeRendering() override;
+    virtual void onStartRecording() override;
+    virtual bool onReplay(const InteractionEvent & event) override;
 };
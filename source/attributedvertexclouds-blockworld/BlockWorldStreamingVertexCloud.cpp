@@ -0,0 +1,357 @@
+
+#include "BlockWorldStreamingVertexCloud.h"
+
+#include <algorithm>
+
+#include <glm/vec4.hpp>
+
+#include <glbinding/gl/gl.h>
+
+#include "common.h"
+
+using namespace gl;
+
+BlockWorldStreamingVertexCloud::BlockWorldStreamingVertexCloud(size_t pageCount)
+: BlockWorldImplementation("Attributed Vertex Cloud (Streaming)")
+, m_pageCount(pageCount)
+, m_pageBlockCounts(pageCount, 0)
+, m_blockCount(0)
+, m_drawOutdated(false)
+, m_streamOrigin(0)
+, m_streamFraction(0.0f)
+, m_vertices(0)
+, m_pageOrigins(0)
+, m_pageOriginTexture(0)
+, m_vao(0)
+, m_vertexShader(0)
+, m_geometryShader(0)
+, m_fragmentShader(0)
+{
+    // Low pages are handed out first
+    for (auto page = pageCount; page > 0; --page)
+    {
+        m_freePages.push_back(page - 1);
+    }
+}
+
+BlockWorldStreamingVertexCloud::~BlockWorldStreamingVertexCloud()
+{
+    if (!initialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_vertices);
+    glDeleteBuffers(1, &m_pageOrigins);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteTextures(1, &m_pageOriginTexture);
+    glDeleteShader(m_vertexShader);
+    glDeleteShader(m_geometryShader);
+    glDeleteShader(m_fragmentShader);
+    glDeleteProgram(m_program);
+}
+
+void BlockWorldStreamingVertexCloud::onInitialize()
+{
+    glGenBuffers(1, &m_vertices);
+    glGenBuffers(1, &m_pageOrigins);
+    glGenVertexArrays(1, &m_vao);
+    glGenTextures(1, &m_pageOriginTexture);
+
+    // The pool is allocated once; streaming only ever overwrites parts of it
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_DYNAMIC_DRAW);
+
+    glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);
+
+    glEnableVertexAttribArray(0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_pageOrigins);
+    glBufferData(GL_TEXTURE_BUFFER, staticByteSize(), nullptr, GL_DYNAMIC_DRAW);
+
+    glBindTexture(GL_TEXTURE_BUFFER, m_pageOriginTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32I, m_pageOrigins);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    m_vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    m_geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
+    m_fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+    m_program = glCreateProgram();
+
+    glAttachShader(m_program, m_vertexShader);
+    glAttachShader(m_program, m_geometryShader);
+    glAttachShader(m_program, m_fragmentShader);
+
+    loadShader();
+}
+
+bool BlockWorldStreamingVertexCloud::loadShader()
+{
+    const auto vertexShaderSource = loadShaderSource("/blockworld-avc/streaming.vert");
+    const auto vertexShaderSource_ptr = vertexShaderSource.c_str();
+    if(vertexShaderSource_ptr)
+        glShaderSource(m_vertexShader, 1, &vertexShaderSource_ptr, 0);
+
+    glCompileShader(m_vertexShader);
+
+    bool success = checkForCompilationError(m_vertexShader, "vertex shader");
+
+
+    const auto geometryShaderSource = loadShaderSource("/blockworld-avc/standard.geom");
+    const auto geometryShaderSource_ptr = geometryShaderSource.c_str();
+    if(geometryShaderSource_ptr)
+        glShaderSource(m_geometryShader, 1, &geometryShaderSource_ptr, 0);
+
+    glCompileShader(m_geometryShader);
+
+    success &= checkForCompilationError(m_geometryShader, "geometry shader");
+
+
+    const auto fragmentShaderSource = loadShaderSource("/blockworld.frag");
+    const auto fragmentShaderSource_ptr = fragmentShaderSource.c_str();
+    if(fragmentShaderSource_ptr)
+        glShaderSource(m_fragmentShader, 1, &fragmentShaderSource_ptr, 0);
+
+    glCompileShader(m_fragmentShader);
+
+    success &= checkForCompilationError(m_fragmentShader, "fragment shader");
+
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glLinkProgram(m_program);
+
+    success &= checkForLinkerError(m_program, "program");
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glUseProgram(m_program);
+    glUniform1f(glGetUniformLocation(m_program, "blockSize"), m_blockSize);
+    glUniform1i(glGetUniformLocation(m_program, "pageSize"), pageSize);
+    glUniform1i(glGetUniformLocation(m_program, "pageOrigins"), 1);
+    glUseProgram(0);
+
+    glBindFragDataLocation(m_program, 0, "out_color");
+
+    return true;
+}
+
+void BlockWorldStreamingVertexCloud::setBlock(size_t /*index*/, const Block & /*block*/)
+{
+}
+
+void BlockWorldStreamingVertexCloud::updateBuffers()
+{
+}
+
+bool BlockWorldStreamingVertexCloud::addChunk(const glm::ivec3 & origin, const std::vector<gl::GLuint> & blocks)
+{
+    const auto pageCount = (blocks.size() + pageSize - 1) / pageSize;
+
+    if (pageCount > m_freePages.size())
+    {
+        return false;
+    }
+
+    auto & pages = m_chunkPages[origin];
+    const auto pageOrigin = glm::ivec4(origin, 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBindBuffer(GL_TEXTURE_BUFFER, m_pageOrigins);
+
+    for (auto i = size_t(0); i < pageCount; ++i)
+    {
+        const auto page = m_freePages.back();
+        const auto count = std::min(blocks.size() - i * pageSize, static_cast<size_t>(pageSize));
+
+        m_freePages.pop_back();
+        pages.push_back(page);
+
+        m_pageBlockCounts[page] = count;
+
+        glBufferSubData(GL_ARRAY_BUFFER, page * pageSize * sizeof(GLuint), count * sizeof(GLuint), blocks.data() + i * pageSize);
+        glBufferSubData(GL_TEXTURE_BUFFER, page * sizeof(glm::ivec4), sizeof(glm::ivec4), &pageOrigin);
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_blockCount += blocks.size();
+    m_drawOutdated = true;
+
+    return true;
+}
+
+void BlockWorldStreamingVertexCloud::removeChunk(const glm::ivec3 & origin)
+{
+    const auto chunk = m_chunkPages.find(origin);
+
+    if (chunk == m_chunkPages.end())
+    {
+        return;
+    }
+
+    // The stale contents of freed pages are never drawn
+    for (const auto page : chunk->second)
+    {
+        m_blockCount -= m_pageBlockCounts[page];
+        m_pageBlockCounts[page] = 0;
+
+        m_freePages.push_back(page);
+    }
+
+    m_chunkPages.erase(chunk);
+    m_drawOutdated = true;
+}
+
+size_t BlockWorldStreamingVertexCloud::chunkCount() const
+{
+    return m_chunkPages.size();
+}
+
+size_t BlockWorldStreamingVertexCloud::freePageCount() const
+{
+    return m_freePages.size();
+}
+
+void BlockWorldStreamingVertexCloud::setStreamPosition(const glm::ivec3 & origin, const glm::vec3 & fraction)
+{
+    m_streamOrigin = origin;
+    m_streamFraction = fraction;
+}
+
+void BlockWorldStreamingVertexCloud::updateDrawArguments()
+{
+    m_starts.clear();
+    m_counts.clear();
+
+    for (auto page = size_t(0); page < m_pageCount; ++page)
+    {
+        if (m_pageBlockCounts[page] == 0)
+        {
+            continue;
+        }
+
+        const auto start = static_cast<GLint>(page * pageSize);
+        const auto count = static_cast<GLsizei>(m_pageBlockCounts[page]);
+
+        // A full page continues into the next one without a gap
+        if (!m_starts.empty() && m_starts.back() + m_counts.back() == start)
+        {
+            m_counts.back() += count;
+        }
+        else
+        {
+            m_starts.push_back(start);
+            m_counts.push_back(count);
+        }
+    }
+
+    m_drawOutdated = false;
+}
+
+size_t BlockWorldStreamingVertexCloud::size() const
+{
+    return m_blockCount;
+}
+
+size_t BlockWorldStreamingVertexCloud::verticesCount() const
+{
+    return size();
+}
+
+size_t BlockWorldStreamingVertexCloud::staticByteSize() const
+{
+    return m_pageCount * sizeof(glm::ivec4);
+}
+
+size_t BlockWorldStreamingVertexCloud::byteSize() const
+{
+    return m_pageCount * pageSize * vertexByteSize();
+}
+
+size_t BlockWorldStreamingVertexCloud::vertexByteSize() const
+{
+    return sizeof(GLuint) * componentCount();
+}
+
+size_t BlockWorldStreamingVertexCloud::componentCount() const
+{
+    return 1;
+}
+
+void BlockWorldStreamingVertexCloud::resize(size_t /*count*/)
+{
+}
+
+size_t BlockWorldStreamingVertexCloud::cpuByteSize() const
+{
+    auto result = containerByteSize(m_freePages) + containerByteSize(m_pageBlockCounts) + containerByteSize(m_starts) + containerByteSize(m_counts);
+
+    for (const auto & chunk : m_chunkPages)
+    {
+        result += sizeof(chunk) + containerByteSize(chunk.second);
+    }
+
+    return result;
+}
+
+std::vector<gl::GLuint> BlockWorldStreamingVertexCloud::buffers() const
+{
+    return { m_vertices, m_pageOrigins };
+}
+
+void BlockWorldStreamingVertexCloud::onRender()
+{
+    if (m_drawOutdated)
+    {
+        updateDrawArguments();
+    }
+
+    glBindVertexArray(m_vao);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, m_pageOriginTexture);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    glUseProgram(m_program);
+
+    glUniform3i(glGetUniformLocation(m_program, "streamOrigin"), m_streamOrigin.x, m_streamOrigin.y, m_streamOrigin.z);
+    glUniform3f(glGetUniformLocation(m_program, "streamFraction"), m_streamFraction.x, m_streamFraction.y, m_streamFraction.z);
+
+    glMultiDrawArrays(GL_POINTS, m_starts.data(), m_counts.data(), static_cast<GLsizei>(m_starts.size()));
+
+    glUseProgram(0);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(0);
+}
+
+gl::GLuint BlockWorldStreamingVertexCloud::program() const
+{
+    return m_program;
+}
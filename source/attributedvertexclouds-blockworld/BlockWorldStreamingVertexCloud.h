@@ -0,0 +1,92 @@
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include <glbinding/gl/types.h>
+
+#include "Block.h"
+#include "BlockWorldImplementation.h"
+#include "ChunkStreamer.h"
+
+
+// The packed attributed vertex cloud over a fixed pool of pages, for chunks that come and go while the camera moves.
+// Each chunk takes as many pages as its blocks need; the chunk origin of each page is kept in a texture buffer,
+// so all pages are drawn with a single multi-draw. Blocks come from addChunk() instead of setBlock().
+class BlockWorldStreamingVertexCloud : public BlockWorldImplementation
+{
+public:
+    // Blocks per page
+    static const int pageSize = 1024;
+
+    BlockWorldStreamingVertexCloud(size_t pageCount);
+    ~BlockWorldStreamingVertexCloud();
+
+    virtual void onInitialize() override;
+    virtual void onRender() override;
+
+    virtual bool loadShader() override;
+
+    // Unused, the blocks of streamed chunks are added per chunk
+    virtual void setBlock(size_t index, const Block & block) override;
+    virtual void updateBuffers() override;
+
+    // Uploads the packed blocks of a chunk into free pages; returns false if too few pages are free.
+    // Expects the technique to be initialized and the chunk not to be added yet.
+    bool addChunk(const glm::ivec3 & origin, const std::vector<gl::GLuint> & blocks);
+
+    // Frees the pages of a chunk
+    void removeChunk(const glm::ivec3 & origin);
+
+    size_t chunkCount() const;
+    size_t freePageCount() const;
+
+    // Blocks are drawn relative to the given position, in blocks, which keeps the coordinates small however far the camera moved
+    void setStreamPosition(const glm::ivec3 & origin, const glm::vec3 & fraction);
+
+    virtual size_t size() const override;
+    virtual size_t verticesCount() const override;
+    virtual size_t staticByteSize() const override;
+    virtual size_t byteSize() const override;
+    virtual size_t vertexByteSize() const override;
+    virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
+
+    virtual void resize(size_t count) override;
+
+    virtual std::vector<gl::GLuint> buffers() const override;
+
+    virtual gl::GLuint program() const override;
+public:
+    size_t m_pageCount;
+
+    // Pages of each chunk, and the blocks within each page, zero for free pages
+    std::unordered_map<glm::ivec3, std::vector<size_t>, ChunkStreamer::OriginHash> m_chunkPages;
+    std::vector<size_t> m_freePages;
+    std::vector<size_t> m_pageBlockCounts;
+    size_t m_blockCount;
+
+    // Multi-draw arguments, rebuilt from the page block counts after changes; adjacent pages are merged where possible
+    std::vector<gl::GLint> m_starts;
+    std::vector<gl::GLsizei> m_counts;
+    bool m_drawOutdated;
+
+    glm::ivec3 m_streamOrigin;
+    glm::vec3 m_streamFraction;
+
+    gl::GLuint m_vertices;
+    gl::GLuint m_pageOrigins;
+    gl::GLuint m_pageOriginTexture;
+    gl::GLuint m_vao;
+
+    gl::GLuint m_vertexShader;
+    gl::GLuint m_geometryShader;
+    gl::GLuint m_fragmentShader;
+
+    gl::GLuint m_program;
+
+    void updateDrawArguments();
+};
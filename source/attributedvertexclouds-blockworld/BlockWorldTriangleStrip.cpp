@@ -2,6 +2,8 @@
 #include "BlockWorldTriangleStrip.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <numeric>
 
 #include <glbinding/gl/gl.h>
 
@@ -9,9 +11,33 @@
 
 using namespace gl;
 
-BlockWorldTriangleStrip::BlockWorldTriangleStrip()
-: BlockWorldImplementation("Triangle Strip")
+
+namespace
+{
+
+
+// First vertex of each strip, relative to the first strip
+std::vector<GLint> stripStarts(const std::vector<GLint> & counts)
+{
+    auto starts = std::vector<GLint>(counts.size(), 0);
+
+    for (auto i = size_t(1); i < counts.size(); ++i)
+    {
+        starts[i] = starts[i - 1] + counts[i - 1];
+    }
+
+    return starts;
+}
+
+
+} // namespace
+
+
+BlockWorldTriangleStrip::BlockWorldTriangleStrip(StripDrawMode mode)
+: BlockWorldImplementation(StripDrawing::name("Triangle Strip", mode))
+, m_stripDrawing(mode)
 , m_vertices(0)
+, m_indices(0)
 , m_vao(0)
 , m_vertexShader(0)
 , m_fragmentShader(0)
@@ -20,7 +46,13 @@ BlockWorldTriangleStrip::BlockWorldTriangleStrip()
 
 BlockWorldTriangleStrip::~BlockWorldTriangleStrip()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
+    glDeleteBuffers(1, &m_indices);
     glDeleteVertexArrays(1, &m_vao);
     glDeleteShader(m_vertexShader);
     glDeleteShader(m_fragmentShader);
@@ -30,6 +62,12 @@ BlockWorldTriangleStrip::~BlockWorldTriangleStrip()
 void BlockWorldTriangleStrip::onInitialize()
 {
     glGenBuffers(1, &m_vertices);
+
+    if (m_stripDrawing.mode() == StripDrawMode::PrimitiveRestart)
+    {
+        glGenBuffers(1, &m_indices);
+    }
+
     glGenVertexArrays(1, &m_vao);
 
     initializeVAO();
@@ -50,25 +88,97 @@ void BlockWorldTriangleStrip::initializeVAO()
     glBindVertexArray(m_vao);
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
-    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, m_vertex.size() * sizeof(BlockVertex), m_vertex.data(), GL_STATIC_DRAW);
 
-    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 0, verticesCount() * sizeof(float) * 3, m_vertex.data());
-    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 3, verticesCount() * sizeof(float) * 3, m_normal.data());
-    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 6, verticesCount() * sizeof(float) * 3, m_localCoords.data());
-    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 9, verticesCount() * sizeof(float) * 1, m_type.data());
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 0));
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 3));
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 6));
-    glVertexAttribIPointer(3, 1, GL_INT, sizeof(int), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 9));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BlockVertex), reinterpret_cast<void*>(offsetof(BlockVertex, position)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BlockVertex), reinterpret_cast<void*>(offsetof(BlockVertex, normal)));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(BlockVertex), reinterpret_cast<void*>(offsetof(BlockVertex, localCoord)));
+    glVertexAttribIPointer(3, 1, GL_INT, sizeof(BlockVertex), reinterpret_cast<void*>(offsetof(BlockVertex, type)));
 
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
     glEnableVertexAttribArray(2);
     glEnableVertexAttribArray(3);
 
+    // The element array binding is part of the VAO state
+    if (m_indices != 0)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indices);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_restartIndices.size() * sizeof(GLuint), m_restartIndices.data(), GL_STATIC_DRAW);
+    }
+
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void BlockWorldTriangleStrip::updateDrawRanges()
+{
+    if (m_stripDrawing.mode() == StripDrawMode::MultiDraw)
+    {
+        m_multiStarts.clear();
+        m_multiCounts.clear();
+
+        for (auto chunk = size_t(0); chunk < m_chunkStrips.size(); ++chunk)
+        {
+            auto start = m_chunks.starts()[chunk];
+
+            for (const auto count : m_chunkStrips[chunk])
+            {
+                m_multiStarts.push_back(start);
+                m_multiCounts.push_back(count);
+
+                start += count;
+            }
+        }
+    }
+
+    if (m_stripDrawing.mode() == StripDrawMode::PrimitiveRestart)
+    {
+        m_indexOffsets.resize(m_indexChunks.chunkCount());
+
+        for (auto chunk = size_t(0); chunk < m_indexChunks.chunkCount(); ++chunk)
+        {
+            m_indexOffsets[chunk] = reinterpret_cast<const void *>(m_indexChunks.starts()[chunk] * sizeof(GLuint));
+        }
+    }
+}
+
+std::vector<BlockVertex> BlockWorldTriangleStrip::chunkStrips(const BlockVertex * vertices, const unsigned char * vertexCounts, size_t blockCount, std::vector<GLint> & stripCounts) const
+{
+    // A block with all faces visible is a single strip of 14 vertices, any other one a strip of 4 vertices per visible face
+    stripCounts.clear();
+
+    for (auto i = size_t(0); i < blockCount; ++i)
+    {
+        const auto stripSize = vertexCounts[i] == 14 ? 14 : 4;
+
+        for (auto start = 0; start < vertexCounts[i]; start += stripSize)
+        {
+            stripCounts.push_back(stripSize);
+        }
+    }
+
+    auto strips = std::vector<BlockVertex>(vertices, vertices + std::accumulate(stripCounts.begin(), stripCounts.end(), 0));
+
+    const auto order = m_stripDrawing.vertexOrder(stripStarts(stripCounts), stripCounts);
+
+    if (!order.empty())
+    {
+        gatherVertices(strips, order);
+    }
+
+    return strips;
+}
+
+std::vector<GLuint> BlockWorldTriangleStrip::chunkIndices(const std::vector<GLint> & stripCounts) const
+{
+    if (m_stripDrawing.mode() != StripDrawMode::PrimitiveRestart)
+    {
+        return std::vector<GLuint>();
+    }
+
+    return StripDrawing::restartIndices(stripStarts(stripCounts), stripCounts);
 }
 
 bool BlockWorldTriangleStrip::loadShader()
@@ -111,7 +221,7 @@ bool BlockWorldTriangleStrip::loadShader()
     return true;
 }
 
-void BlockWorldTriangleStrip::setBlock(size_t index, const Block & block)
+size_t BlockWorldTriangleStrip::emitBlock(const Block & block, BlockVertex * vertices) const
 {
     static const auto NEGATIVE_X = glm::vec3(-1.0, 0.0, 0.0);
     static const auto NEGATIVE_Y = glm::vec3(0.0, -1.0, 0.0);
@@ -123,7 +233,7 @@ void BlockWorldTriangleStrip::setBlock(size_t index, const Block & block)
     const auto llf = (glm::vec3(block.position) - glm::vec3(0.5f)) * m_blockSize;
     const auto urb = (glm::vec3(block.position) + glm::vec3(0.5f)) * m_blockSize;
 
-    const auto vertices = std::array<glm::vec3, 8>{{
+    const auto corners = std::array<glm::vec3, 8>{{
         glm::vec3(llf.x, urb.y, llf.z), // A = H
         glm::vec3(llf.x, urb.y, urb.z), // B = F
         glm::vec3(urb.x, urb.y, llf.z), // C = J
@@ -135,51 +245,193 @@ void BlockWorldTriangleStrip::setBlock(size_t index, const Block & block)
     }};
 
     size_t i = 0;
-    const auto emitVertex = [this, index, &block, &i](const glm::vec3 & vertex, const glm::vec3 & normal, const glm::vec3 & localCoord)
+    const auto emitVertex = [vertices, &block, &i](const glm::vec3 & vertex, const glm::vec3 & normal, const glm::vec3 & localCoord)
     {
-        m_vertex[index * verticesPerCuboid() + i] = vertex;
-        m_normal[index * verticesPerCuboid() + i] = normal;
-        m_localCoords[index * verticesPerCuboid() + i] = localCoord;
-        m_type[index * verticesPerCuboid() + i] = block.type;
+        vertices[i].position = vertex;
+        vertices[i].normal = normal;
+        vertices[i].localCoord = localCoord;
+        vertices[i].type = block.type;
 
         ++i;
     };
 
-    emitVertex(vertices[0], POSITIVE_Y, glm::vec3(-1.0, 1.0, -1.0)); // A
-    emitVertex(vertices[1], POSITIVE_Y, glm::vec3(-1.0, 1.0, 1.0)); // B
-    emitVertex(vertices[2], POSITIVE_Y, glm::vec3(1.0, 1.0, -1.0)); // C
-    emitVertex(vertices[3], POSITIVE_Y, glm::vec3(1.0, 1.0, 1.0)); // D
+    // Partially hidden blocks get one strip per visible face
+    if (block.visibleFaces != Block::AllFaces)
+    {
+        for (auto face = size_t(0); face < Block::faceCount; ++face)
+        {
+            if ((block.visibleFaces & (1 << face)) == 0)
+            {
+                continue;
+            }
+
+            for (auto corner = size_t(0); corner < 4; ++corner)
+            {
+                const auto localCoord = Block::faceCorner(face, corner);
+
+                emitVertex((glm::vec3(block.position) + localCoord * 0.5f) * m_blockSize, Block::faceNormal(face), localCoord);
+            }
+        }
+
+        return i;
+    }
+
+    emitVertex(corners[0], POSITIVE_Y, glm::vec3(-1.0, 1.0, -1.0)); // A
+    emitVertex(corners[1], POSITIVE_Y, glm::vec3(-1.0, 1.0, 1.0)); // B
+    emitVertex(corners[2], POSITIVE_Y, glm::vec3(1.0, 1.0, -1.0)); // C
+    emitVertex(corners[3], POSITIVE_Y, glm::vec3(1.0, 1.0, 1.0)); // D
+
+    emitVertex(corners[4], POSITIVE_X, glm::vec3(1.0, -1.0, 1.0)); // E
+
+    emitVertex(corners[1], POSITIVE_Z, glm::vec3(-1.0, 1.0, 1.0)); // F
+    emitVertex(corners[5], POSITIVE_Z, glm::vec3(-1.0, -1.0, 1.0)); // G
+
+    emitVertex(corners[0], NEGATIVE_X, glm::vec3(-1.0, 1.0, -1.0)); // H
+    emitVertex(corners[6], NEGATIVE_X, glm::vec3(-1.0, -1.0, -1.0)); // I
+
+    emitVertex(corners[2], NEGATIVE_Z, glm::vec3(1.0, 1.0, -1.0)); // J
+    emitVertex(corners[7], NEGATIVE_Z, glm::vec3(1.0, -1.0, -1.0)); // K
+
+    emitVertex(corners[4], POSITIVE_X, glm::vec3(1.0, -1.0, 1.0)); // L
+
+    emitVertex(corners[6], NEGATIVE_Y, glm::vec3(-1.0, -1.0, -1.0)); // I
+    emitVertex(corners[5], NEGATIVE_Y, glm::vec3(-1.0, -1.0, 1.0)); // G
+
+    return i;
+}
+
+void BlockWorldTriangleStrip::setBlock(size_t index, const Block & block)
+{
+    // The vertices of the visible faces are moved together once the chunks are laid out
+    m_vertexCounts[index] = static_cast<unsigned char>(emitBlock(block, &m_vertex[verticesPerCuboid() * index]));
+}
+
+void BlockWorldTriangleStrip::setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & /*origins*/)
+{
+    const auto chunkCount = offsets.size() - 1;
+    const auto blockOffsets = vertexOffsets(m_vertexCounts);
+
+    compactVertices(m_vertex, verticesPerCuboid(), blockOffsets);
+
+    auto strips = std::vector<std::vector<BlockVertex>>(chunkCount);
+    auto indices = std::vector<std::vector<GLuint>>(chunkCount);
+
+    m_chunkStrips.resize(chunkCount);
+    m_chunkSizes.resize(chunkCount);
+
+#pragma omp parallel for schedule(dynamic)
+    for (long i = 0; i < static_cast<long>(chunkCount); ++i)
+    {
+        strips[i] = chunkStrips(m_vertex.data() + blockOffsets[offsets[i]], m_vertexCounts.data() + offsets[i], offsets[i + 1] - offsets[i], m_chunkStrips[i]);
+        indices[i] = chunkIndices(m_chunkStrips[i]);
 
-    emitVertex(vertices[4], POSITIVE_X, glm::vec3(1.0, -1.0, 1.0)); // E
+        m_chunkSizes[i] = offsets[i + 1] - offsets[i];
+    }
 
-    emitVertex(vertices[1], POSITIVE_Z, glm::vec3(-1.0, 1.0, 1.0)); // F
-    emitVertex(vertices[5], POSITIVE_Z, glm::vec3(-1.0, -1.0, 1.0)); // G
+    // Chunk after chunk again, then spread over the ranges
+    auto chunkVertexOffsets = std::vector<size_t>(1, 0);
+    auto chunkIndexOffsets = std::vector<size_t>(1, 0);
 
-    emitVertex(vertices[0], NEGATIVE_X, glm::vec3(-1.0, 1.0, -1.0)); // H
-    emitVertex(vertices[6], NEGATIVE_X, glm::vec3(-1.0, -1.0, -1.0)); // I
+    for (auto i = size_t(0); i < chunkCount; ++i)
+    {
+        chunkVertexOffsets.push_back(chunkVertexOffsets.back() + strips[i].size());
+        chunkIndexOffsets.push_back(chunkIndexOffsets.back() + indices[i].size());
+    }
 
-    emitVertex(vertices[2], NEGATIVE_Z, glm::vec3(1.0, 1.0, -1.0)); // J
-    emitVertex(vertices[7], NEGATIVE_Z, glm::vec3(1.0, -1.0, -1.0)); // K
+    m_vertex.resize(chunkVertexOffsets.back());
+    m_restartIndices.resize(chunkIndexOffsets.back());
 
-    emitVertex(vertices[4], POSITIVE_X, glm::vec3(1.0, -1.0, 1.0)); // L
+    for (auto i = size_t(0); i < chunkCount; ++i)
+    {
+        std::copy(strips[i].begin(), strips[i].end(), m_vertex.begin() + chunkVertexOffsets[i]);
+        std::copy(indices[i].begin(), indices[i].end(), m_restartIndices.begin() + chunkIndexOffsets[i]);
+    }
+
+    m_chunks.layout(m_vertex, chunkVertexOffsets);
 
-    emitVertex(vertices[6], NEGATIVE_Y, glm::vec3(-1.0, -1.0, -1.0)); // I
-    emitVertex(vertices[5], NEGATIVE_Y, glm::vec3(-1.0, -1.0, 1.0)); // G
+    if (m_stripDrawing.mode() == StripDrawMode::PrimitiveRestart)
+    {
+        m_indexChunks.layout(m_restartIndices, chunkIndexOffsets);
+    }
+
+    std::vector<unsigned char>().swap(m_vertexCounts);
+
+    updateDrawRanges();
+}
+
+bool BlockWorldTriangleStrip::updateChunk(size_t chunk, const glm::ivec3 & /*origin*/, const std::vector<Block> & blocks)
+{
+    auto vertices = std::vector<BlockVertex>(blocks.size() * verticesPerCuboid());
+    auto vertexCounts = std::vector<unsigned char>(blocks.size());
+
+    for (auto i = size_t(0); i < blocks.size(); ++i)
+    {
+        vertexCounts[i] = static_cast<unsigned char>(emitBlock(blocks[i], &vertices[verticesPerCuboid() * i]));
+    }
+
+    compactVertices(vertices, verticesPerCuboid(), vertexOffsets(vertexCounts));
+
+    m_chunkStrips.resize(std::max(m_chunkStrips.size(), chunk + 1));
+    m_chunkSizes.resize(std::max(m_chunkSizes.size(), chunk + 1), 0);
+
+    const auto strips = chunkStrips(vertices.data(), vertexCounts.data(), blocks.size(), m_chunkStrips[chunk]);
+    const auto indices = chunkIndices(m_chunkStrips[chunk]);
+
+    m_chunkSizes[chunk] = blocks.size();
+
+    const auto inPlace = m_chunks.replace(m_vertex, chunk, strips);
+    const auto indicesInPlace = m_stripDrawing.mode() != StripDrawMode::PrimitiveRestart || m_indexChunks.replace(m_restartIndices, chunk, indices);
+
+    updateDrawRanges();
+
+    if (!initialized())
+    {
+        return true;
+    }
+
+    if (!inPlace || !indicesInPlace)
+    {
+        initializeVAO();
+
+        return true;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferSubData(GL_ARRAY_BUFFER, m_chunks.starts()[chunk] * sizeof(BlockVertex), strips.size() * sizeof(BlockVertex), strips.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (m_indices != 0)
+    {
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indices);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, m_indexChunks.starts()[chunk] * sizeof(GLuint), indices.size() * sizeof(GLuint), indices.data());
+        glBindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    return true;
+}
+
+void BlockWorldTriangleStrip::updateBuffers()
+{
+    initializeVAO();
 }
 
 size_t BlockWorldTriangleStrip::size() const
 {
-    return m_vertex.size() / verticesPerCuboid();
+    return std::accumulate(m_chunkSizes.begin(), m_chunkSizes.end(), size_t(0));
 }
 
 size_t BlockWorldTriangleStrip::verticesPerCuboid() const
 {
-    return 14;
+    // Five separate faces take more than the closed strip
+    return 20;
 }
 
 size_t BlockWorldTriangleStrip::verticesCount() const
 {
-    return size() * verticesPerCuboid();
+    // Including the degenerate vertices of stitched strips
+    return m_chunks.blockCount();
 }
 
 size_t BlockWorldTriangleStrip::staticByteSize() const
@@ -189,7 +441,8 @@ size_t BlockWorldTriangleStrip::staticByteSize() const
 
 size_t BlockWorldTriangleStrip::byteSize() const
 {
-    return verticesCount() * vertexByteSize();
+    // Including the free room of the chunk ranges
+    return m_vertex.size() * vertexByteSize() + m_restartIndices.size() * sizeof(GLuint);
 }
 
 size_t BlockWorldTriangleStrip::vertexByteSize() const
@@ -205,20 +458,36 @@ size_t BlockWorldTriangleStrip::componentCount() const
 void BlockWorldTriangleStrip::resize(size_t count)
 {
     m_vertex.resize(count * verticesPerCuboid());
-    m_normal.resize(count * verticesPerCuboid());
-    m_localCoords.resize(count * verticesPerCuboid());
-    m_type.resize(count * verticesPerCuboid());
+    m_vertexCounts.resize(count);
+}
 
-    m_multiStarts.resize(count);
-    m_multiCounts.resize(count);
+size_t BlockWorldTriangleStrip::cpuByteSize() const
+{
+    auto stripByteSize = size_t(0);
 
-    size_t next = 0;
-    std::fill(m_multiCounts.begin(), m_multiCounts.end(), verticesPerCuboid());
-    std::generate(m_multiStarts.begin(), m_multiStarts.end(), [this, &next]() {
-        const auto current = next;
-        next += verticesPerCuboid();
-        return current;
-    });
+    for (const auto & strips : m_chunkStrips)
+    {
+        stripByteSize += containerByteSize(strips);
+    }
+
+    return containerByteSize(m_vertex)
+        + containerByteSize(m_vertexCounts)
+        + containerByteSize(m_chunkSizes)
+        + stripByteSize
+        + containerByteSize(m_multiStarts)
+        + containerByteSize(m_multiCounts)
+        + containerByteSize(m_restartIndices)
+        + containerByteSize(m_indexOffsets);
+}
+
+std::vector<gl::GLuint> BlockWorldTriangleStrip::buffers() const
+{
+    if (m_indices != 0)
+    {
+        return { m_vertices, m_indices };
+    }
+
+    return { m_vertices };
 }
 
 void BlockWorldTriangleStrip::onRender()
@@ -235,7 +504,27 @@ void BlockWorldTriangleStrip::onRender()
     glDepthMask(GL_TRUE);
 
     glUseProgram(m_program);
-    glMultiDrawArrays(GL_TRIANGLE_STRIP, m_multiStarts.data(), m_multiCounts.data(), size());
+
+    switch (m_stripDrawing.mode())
+    {
+    case StripDrawMode::PrimitiveRestart:
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(StripDrawing::restartIndex);
+
+        glMultiDrawElementsBaseVertex(GL_TRIANGLE_STRIP, m_indexChunks.counts().data(), GL_UNSIGNED_INT, m_indexOffsets.data(),
+            static_cast<GLsizei>(m_indexChunks.chunkCount()), m_chunks.starts().data());
+
+        glDisable(GL_PRIMITIVE_RESTART);
+        break;
+
+    case StripDrawMode::Degenerate:
+        glMultiDrawArrays(GL_TRIANGLE_STRIP, m_chunks.starts().data(), m_chunks.counts().data(), static_cast<GLsizei>(m_chunks.chunkCount()));
+        break;
+
+    default:
+        glMultiDrawArrays(GL_TRIANGLE_STRIP, m_multiStarts.data(), m_multiCounts.data(), static_cast<GLsizei>(m_multiStarts.size()));
+        break;
+    }
 
     glDepthMask(GL_TRUE);
 
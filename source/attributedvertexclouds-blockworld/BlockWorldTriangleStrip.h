@@ -9,12 +9,16 @@
 
 #include "Block.h"
 #include "BlockWorldImplementation.h"
+#include "ChunkRanges.h"
+#include "StripDrawing.h"
 
 
+// The strips of each chunk keep a range of the vertex buffer, so an edit rewrites only its chunk. Stitched strips
+// are stitched within a chunk and restart indices are relative to it, so each mode issues one multi-draw over the chunks.
 class BlockWorldTriangleStrip : public BlockWorldImplementation
 {
 public:
-    BlockWorldTriangleStrip();
+    BlockWorldTriangleStrip(StripDrawMode mode);
     ~BlockWorldTriangleStrip();
 
     virtual void onInitialize() override;
@@ -23,6 +27,9 @@ public:
     virtual bool loadShader() override;
 
     virtual void setBlock(size_t index, const Block & block) override;
+    virtual void setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & origins) override;
+    virtual bool updateChunk(size_t chunk, const glm::ivec3 & origin, const std::vector<Block> & blocks) override;
+    virtual void updateBuffers() override;
 
     virtual size_t size() const override;
     virtual size_t verticesCount() const override;
@@ -30,20 +37,37 @@ public:
     virtual size_t byteSize() const override;
     virtual size_t vertexByteSize() const override;
     virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
 
     virtual void resize(size_t count) override;
 
+    virtual std::vector<gl::GLuint> buffers() const override;
+
     virtual gl::GLuint program() const override;
 public:
-    std::vector<glm::vec3> m_vertex;
-    std::vector<glm::vec3> m_normal;
-    std::vector<glm::vec3> m_localCoords;
-    std::vector<int> m_type;
+    std::vector<BlockVertex> m_vertex;
+
+    // Vertices of the visible faces of each block, until the chunks are laid out
+    std::vector<unsigned char> m_vertexCounts;
 
+    // Vertex range, block count and strip sizes of each chunk
+    ChunkRanges m_chunks;
+    std::vector<size_t> m_chunkSizes;
+    std::vector<std::vector<gl::GLint>> m_chunkStrips;
+
+    // Multi-draw arguments of all strips, rebuilt from the chunks after each change
     std::vector<gl::GLint> m_multiStarts;
     std::vector<gl::GLint> m_multiCounts;
 
+    // Restart indices relative to their chunk, laid out in ranges of their own, and the byte offset of each range
+    std::vector<gl::GLuint> m_restartIndices;
+    ChunkRanges m_indexChunks;
+    std::vector<const void *> m_indexOffsets;
+
+    StripDrawing m_stripDrawing;
+
     gl::GLuint m_vertices;
+    gl::GLuint m_indices;
     gl::GLuint m_vao;
 
     gl::GLuint m_vertexShader;
@@ -52,5 +76,13 @@ public:
     gl::GLuint m_program;
 
     void initializeVAO();
+    void updateDrawRanges();
     size_t verticesPerCuboid() const;
+
+    // Writes the strips of the visible faces; returns the vertex count
+    size_t emitBlock(const Block & block, BlockVertex * vertices) const;
+
+    // Vertices of a chunk as drawn, from the compacted vertices of its blocks; stripCounts gets the strip sizes
+    std::vector<BlockVertex> chunkStrips(const BlockVertex * vertices, const unsigned char * vertexCounts, size_t blockCount, std::vector<gl::GLint> & stripCounts) const;
+    std::vector<gl::GLuint> chunkIndices(const std::vector<gl::GLint> & stripCounts) const;
 };
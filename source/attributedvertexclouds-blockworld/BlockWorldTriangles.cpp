@@ -2,6 +2,8 @@
 #include "BlockWorldTriangles.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <numeric>
 
 #include <glbinding/gl/gl.h>
 
@@ -20,6 +22,11 @@ BlockWorldTriangles::BlockWorldTriangles()
 
 BlockWorldTriangles::~BlockWorldTriangles()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteVertexArrays(1, &m_vao);
     glDeleteShader(m_vertexShader);
@@ -50,17 +57,12 @@ void BlockWorldTriangles::initializeVAO()
     glBindVertexArray(m_vao);
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
-    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_STATIC_DRAW);
-
-    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 0, verticesCount() * sizeof(float) * 3, m_vertex.data());
-    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 3, verticesCount() * sizeof(float) * 3, m_normal.data());
-    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 6, verticesCount() * sizeof(float) * 3, m_localCoords.data());
-    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 9, verticesCount() * sizeof(float) * 1, m_type.data());
+    glBufferData(GL_ARRAY_BUFFER, byteSize(), m_vertex.data(), GL_STATIC_DRAW);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 0));
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 3));
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 6));
-    glVertexAttribIPointer(3, 1, GL_INT, sizeof(float), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 9));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BlockVertex), reinterpret_cast<void*>(offsetof(BlockVertex, position)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BlockVertex), reinterpret_cast<void*>(offsetof(BlockVertex, normal)));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(BlockVertex), reinterpret_cast<void*>(offsetof(BlockVertex, localCoord)));
+    glVertexAttribIPointer(3, 1, GL_INT, sizeof(BlockVertex), reinterpret_cast<void*>(offsetof(BlockVertex, type)));
 
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
@@ -111,7 +113,7 @@ bool BlockWorldTriangles::loadShader()
     return true;
 }
 
-void BlockWorldTriangles::setBlock(size_t index, const Block & block)
+size_t BlockWorldTriangles::emitBlock(const Block & block, BlockVertex * vertices) const
 {
     static const glm::vec3 NEGATIVE_X = glm::vec3(-1.0, 0.0, 0.0);
     static const glm::vec3 NEGATIVE_Y = glm::vec3(0.0, -1.0, 0.0);
@@ -120,7 +122,7 @@ void BlockWorldTriangles::setBlock(size_t index, const Block & block)
     static const glm::vec3 POSITIVE_Y = glm::vec3(0.0, 1.0, 0.0);
     static const glm::vec3 POSITIVE_Z = glm::vec3(0.0, 0.0, 1.0);
 
-    static const glm::vec3 vertices[8] = {
+    static const glm::vec3 corners[8] = {
         glm::vec3(-0.5f, 0.5f, -0.5f), // A = H
         glm::vec3(-0.5f, 0.5f, 0.5f), // B = F
         glm::vec3(0.5f, 0.5f, -0.5f), // C = J
@@ -131,101 +133,115 @@ void BlockWorldTriangles::setBlock(size_t index, const Block & block)
         glm::vec3(0.5f, -0.5f, -0.5f), // K
     };
 
-    m_normal[verticesPerCuboid() * index + 0] = NEGATIVE_X;
-    m_normal[verticesPerCuboid() * index + 1] = NEGATIVE_X;
-    m_normal[verticesPerCuboid() * index + 2] = NEGATIVE_X;
-    m_normal[verticesPerCuboid() * index + 3] = NEGATIVE_X;
-    m_normal[verticesPerCuboid() * index + 4] = NEGATIVE_X;
-    m_normal[verticesPerCuboid() * index + 5] = NEGATIVE_X;
-
-    m_normal[verticesPerCuboid() * index + 6] = NEGATIVE_Z;
-    m_normal[verticesPerCuboid() * index + 7] = NEGATIVE_Z;
-    m_normal[verticesPerCuboid() * index + 8] = NEGATIVE_Z;
-    m_normal[verticesPerCuboid() * index + 9] = NEGATIVE_Z;
-    m_normal[verticesPerCuboid() * index + 10] = NEGATIVE_Z;
-    m_normal[verticesPerCuboid() * index + 11] = NEGATIVE_Z;
-
-    m_normal[verticesPerCuboid() * index + 12] = POSITIVE_X;
-    m_normal[verticesPerCuboid() * index + 13] = POSITIVE_X;
-    m_normal[verticesPerCuboid() * index + 14] = POSITIVE_X;
-    m_normal[verticesPerCuboid() * index + 15] = POSITIVE_X;
-    m_normal[verticesPerCuboid() * index + 16] = POSITIVE_X;
-    m_normal[verticesPerCuboid() * index + 17] = POSITIVE_X;
-
-    m_normal[verticesPerCuboid() * index + 18] = POSITIVE_Z;
-    m_normal[verticesPerCuboid() * index + 19] = POSITIVE_Z;
-    m_normal[verticesPerCuboid() * index + 20] = POSITIVE_Z;
-    m_normal[verticesPerCuboid() * index + 21] = POSITIVE_Z;
-    m_normal[verticesPerCuboid() * index + 22] = POSITIVE_Z;
-    m_normal[verticesPerCuboid() * index + 23] = POSITIVE_Z;
-
-    m_normal[verticesPerCuboid() * index + 24] = POSITIVE_Y;
-    m_normal[verticesPerCuboid() * index + 25] = POSITIVE_Y;
-    m_normal[verticesPerCuboid() * index + 26] = POSITIVE_Y;
-    m_normal[verticesPerCuboid() * index + 27] = POSITIVE_Y;
-    m_normal[verticesPerCuboid() * index + 28] = POSITIVE_Y;
-    m_normal[verticesPerCuboid() * index + 29] = POSITIVE_Y;
-
-    m_normal[verticesPerCuboid() * index + 30] = NEGATIVE_Y;
-    m_normal[verticesPerCuboid() * index + 31] = NEGATIVE_Y;
-    m_normal[verticesPerCuboid() * index + 32] = NEGATIVE_Y;
-    m_normal[verticesPerCuboid() * index + 33] = NEGATIVE_Y;
-    m_normal[verticesPerCuboid() * index + 34] = NEGATIVE_Y;
-    m_normal[verticesPerCuboid() * index + 35] = NEGATIVE_Y;
-
-    m_vertex[verticesPerCuboid() * index + 0] = vertices[1];
-    m_vertex[verticesPerCuboid() * index + 1] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 2] = vertices[5];
-    m_vertex[verticesPerCuboid() * index + 3] = vertices[5];
-    m_vertex[verticesPerCuboid() * index + 4] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 5] = vertices[6];
-
-    m_vertex[verticesPerCuboid() * index + 6] = vertices[6];
-    m_vertex[verticesPerCuboid() * index + 7] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 8] = vertices[7];
-    m_vertex[verticesPerCuboid() * index + 9] = vertices[7];
-    m_vertex[verticesPerCuboid() * index + 10] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 11] = vertices[2];
-
-    m_vertex[verticesPerCuboid() * index + 12] = vertices[2];
-    m_vertex[verticesPerCuboid() * index + 13] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 14] = vertices[7];
-    m_vertex[verticesPerCuboid() * index + 15] = vertices[7];
-    m_vertex[verticesPerCuboid() * index + 16] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 17] = vertices[4];
-
-    m_vertex[verticesPerCuboid() * index + 18] = vertices[4];
-    m_vertex[verticesPerCuboid() * index + 19] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 20] = vertices[5];
-    m_vertex[verticesPerCuboid() * index + 21] = vertices[5];
-    m_vertex[verticesPerCuboid() * index + 22] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 23] = vertices[1];
-
-    m_vertex[verticesPerCuboid() * index + 24] = vertices[1];
-    m_vertex[verticesPerCuboid() * index + 25] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 26] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 27] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 28] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 29] = vertices[2];
-
-    m_vertex[verticesPerCuboid() * index + 30] = vertices[4];
-    m_vertex[verticesPerCuboid() * index + 31] = vertices[5];
-    m_vertex[verticesPerCuboid() * index + 32] = vertices[6];
-    m_vertex[verticesPerCuboid() * index + 33] = vertices[6];
-    m_vertex[verticesPerCuboid() * index + 34] = vertices[7];
-    m_vertex[verticesPerCuboid() * index + 35] = vertices[4];
-
-    for (auto i = 0ull; i < verticesPerCuboid(); ++i)
+    static const int faces[6] = { Block::NegativeX, Block::NegativeZ, Block::PositiveX, Block::PositiveZ, Block::PositiveY, Block::NegativeY };
+    static const glm::vec3 normals[6] = { NEGATIVE_X, NEGATIVE_Z, POSITIVE_X, POSITIVE_Z, POSITIVE_Y, NEGATIVE_Y };
+    static const size_t triangles[6][6] = {
+        { 1, 0, 5, 5, 0, 6 },
+        { 6, 0, 7, 7, 0, 2 },
+        { 2, 3, 7, 7, 3, 4 },
+        { 4, 3, 5, 5, 3, 1 },
+        { 1, 3, 0, 0, 3, 2 },
+        { 4, 5, 6, 6, 7, 4 }
+    };
+
+    // Hidden faces are skipped
+    auto i = size_t(0);
+
+    for (auto face = 0; face < 6; ++face)
+    {
+        if ((block.visibleFaces & faces[face]) == 0)
+        {
+            continue;
+        }
+
+        for (const auto vertex : triangles[face])
+        {
+            vertices[i].position = (glm::vec3(block.position) + corners[vertex]) * m_blockSize;
+            vertices[i].normal = normals[face];
+            vertices[i].localCoord = corners[vertex] * 2.0f;
+            vertices[i].type = block.type;
+
+            ++i;
+        }
+    }
+
+    return i;
+}
+
+void BlockWorldTriangles::setBlock(size_t index, const Block & block)
+{
+    // The vertices of the visible faces are moved together once the chunks are laid out
+    m_vertexCounts[index] = static_cast<unsigned char>(emitBlock(block, &m_vertex[verticesPerCuboid() * index]));
+}
+
+void BlockWorldTriangles::setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & /*origins*/)
+{
+    const auto blockOffsets = vertexOffsets(m_vertexCounts);
+
+    compactVertices(m_vertex, verticesPerCuboid(), blockOffsets);
+
+    auto chunkOffsets = std::vector<size_t>(offsets.size());
+    m_chunkSizes.resize(offsets.size() - 1);
+
+    for (auto i = size_t(0); i < offsets.size(); ++i)
     {
-        m_localCoords[verticesPerCuboid() * index + i] = m_vertex[verticesPerCuboid() * index + i] * 2.0f;
-        m_vertex[verticesPerCuboid() * index + i] = (glm::vec3(block.position) + m_vertex[verticesPerCuboid() * index + i]) * m_blockSize;
-        m_type[verticesPerCuboid() * index + i] = block.type;
+        chunkOffsets[i] = blockOffsets[offsets[i]];
+
+        if (i + 1 < offsets.size())
+        {
+            m_chunkSizes[i] = offsets[i + 1] - offsets[i];
+        }
     }
+
+    m_chunks.layout(m_vertex, chunkOffsets);
+
+    std::vector<unsigned char>().swap(m_vertexCounts);
+}
+
+bool BlockWorldTriangles::updateChunk(size_t chunk, const glm::ivec3 & /*origin*/, const std::vector<Block> & blocks)
+{
+    auto vertices = std::vector<BlockVertex>(blocks.size() * verticesPerCuboid());
+    auto count = size_t(0);
+
+    for (const auto & block : blocks)
+    {
+        count += emitBlock(block, vertices.data() + count);
+    }
+
+    vertices.resize(count);
+
+    const auto inPlace = m_chunks.replace(m_vertex, chunk, vertices);
+
+    m_chunkSizes.resize(std::max(m_chunkSizes.size(), chunk + 1), 0);
+    m_chunkSizes[chunk] = blocks.size();
+
+    if (!initialized())
+    {
+        return true;
+    }
+
+    if (!inPlace)
+    {
+        initializeVAO();
+
+        return true;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferSubData(GL_ARRAY_BUFFER, m_chunks.starts()[chunk] * sizeof(BlockVertex), vertices.size() * sizeof(BlockVertex), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+void BlockWorldTriangles::updateBuffers()
+{
+    initializeVAO();
 }
 
 size_t BlockWorldTriangles::size() const
 {
-    return m_vertex.size() / verticesPerCuboid();
+    return std::accumulate(m_chunkSizes.begin(), m_chunkSizes.end(), size_t(0));
 }
 
 size_t BlockWorldTriangles::verticesPerCuboid() const
@@ -235,7 +251,8 @@ size_t BlockWorldTriangles::verticesPerCuboid() const
 
 size_t BlockWorldTriangles::verticesCount() const
 {
-    return size() * verticesPerCuboid();
+    // Only the vertices of visible faces
+    return m_chunks.blockCount();
 }
 
 size_t BlockWorldTriangles::staticByteSize() const
@@ -245,7 +262,8 @@ size_t BlockWorldTriangles::staticByteSize() const
 
 size_t BlockWorldTriangles::byteSize() const
 {
-    return verticesCount() * vertexByteSize();
+    // Including the free room of the chunk ranges
+    return m_vertex.size() * vertexByteSize();
 }
 
 size_t BlockWorldTriangles::vertexByteSize() const
@@ -261,9 +279,19 @@ size_t BlockWorldTriangles::componentCount() const
 void BlockWorldTriangles::resize(size_t count)
 {
     m_vertex.resize(count * verticesPerCuboid());
-    m_normal.resize(count * verticesPerCuboid());
-    m_localCoords.resize(count * verticesPerCuboid());
-    m_type.resize(count * verticesPerCuboid());
+    m_vertexCounts.resize(count);
+}
+
+size_t BlockWorldTriangles::cpuByteSize() const
+{
+    return containerByteSize(m_vertex)
+        + containerByteSize(m_vertexCounts)
+        + containerByteSize(m_chunkSizes);
+}
+
+std::vector<gl::GLuint> BlockWorldTriangles::buffers() const
+{
+    return { m_vertices };
 }
 
 void BlockWorldTriangles::onRender()
@@ -280,7 +308,7 @@ void BlockWorldTriangles::onRender()
     glDepthMask(GL_TRUE);
 
     glUseProgram(m_program);
-    glDrawArrays(GL_TRIANGLES, 0, verticesCount());
+    glMultiDrawArrays(GL_TRIANGLES, m_chunks.starts().data(), m_chunks.counts().data(), static_cast<GLsizei>(m_chunks.chunkCount()));
 
     glDepthMask(GL_TRUE);
 
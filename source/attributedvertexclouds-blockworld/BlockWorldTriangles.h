@@ -9,6 +9,7 @@
 
 #include "Block.h"
 #include "BlockWorldImplementation.h"
+#include "ChunkRanges.h"
 
 
 class BlockWorldTriangles : public BlockWorldImplementation
@@ -23,6 +24,9 @@ public:
     virtual bool loadShader() override;
 
     virtual void setBlock(size_t index, const Block & block) override;
+    virtual void setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & origins) override;
+    virtual bool updateChunk(size_t chunk, const glm::ivec3 & origin, const std::vector<Block> & blocks) override;
+    virtual void updateBuffers() override;
 
     virtual size_t size() const override;
     virtual size_t verticesCount() const override;
@@ -30,15 +34,22 @@ public:
     virtual size_t byteSize() const override;
     virtual size_t vertexByteSize() const override;
     virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
 
     virtual void resize(size_t count) override;
 
+    virtual std::vector<gl::GLuint> buffers() const override;
+
     virtual gl::GLuint program() const override;
 public:
-    std::vector<glm::vec3> m_vertex;
-    std::vector<glm::vec3> m_normal;
-    std::vector<glm::vec3> m_localCoords;
-    std::vector<int> m_type;
+    std::vector<BlockVertex> m_vertex;
+
+    // Vertices of the visible faces of each block, until the chunks are laid out
+    std::vector<unsigned char> m_vertexCounts;
+
+    // Vertex range and block count of each chunk
+    ChunkRanges m_chunks;
+    std::vector<size_t> m_chunkSizes;
 
     gl::GLuint m_vertices;
     gl::GLuint m_vao;
@@ -50,4 +61,7 @@ public:
 
     void initializeVAO();
     size_t verticesPerCuboid() const;
+
+    // Writes the triangles of the visible faces; returns the vertex count
+    size_t emitBlock(const Block & block, BlockVertex * vertices) const;
 };
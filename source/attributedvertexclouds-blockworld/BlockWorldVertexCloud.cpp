@@ -7,8 +7,9 @@
 
 using namespace gl;
 
-BlockWorldVertexCloud::BlockWorldVertexCloud()
-: BlockWorldImplementation("Attributed Vertex Cloud")
+BlockWorldVertexCloud::BlockWorldVertexCloud(bool visibleFacesOnly)
+: BlockWorldImplementation(visibleFacesOnly ? "Attributed Vertex Cloud (Visible Faces)" : "Attributed Vertex Cloud")
+, m_visibleFacesOnly(visibleFacesOnly)
 , m_vertices(0)
 , m_vao(0)
 , m_vertexShader(0)
@@ -19,6 +20,11 @@ BlockWorldVertexCloud::BlockWorldVertexCloud()
 
 BlockWorldVertexCloud::~BlockWorldVertexCloud()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteVertexArrays(1, &m_vao);
     glDeleteShader(m_vertexShader);
@@ -52,9 +58,9 @@ void BlockWorldVertexCloud::initializeVAO()
     glBindVertexArray(m_vao);
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
-    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_DYNAMIC_DRAW);
 
-    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 0, verticesCount() * sizeof(float) * 4, m_positionAndType.data());
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_positionAndType.size() * sizeof(glm::ivec4), m_positionAndType.data());
 
     glVertexAttribIPointer(0, 4, GL_INT, sizeof(glm::ivec4), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 0));
 
@@ -76,7 +82,7 @@ bool BlockWorldVertexCloud::loadShader()
     bool success = checkForCompilationError(m_vertexShader, "vertex shader");
 
 
-    const auto geometryShaderSource = loadShaderSource("/blockworld-avc/standard.geom");
+    const auto geometryShaderSource = loadShaderSource(m_visibleFacesOnly ? "/blockworld-avc/visible.geom" : "/blockworld-avc/standard.geom");
     const auto geometryShaderSource_ptr = geometryShaderSource.c_str();
     if(geometryShaderSource_ptr)
         glShaderSource(m_geometryShader, 1, &geometryShaderSource_ptr, 0);
@@ -121,12 +127,52 @@ bool BlockWorldVertexCloud::loadShader()
 
 void BlockWorldVertexCloud::setBlock(size_t index, const Block & block)
 {
-    m_positionAndType[index] = glm::ivec4(block.position, block.type);
+    m_positionAndType[index] = glm::ivec4(block.position, block.packedType());
+}
+
+void BlockWorldVertexCloud::setChunks(const std::vector<size_t> & offsets, const std::vector<glm::ivec3> & /*origins*/)
+{
+    m_chunks.layout(m_positionAndType, offsets);
+}
+
+bool BlockWorldVertexCloud::updateChunk(size_t chunk, const glm::ivec3 & /*origin*/, const std::vector<Block> & blocks)
+{
+    auto positionAndType = std::vector<glm::ivec4>(blocks.size());
+
+    for (auto i = size_t(0); i < blocks.size(); ++i)
+    {
+        positionAndType[i] = glm::ivec4(blocks[i].position, blocks[i].packedType());
+    }
+
+    const auto inPlace = m_chunks.replace(m_positionAndType, chunk, positionAndType);
+
+    if (!initialized())
+    {
+        return true;
+    }
+
+    if (!inPlace)
+    {
+        initializeVAO();
+
+        return true;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferSubData(GL_ARRAY_BUFFER, m_chunks.starts()[chunk] * sizeof(glm::ivec4), positionAndType.size() * sizeof(glm::ivec4), positionAndType.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+void BlockWorldVertexCloud::updateBuffers()
+{
+    initializeVAO();
 }
 
 size_t BlockWorldVertexCloud::size() const
 {
-    return m_positionAndType.size();
+    return m_chunks.blockCount();
 }
 
 size_t BlockWorldVertexCloud::verticesPerCuboid() const
@@ -146,7 +192,7 @@ size_t BlockWorldVertexCloud::staticByteSize() const
 
 size_t BlockWorldVertexCloud::byteSize() const
 {
-    return verticesPerCuboid() * size() * vertexByteSize();
+    return m_positionAndType.size() * vertexByteSize();
 }
 
 size_t BlockWorldVertexCloud::vertexByteSize() const
@@ -164,6 +210,16 @@ void BlockWorldVertexCloud::resize(size_t count)
     m_positionAndType.resize(count);
 }
 
+size_t BlockWorldVertexCloud::cpuByteSize() const
+{
+    return containerByteSize(m_positionAndType);
+}
+
+std::vector<gl::GLuint> BlockWorldVertexCloud::buffers() const
+{
+    return { m_vertices };
+}
+
 void BlockWorldVertexCloud::onRender()
 {
     glBindVertexArray(m_vao);
@@ -171,14 +227,22 @@ void BlockWorldVertexCloud::onRender()
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
 
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    // The visible faces strip relies on the depth test instead of a consistent winding
+    if (m_visibleFacesOnly)
+    {
+        glDisable(GL_CULL_FACE);
+    }
+    else
+    {
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_BACK);
+    }
 
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glDepthMask(GL_TRUE);
 
     glUseProgram(m_program);
-    glDrawArrays(GL_POINTS, 0, size());
+    glMultiDrawArrays(GL_POINTS, m_chunks.starts().data(), m_chunks.counts().data(), static_cast<GLsizei>(m_chunks.chunkCount()));
 
     glUseProgram(0);
 
@@ -0,0 +1,54 @@
+
+#include "ChunkRanges.h"
+
+#include <numeric>
+
+
+const size_t ChunkRanges::granularity;
+
+ChunkRanges::ChunkRanges()
+{
+}
+
+size_t ChunkRanges::chunkCount() const
+{
+    return m_starts.size();
+}
+
+size_t ChunkRanges::blockCount() const
+{
+    return std::accumulate(m_counts.begin(), m_counts.end(), size_t(0));
+}
+
+const std::vector<gl::GLint> & ChunkRanges::starts() const
+{
+    return m_starts;
+}
+
+const std::vector<gl::GLint> & ChunkRanges::counts() const
+{
+    return m_counts;
+}
+
+const std::vector<size_t> & ChunkRanges::capacities() const
+{
+    return m_capacities;
+}
+
+std::vector<glm::ivec4> ChunkRanges::granuleOrigins(const std::vector<glm::ivec3> & origins) const
+{
+    auto result = std::vector<glm::ivec4>();
+
+    for (auto chunk = size_t(0); chunk < m_capacities.size(); ++chunk)
+    {
+        result.insert(result.end(), m_capacities[chunk] / granularity, glm::ivec4(origins[chunk], 0));
+    }
+
+    return result;
+}
+
+size_t ChunkRanges::capacity(size_t count)
+{
+    // A quarter more, and some room for chunks that are empty so far, rounded up to whole granules
+    return (count + count / 4 + granularity + granularity - 1) / granularity * granularity;
+}
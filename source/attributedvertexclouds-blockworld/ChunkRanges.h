@@ -0,0 +1,124 @@
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <glbinding/gl/types.h>
+
+
+// Ranges of a block array, one per chunk and back to back, each with room for more blocks than the chunk holds.
+// The triangle techniques lay out their vertices the same way, which count as blocks here.
+// A chunk can be replaced in place until it outgrows its range, which lays out all chunks anew.
+// The free room of each range holds default blocks.
+class ChunkRanges
+{
+public:
+    // Ranges consist of whole granules of this many blocks, so each granule belongs to a single chunk
+    static const size_t granularity = 64;
+
+    ChunkRanges();
+
+    // Spreads blocks given chunk after chunk over the ranges; offsets holds the first block of each chunk, followed by their total
+    template <typename T>
+    void layout(std::vector<T> & blocks, const std::vector<size_t> & offsets);
+
+    // Replaces the blocks of a chunk; returns false if they exceeded its range and all chunks moved.
+    // A chunk past the last one is appended, together with empty chunks in between.
+    template <typename T>
+    bool replace(std::vector<T> & blocks, size_t chunk, const std::vector<T> & chunkBlocks);
+
+    size_t chunkCount() const;
+    size_t blockCount() const;
+
+    // Multi-draw arguments: first block and block count of each chunk
+    const std::vector<gl::GLint> & starts() const;
+    const std::vector<gl::GLint> & counts() const;
+
+    // Blocks each range has room for
+    const std::vector<size_t> & capacities() const;
+
+    // Origin of the chunk of each granule, for shaders that look it up by block index; origins holds one per chunk
+    std::vector<glm::ivec4> granuleOrigins(const std::vector<glm::ivec3> & origins) const;
+
+protected:
+    std::vector<gl::GLint> m_starts;
+    std::vector<gl::GLint> m_counts;
+    std::vector<size_t> m_capacities;
+
+    static size_t capacity(size_t count);
+};
+
+
+template <typename T>
+void ChunkRanges::layout(std::vector<T> & blocks, const std::vector<size_t> & offsets)
+{
+    const auto chunkCount = offsets.size() - 1;
+
+    m_starts.resize(chunkCount);
+    m_counts.resize(chunkCount);
+    m_capacities.resize(chunkCount);
+
+    auto size = size_t(0);
+
+    for (auto i = size_t(0); i < chunkCount; ++i)
+    {
+        m_starts[i] = static_cast<gl::GLint>(size);
+        m_counts[i] = static_cast<gl::GLint>(offsets[i + 1] - offsets[i]);
+        m_capacities[i] = capacity(offsets[i + 1] - offsets[i]);
+
+        size += m_capacities[i];
+    }
+
+    auto spread = std::vector<T>(size);
+
+#pragma omp parallel for
+    for (long i = 0; i < static_cast<long>(chunkCount); ++i)
+    {
+        std::copy(blocks.begin() + offsets[i], blocks.begin() + offsets[i + 1], spread.begin() + m_starts[i]);
+    }
+
+    blocks.swap(spread);
+}
+
+template <typename T>
+bool ChunkRanges::replace(std::vector<T> & blocks, size_t chunk, const std::vector<T> & chunkBlocks)
+{
+    if (chunk < m_capacities.size() && chunkBlocks.size() <= m_capacities[chunk])
+    {
+        std::copy(chunkBlocks.begin(), chunkBlocks.end(), blocks.begin() + m_starts[chunk]);
+        std::fill(blocks.begin() + m_starts[chunk] + chunkBlocks.size(), blocks.begin() + m_starts[chunk] + m_capacities[chunk], T());
+        m_counts[chunk] = static_cast<gl::GLint>(chunkBlocks.size());
+
+        return true;
+    }
+
+    // Gather all chunks back to back with the new blocks in place and spread them again
+    auto gathered = std::vector<T>();
+    auto offsets = std::vector<size_t>(1, 0);
+
+    gathered.reserve(blockCount() + chunkBlocks.size());
+
+    for (auto i = size_t(0); i < std::max(m_starts.size(), chunk + 1); ++i)
+    {
+        if (i == chunk)
+        {
+            gathered.insert(gathered.end(), chunkBlocks.begin(), chunkBlocks.end());
+        }
+        else if (i < m_starts.size())
+        {
+            gathered.insert(gathered.end(), blocks.begin() + m_starts[i], blocks.begin() + m_starts[i] + m_counts[i]);
+        }
+
+        offsets.push_back(gathered.size());
+    }
+
+    layout(gathered, offsets);
+
+    blocks.swap(gathered);
+
+    return false;
+}
@@ -0,0 +1,240 @@
+
+#include "ChunkStreamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include <glm/common.hpp>
+
+#include "PrimitiveGrid.h"
+
+#include "Block.h"
+#include "BlockWorld.h"
+
+
+namespace
+{
+
+
+// Types of BlockWorldRendering::createTerrain()
+static const auto grassType = 16;
+static const auto dirtType = 12;
+static const auto stoneType = 8;
+
+// Height of the hills above and below y = 0, in blocks; stays below the chunk size, so layer 1 is air throughout
+static const auto amplitude = 24;
+static const auto hillScale = 1.0f / 256.0f;
+
+// Caves follow the lines where two noise fields are both close to zero
+static const auto caveScale = 1.0f / 24.0f;
+static const auto caveWidth = 0.1f;
+
+// Per worker and direction; small, so that requests issued for a since moved camera do not pile up
+static const auto queueCapacity = size_t(8);
+
+static const auto idleInterval = std::chrono::milliseconds(1);
+
+
+} // namespace
+
+
+const int ChunkStreamer::lowestLayer;
+const int ChunkStreamer::highestLayer;
+
+size_t ChunkStreamer::OriginHash::operator()(const glm::ivec3 & origin) const
+{
+    return static_cast<size_t>(origin.x / BlockWorld::chunkSize) * 73856093u
+        ^ static_cast<size_t>(origin.y / BlockWorld::chunkSize) * 19349663u
+        ^ static_cast<size_t>(origin.z / BlockWorld::chunkSize) * 83492791u;
+}
+
+ChunkStreamer::Worker::Worker()
+: requests(queueCapacity)
+, results(queueCapacity)
+{
+}
+
+void * ChunkStreamer::Worker::operator new(size_t size)
+{
+    // The allocated address is stored right before the aligned one
+    const auto allocated = ::operator new(size + alignof(Worker) + sizeof(void *));
+    const auto address = (reinterpret_cast<std::uintptr_t>(allocated) + sizeof(void *) + alignof(Worker) - 1) / alignof(Worker) * alignof(Worker);
+
+    reinterpret_cast<void **>(address)[-1] = allocated;
+
+    return reinterpret_cast<void *>(address);
+}
+
+void ChunkStreamer::Worker::operator delete(void * pointer)
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+
+    ::operator delete(static_cast<void **>(pointer)[-1]);
+}
+
+ChunkStreamer::ChunkStreamer(size_t workerCount, int threshold)
+: m_threshold(threshold)
+, m_stopped(false)
+, m_nextRequest(0)
+, m_nextPoll(0)
+{
+    for (auto i = size_t(0); i < std::max(workerCount, size_t(1)); ++i)
+    {
+        auto worker = new Worker;
+        worker->thread = std::thread(&ChunkStreamer::work, this, worker);
+
+        m_workers.push_back(worker);
+    }
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+    m_stopped.store(true, std::memory_order_relaxed);
+
+    for (auto worker : m_workers)
+    {
+        worker->thread.join();
+
+        delete worker;
+    }
+}
+
+size_t ChunkStreamer::workerCount() const
+{
+    return m_workers.size();
+}
+
+bool ChunkStreamer::request(const glm::ivec3 & origin)
+{
+    for (auto i = size_t(0); i < m_workers.size(); ++i)
+    {
+        const auto index = (m_nextRequest + i) % m_workers.size();
+        auto requested = origin;
+
+        if (m_workers[index]->requests.push(std::move(requested)))
+        {
+            m_nextRequest = (index + 1) % m_workers.size();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ChunkStreamer::poll(GeneratedChunk & chunk)
+{
+    for (auto i = size_t(0); i < m_workers.size(); ++i)
+    {
+        const auto index = (m_nextPoll + i) % m_workers.size();
+
+        if (m_workers[index]->results.pop(chunk))
+        {
+            m_nextPoll = (index + 1) % m_workers.size();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ChunkStreamer::work(Worker * worker)
+{
+    auto origin = glm::ivec3();
+
+    while (!m_stopped.load(std::memory_order_relaxed))
+    {
+        if (!worker->requests.pop(origin))
+        {
+            std::this_thread::sleep_for(idleInterval);
+
+            continue;
+        }
+
+        auto chunk = GeneratedChunk();
+        chunk.origin = origin;
+        chunk.blocks = generate(origin, m_threshold);
+
+        // Only this worker waits for a full result queue, never the requesting thread
+        while (!worker->results.push(std::move(chunk)) && !m_stopped.load(std::memory_order_relaxed))
+        {
+            std::this_thread::sleep_for(idleInterval);
+        }
+    }
+}
+
+std::vector<unsigned int> ChunkStreamer::generate(const glm::ivec3 & origin, int threshold)
+{
+    static const auto size = static_cast<size_t>(BlockWorld::paddedChunkSize);
+
+    auto result = std::vector<unsigned int>();
+
+    if (origin.y > amplitude)
+    {
+        return result;
+    }
+
+    // The types of the chunk and of the neighboring layers, up to the surface of each column
+    auto padded = std::vector<signed char>(size * size * size, static_cast<signed char>(BlockWorld::airType));
+
+    for (auto z = -1; z <= BlockWorld::chunkSize; ++z)
+    {
+        for (auto x = -1; x <= BlockWorld::chunkSize; ++x)
+        {
+            const auto height = terrainHeight(origin.x + x, origin.z + z);
+
+            for (auto y = -1; y <= std::min(height - origin.y, BlockWorld::chunkSize); ++y)
+            {
+                const auto cell = glm::ivec3(x, y, z);
+
+                padded[BlockWorld::paddedIndex(cell)] = static_cast<signed char>(terrainType(origin + cell, height));
+            }
+        }
+    }
+
+    const auto blocks = BlockWorld::visibleBlocks(origin, padded, glm::ivec3(0), glm::ivec3(BlockWorld::chunkSize), threshold);
+
+    result.reserve(blocks.size());
+
+    for (const auto & block : blocks)
+    {
+        result.push_back(block.packedBlock());
+    }
+
+    return result;
+}
+
+int ChunkStreamer::terrainHeight(int x, int z)
+{
+    // Hills with finer detail on top
+    const auto column = glm::vec3(x, z, 0.0f) * hillScale;
+    const auto noise = 0.75f * PrimitiveGrid::valueNoise(column, 0) + 0.25f * PrimitiveGrid::valueNoise(column * 4.0f, 1);
+
+    return static_cast<int>(glm::round(amplitude * noise));
+}
+
+int ChunkStreamer::terrainType(const glm::ivec3 & position, int height)
+{
+    if (position.y > height)
+    {
+        return BlockWorld::airType;
+    }
+
+    const auto p = glm::vec3(position) * caveScale;
+
+    if (glm::abs(PrimitiveGrid::valueNoise(p, 2)) < caveWidth && glm::abs(PrimitiveGrid::valueNoise(p, 3)) < caveWidth)
+    {
+        return BlockWorld::airType;
+    }
+
+    const auto depth = height - position.y;
+
+    return depth == 0 ? grassType : (depth <= 3 ? dirtType : stoneType);
+}
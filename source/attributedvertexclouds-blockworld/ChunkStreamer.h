@@ -0,0 +1,83 @@
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "SpscQueue.h"
+
+
+// Generates the chunks of an unbounded terrain on worker threads: hills from a heightmap with grass on dirt on stone,
+// hollowed out by caves, evaluated from value noise per position so that no chunk depends on another.
+// Each worker has its own request and result queue, so the requesting thread never waits on generation.
+class ChunkStreamer
+{
+public:
+    // Chunk layers around the surface that hold solid blocks; chunks above are air, chunks below are not streamed
+    static const int lowestLayer = -2;
+    static const int highestLayer = 0;
+
+    // Visible blocks of a chunk, packed with Block::packedBlock()
+    struct GeneratedChunk
+    {
+        glm::ivec3 origin;
+        std::vector<unsigned int> blocks;
+    };
+
+    struct OriginHash
+    {
+        size_t operator()(const glm::ivec3 & origin) const;
+    };
+
+    // Starts the workers; blocks with a type up to the threshold are air
+    ChunkStreamer(size_t workerCount, int threshold);
+
+    // Stops and joins the workers; requests not yet generated are dropped
+    ~ChunkStreamer();
+
+    size_t workerCount() const;
+
+    // Queues the chunk at origin with the next worker that has room; returns false if none has
+    bool request(const glm::ivec3 & origin);
+
+    // Takes a generated chunk of any worker; returns false if none is ready
+    bool poll(GeneratedChunk & chunk);
+
+    // Visible blocks of the chunk at origin; needs no world, as the types at its border are generated as well
+    static std::vector<unsigned int> generate(const glm::ivec3 & origin, int threshold);
+
+protected:
+    struct Worker
+    {
+        Worker();
+
+        // Keeps the cache line alignment of the queue indices, which plain new does not before C++17
+        static void * operator new(size_t size);
+        static void operator delete(void * pointer);
+
+        SpscQueue<glm::ivec3> requests;
+        SpscQueue<GeneratedChunk> results;
+
+        std::thread thread;
+    };
+
+    int m_threshold;
+
+    std::vector<Worker *> m_workers;
+    std::atomic<bool> m_stopped;
+
+    // Workers to try first, so requests and polls go round robin
+    size_t m_nextRequest;
+    size_t m_nextPoll;
+
+    void work(Worker * worker);
+
+    // Height of the surface of a column
+    static int terrainHeight(int x, int z);
+
+    // Type of a position in a column with the given surface
+    static int terrainType(const glm::ivec3 & position, int height);
+};
@@ -0,0 +1,78 @@
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+
+// Lock-free ring buffer between exactly one producer thread and one consumer thread.
+// Neither side ever waits: push() fails on a full queue and pop() on an empty one.
+template <typename T>
+class SpscQueue
+{
+public:
+    // Holds up to capacity values
+    explicit SpscQueue(size_t capacity);
+
+    // Producer side; moves the value in only on success
+    bool push(T && value);
+
+    // Consumer side
+    bool pop(T & value);
+
+protected:
+    // One slot stays empty to tell a full queue from an empty one
+    std::vector<T> m_slots;
+
+    // Next slot to read, advanced by the consumer, and next slot to write, advanced by the producer;
+    // on cache lines of their own, so the stores of one side do not evict the index the other side polls
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+};
+
+
+template <typename T>
+SpscQueue<T>::SpscQueue(size_t capacity)
+: m_slots(capacity + 1)
+, m_head(0)
+, m_tail(0)
+{
+}
+
+template <typename T>
+bool SpscQueue<T>::push(T && value)
+{
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    const auto next = (tail + 1) % m_slots.size();
+
+    if (next == m_head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    m_slots[tail] = std::move(value);
+
+    // Publishes the slot to the consumer
+    m_tail.store(next, std::memory_order_release);
+
+    return true;
+}
+
+template <typename T>
+bool SpscQueue<T>::pop(T & value)
+{
+    const auto head = m_head.load(std::memory_order_relaxed);
+
+    if (head == m_tail.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    value = std::move(m_slots[head]);
+
+    // Hands the slot back to the producer
+    m_head.store((head + 1) % m_slots.size(), std::memory_order_release);
+
+    return true;
+}
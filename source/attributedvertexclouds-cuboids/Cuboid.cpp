@@ -1,8 +1,19 @@
 
 #include "Cuboid.h"
 
+#include <cmath>
+
 
 Cuboid::Cuboid()
 : colorValue(0.0f)
+, rotation(0.0f)
 {
 }
+
+glm::vec3 Cuboid::boundingExtent() const
+{
+    const auto c = std::abs(std::cos(rotation));
+    const auto s = std::abs(std::sin(rotation));
+
+    return glm::vec3(c * extent.x + s * extent.z, extent.y, s * extent.x + c * extent.z);
+}
@@ -9,7 +9,13 @@ class Cuboid
 public:
     Cuboid();
 
+    // Extent of the axis-aligned box around the rotated cuboid
+    glm::vec3 boundingExtent() const;
+
     glm::vec3 center;
     glm::vec3 extent;
     float colorValue;
+
+    // Yaw around the vertical axis through the center, in radians; zero keeps the cuboid axis-aligned
+    float rotation;
 };
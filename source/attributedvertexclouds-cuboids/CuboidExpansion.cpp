@@ -0,0 +1,229 @@
+
+#include "CuboidExpansion.h"
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CUBOID_EXPANSION_SIMD
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CUBOID_EXPANSION_SIMD
+#endif
+
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "The expansion treats vec3 arrays as tightly packed float arrays");
+
+
+namespace
+{
+
+
+#if defined(__AVX__)
+
+typedef __m256 Vector;
+
+static const auto vectorWidth = size_t(8);
+
+inline Vector load(const float * source) { return _mm256_loadu_ps(source); }
+inline Vector broadcast(float value) { return _mm256_set1_ps(value); }
+inline Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+inline void stream(float * target, Vector value) { _mm256_stream_ps(target, value); }
+
+#elif defined(CUBOID_EXPANSION_SIMD)
+
+typedef __m128 Vector;
+
+static const auto vectorWidth = size_t(4);
+
+inline Vector load(const float * source) { return _mm_loadu_ps(source); }
+inline Vector broadcast(float value) { return _mm_set1_ps(value); }
+inline Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline void stream(float * target, Vector value) { _mm_stream_ps(target, value); }
+
+#else
+
+static const auto vectorWidth = size_t(1);
+
+#endif
+
+
+// Non-temporal stores need the target aligned to the vector size
+inline bool aligned(const float * target)
+{
+    return reinterpret_cast<std::uintptr_t>(target) % (vectorWidth * sizeof(float)) == 0;
+}
+
+#ifdef CUBOID_EXPANSION_SIMD
+// x, y, z repeated over the lanes, starting with the given component
+inline Vector componentPattern(const glm::vec3 & value, size_t firstComponent)
+{
+    float lanes[vectorWidth];
+
+    for (auto i = size_t(0); i < vectorWidth; ++i)
+    {
+        lanes[i] = value[static_cast<glm::length_t>((firstComponent + i) % 3)];
+    }
+
+    return load(lanes);
+}
+#endif
+
+// Yaw rotation of a direction around the vertical axis, given the cosine and sine of the angle
+inline glm::vec3 rotateYaw(const glm::vec3 & direction, float c, float s)
+{
+    return glm::vec3(c * direction.x + s * direction.z, direction.y, c * direction.z - s * direction.x);
+}
+
+inline void finishStreaming()
+{
+#ifdef CUBOID_EXPANSION_SIMD
+    _mm_sfence();
+#endif
+}
+
+
+} // namespace
+
+
+void expandCuboidPositions(const Cuboid * cuboids, size_t count, const glm::vec3 * unitVertices, size_t verticesPerCuboid, glm::vec3 * positions)
+{
+    const auto floatsPerCuboid = verticesPerCuboid * 3;
+    const auto unit = reinterpret_cast<const float *>(unitVertices);
+
+    auto output = reinterpret_cast<float *>(positions);
+
+    for (auto i = size_t(0); i < count; ++i, output += floatsPerCuboid)
+    {
+        const auto & cuboid = cuboids[i];
+
+        if (cuboid.rotation != 0.0f)
+        {
+            const auto c = std::cos(cuboid.rotation);
+            const auto s = std::sin(cuboid.rotation);
+
+            for (auto j = size_t(0); j < verticesPerCuboid; ++j)
+            {
+                const auto position = cuboid.center + rotateYaw(cuboid.extent * unitVertices[j], c, s);
+
+                output[3 * j + 0] = position.x;
+                output[3 * j + 1] = position.y;
+                output[3 * j + 2] = position.z;
+            }
+
+            continue;
+        }
+
+        const auto scalar = [&cuboid, unit, output](size_t j) {
+            const auto component = static_cast<glm::length_t>(j % 3);
+            output[j] = cuboid.center[component] + cuboid.extent[component] * unit[j];
+        };
+
+        auto j = size_t(0);
+
+        for (; j < floatsPerCuboid && !aligned(output + j); ++j)
+        {
+            scalar(j);
+        }
+
+#ifdef CUBOID_EXPANSION_SIMD
+        const Vector centers[3] = { componentPattern(cuboid.center, 0), componentPattern(cuboid.center, 1), componentPattern(cuboid.center, 2) };
+        const Vector extents[3] = { componentPattern(cuboid.extent, 0), componentPattern(cuboid.extent, 1), componentPattern(cuboid.extent, 2) };
+
+        for (auto phase = j % 3; j + vectorWidth <= floatsPerCuboid; j += vectorWidth, phase = (phase + vectorWidth) % 3)
+        {
+            stream(output + j, multiplyAdd(load(unit + j), extents[phase], centers[phase]));
+        }
+#endif
+
+        for (; j < floatsPerCuboid; ++j)
+        {
+            scalar(j);
+        }
+    }
+
+    finishStreaming();
+}
+
+void expandCuboidNormals(const Cuboid * cuboids, size_t count, const glm::vec3 * cuboidNormals, size_t verticesPerCuboid, glm::vec3 * normals)
+{
+    const auto floatsPerCuboid = verticesPerCuboid * 3;
+    const auto normal = reinterpret_cast<const float *>(cuboidNormals);
+
+    auto output = reinterpret_cast<float *>(normals);
+
+    for (auto i = size_t(0); i < count; ++i, output += floatsPerCuboid)
+    {
+        if (cuboids[i].rotation != 0.0f)
+        {
+            const auto c = std::cos(cuboids[i].rotation);
+            const auto s = std::sin(cuboids[i].rotation);
+
+            for (auto j = size_t(0); j < verticesPerCuboid; ++j)
+            {
+                const auto rotated = rotateYaw(cuboidNormals[j], c, s);
+
+                output[3 * j + 0] = rotated.x;
+                output[3 * j + 1] = rotated.y;
+                output[3 * j + 2] = rotated.z;
+            }
+
+            continue;
+        }
+
+        auto j = size_t(0);
+
+        for (; j < floatsPerCuboid && !aligned(output + j); ++j)
+        {
+            output[j] = normal[j];
+        }
+
+#ifdef CUBOID_EXPANSION_SIMD
+        for (; j + vectorWidth <= floatsPerCuboid; j += vectorWidth)
+        {
+            stream(output + j, load(normal + j));
+        }
+#endif
+
+        for (; j < floatsPerCuboid; ++j)
+        {
+            output[j] = normal[j];
+        }
+    }
+
+    finishStreaming();
+}
+
+void expandCuboidColors(const Cuboid * cuboids, size_t count, size_t verticesPerCuboid, float * colorValues)
+{
+    auto output = colorValues;
+
+    for (auto i = size_t(0); i < count; ++i, output += verticesPerCuboid)
+    {
+        const auto colorValue = cuboids[i].colorValue;
+
+        auto j = size_t(0);
+
+        for (; j < verticesPerCuboid && !aligned(output + j); ++j)
+        {
+            output[j] = colorValue;
+        }
+
+#ifdef CUBOID_EXPANSION_SIMD
+        const auto value = broadcast(colorValue);
+
+        for (; j + vectorWidth <= verticesPerCuboid; j += vectorWidth)
+        {
+            stream(output + j, value);
+        }
+#endif
+
+        for (; j < verticesPerCuboid; ++j)
+        {
+            output[j] = colorValue;
+        }
+    }
+
+    finishStreaming();
+}
@@ -0,0 +1,21 @@
+
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include "Cuboid.h"
+
+
+// Batched expansion of cuboids into the per-vertex arrays of the triangle and triangle strip techniques.
+// Each output range holds verticesPerCuboid consecutive entries per cuboid. The kernels use SSE, or AVX if
+// the compiler targets it, and write with non-temporal stores, as the output is not read again before upload.
+// Rotated cuboids take a scalar path, so axis-aligned input keeps the vectorized one.
+
+// positions[i] = center + rotation * (extent * unitVertices[i % verticesPerCuboid])
+void expandCuboidPositions(const Cuboid * cuboids, size_t count, const glm::vec3 * unitVertices, size_t verticesPerCuboid, glm::vec3 * positions);
+
+// normals[i] = rotation * cuboidNormals[i % verticesPerCuboid]
+void expandCuboidNormals(const Cuboid * cuboids, size_t count, const glm::vec3 * cuboidNormals, size_t verticesPerCuboid, glm::vec3 * normals);
+
+// colorValues[i] = colorValue of the cuboid
+void expandCuboidColors(const Cuboid * cuboids, size_t count, size_t verticesPerCuboid, float * colorValues);
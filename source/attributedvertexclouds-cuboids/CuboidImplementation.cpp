@@ -10,3 +10,28 @@ CuboidImplementation::CuboidImplementation(const std::string & name)
 CuboidImplementation::~CuboidImplementation()
 {
 }
+
+void CuboidImplementation::setGrid(const glm::vec3 & /*origin*/, const glm::vec3 & /*cellSize*/, const glm::ivec3 & /*cellCount*/)
+{
+}
+
+void CuboidImplementation::setCamera(const glm::vec3 & /*eye*/, const glm::mat4 & /*viewProjection*/, float /*pixelsPerUnit*/)
+{
+}
+
+void CuboidImplementation::setCubes(size_t first, const Cuboid * cuboids, size_t count)
+{
+    for (auto i = size_t(0); i < count; ++i)
+    {
+        setCube(first + i, cuboids[i]);
+    }
+}
+
+void CuboidImplementation::finishCubes()
+{
+}
+
+size_t CuboidImplementation::orientationByteSize() const
+{
+    return 0;
+}
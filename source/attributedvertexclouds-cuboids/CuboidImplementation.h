@@ -1,6 +1,9 @@
 
 #pragma once
 
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
 #include "Cuboid.h"
 #include "Implementation.h"
 
@@ -11,5 +14,23 @@ public:
     CuboidImplementation(const std::string & name);
     virtual ~CuboidImplementation();
 
+    // Grid of cellCount cells from origin that the following cuboids are placed in; compressed layouts store cell-relative values
+    virtual void setGrid(const glm::vec3 & origin, const glm::vec3 & cellSize, const glm::ivec3 & cellCount);
+
+    // Camera of the upcoming frame, for techniques that select their geometry per view
+    virtual void setCamera(const glm::vec3 & eye, const glm::mat4 & viewProjection, float pixelsPerUnit);
+
     virtual void setCube(size_t index, const Cuboid & cuboid) = 0;
+
+    // Sets count consecutive cuboids starting at first; techniques override it with batched kernels
+    virtual void setCubes(size_t first, const Cuboid * cuboids, size_t count);
+
+    // Called once all cuboids are set, for data derived from all of them; needs no GL context
+    virtual void finishCubes();
+
+    // Uploads all cuboids again after they were set anew; expects the technique to be initialized
+    virtual void updateBuffers() = 0;
+
+    // GPU memory spent on the cuboid rotations; zero where the rotation is baked into the vertices
+    virtual size_t orientationByteSize() const;
 };
@@ -0,0 +1,363 @@
+
+#include "CuboidIndexedTriangles.h"
+
+#include <array>
+
+#include <glbinding/gl/gl.h>
+
+#include "common.h"
+#include "StripDrawing.h"
+
+#include "CuboidExpansion.h"
+
+using namespace gl;
+
+
+namespace
+{
+
+
+static const auto restartIndex = GLuint(0xffffffff);
+
+// Faces in the order -x, -z, +x, +z, +y, -y; the corners are those of CuboidTriangles
+static const glm::vec3 corners[8] = {
+    glm::vec3(-0.5f, 0.5f, -0.5f),
+    glm::vec3(-0.5f, 0.5f, 0.5f),
+    glm::vec3(0.5f, 0.5f, -0.5f),
+    glm::vec3(0.5f, 0.5f, 0.5f),
+    glm::vec3(0.5f, -0.5f, 0.5f),
+    glm::vec3(-0.5f, -0.5f, 0.5f),
+    glm::vec3(-0.5f, -0.5f, -0.5f),
+    glm::vec3(0.5f, -0.5f, -0.5f),
+};
+
+static const size_t faceCorners[6][4] = {
+    { 1, 0, 5, 6 },
+    { 6, 0, 7, 2 },
+    { 2, 3, 7, 4 },
+    { 4, 3, 5, 1 },
+    { 1, 3, 0, 2 },
+    { 5, 6, 4, 7 }
+};
+
+static const glm::vec3 faceNormals[6] = {
+    glm::vec3(-1.0f, 0.0f, 0.0f),
+    glm::vec3(0.0f, 0.0f, -1.0f),
+    glm::vec3(1.0f, 0.0f, 0.0f),
+    glm::vec3(0.0f, 0.0f, 1.0f),
+    glm::vec3(0.0f, 1.0f, 0.0f),
+    glm::vec3(0.0f, -1.0f, 0.0f)
+};
+
+// Two triangles per face, 0-1-2 and 2-1-3 of its four vertices
+static const GLuint triangleIndices[36] = {
+    0, 1, 2, 2, 1, 3,
+    4, 5, 6, 6, 5, 7,
+    8, 9, 10, 10, 9, 11,
+    12, 13, 14, 14, 13, 15,
+    16, 17, 18, 18, 17, 19,
+    20, 21, 22, 22, 21, 23
+};
+
+// The strip of CuboidTriangleStrip; each vertex is taken from the face of the triangle it completes,
+// so the flat-shaded normal of the provoking vertex matches
+static const GLuint stripIndices[14] = {
+    18, 16, 19, 17, // +y
+    11,             // +x
+    15, 14,         // +z
+    1, 3,           // -x
+    7, 6,           // -z
+    11,             // +x
+    21, 20          // -y
+};
+
+std::array<glm::vec3, 24> unitCubeVertices()
+{
+    auto vertices = std::array<glm::vec3, 24>();
+
+    for (auto i = size_t(0); i < vertices.size(); ++i)
+    {
+        vertices[i] = corners[faceCorners[i / 4][i % 4]];
+    }
+
+    return vertices;
+}
+
+std::array<glm::vec3, 24> unitCubeNormals()
+{
+    auto normals = std::array<glm::vec3, 24>();
+
+    for (auto i = size_t(0); i < normals.size(); ++i)
+    {
+        normals[i] = faceNormals[i / 4];
+    }
+
+    return normals;
+}
+
+
+} // namespace
+
+
+CuboidIndexedTriangles::CuboidIndexedTriangles(bool usePrimitiveRestart)
+: CuboidImplementation(usePrimitiveRestart ? StripDrawing::name("Indexed Triangle Strip", StripDrawMode::PrimitiveRestart) : "Indexed Triangles")
+, m_primitiveRestart(usePrimitiveRestart)
+, m_vertices(0)
+, m_indices(0)
+, m_vao(0)
+, m_vertexShader(0)
+, m_fragmentShader(0)
+{
+}
+
+CuboidIndexedTriangles::~CuboidIndexedTriangles()
+{
+    if (!initialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_vertices);
+    glDeleteBuffers(1, &m_indices);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteShader(m_vertexShader);
+    glDeleteShader(m_fragmentShader);
+    glDeleteProgram(m_program);
+}
+
+void CuboidIndexedTriangles::onInitialize()
+{
+    glGenBuffers(1, &m_vertices);
+    glGenBuffers(1, &m_indices);
+    glGenVertexArrays(1, &m_vao);
+
+    initializeVAO();
+
+    m_vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    m_fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+    m_program = glCreateProgram();
+
+    glAttachShader(m_program, m_vertexShader);
+    glAttachShader(m_program, m_fragmentShader);
+
+    loadShader();
+}
+
+void CuboidIndexedTriangles::initializeVAO()
+{
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferData(GL_ARRAY_BUFFER, verticesCount() * vertexByteSize(), nullptr, GL_STATIC_DRAW);
+
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 0, verticesCount() * sizeof(float) * 3, m_vertex.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 3, verticesCount() * sizeof(float) * 3, m_normal.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 6, verticesCount() * sizeof(float) * 1, m_colorValue.data());
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 0));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 3));
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 6));
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+
+    // The element array binding is part of the VAO state
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indices);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_index.size() * sizeof(GLuint), m_index.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+bool CuboidIndexedTriangles::loadShader()
+{
+    const auto vertexShaderSource = loadShaderSource("/visualization-triangles/standard.vert");
+    const auto vertexShaderSource_ptr = vertexShaderSource.c_str();
+    if(vertexShaderSource_ptr)
+        glShaderSource(m_vertexShader, 1, &vertexShaderSource_ptr, 0);
+
+    glCompileShader(m_vertexShader);
+
+    bool success = checkForCompilationError(m_vertexShader, "vertex shader");
+
+    const auto fragmentShaderSource = loadShaderSource("/visualization.frag");
+    const auto fragmentShaderSource_ptr = fragmentShaderSource.c_str();
+    if(fragmentShaderSource_ptr)
+        glShaderSource(m_fragmentShader, 1, &fragmentShaderSource_ptr, 0);
+
+    glCompileShader(m_fragmentShader);
+
+    success &= checkForCompilationError(m_fragmentShader, "fragment shader");
+
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glLinkProgram(m_program);
+
+    success &= checkForLinkerError(m_program, "program");
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glBindFragDataLocation(m_program, 0, "out_color");
+
+    return true;
+}
+
+void CuboidIndexedTriangles::setCube(size_t index, const Cuboid & cuboid)
+{
+    setCubes(index, &cuboid, 1);
+}
+
+void CuboidIndexedTriangles::setCubes(size_t first, const Cuboid * cuboids, size_t count)
+{
+    static const auto vertices = unitCubeVertices();
+    static const auto normals = unitCubeNormals();
+
+    const auto offset = verticesPerCuboid() * first;
+
+    expandCuboidPositions(cuboids, count, vertices.data(), vertices.size(), m_vertex.data() + offset);
+    expandCuboidNormals(cuboids, count, normals.data(), normals.size(), m_normal.data() + offset);
+    expandCuboidColors(cuboids, count, verticesPerCuboid(), m_colorValue.data() + offset);
+}
+
+void CuboidIndexedTriangles::updateBuffers()
+{
+    initializeVAO();
+}
+
+size_t CuboidIndexedTriangles::size() const
+{
+    return m_vertex.size() / verticesPerCuboid();
+}
+
+size_t CuboidIndexedTriangles::verticesPerCuboid() const
+{
+    return 24;
+}
+
+size_t CuboidIndexedTriangles::indicesPerCuboid() const
+{
+    return m_primitiveRestart ? 15 : 36;
+}
+
+size_t CuboidIndexedTriangles::verticesCount() const
+{
+    return size() * verticesPerCuboid();
+}
+
+size_t CuboidIndexedTriangles::staticByteSize() const
+{
+    return 0;
+}
+
+size_t CuboidIndexedTriangles::byteSize() const
+{
+    return verticesCount() * vertexByteSize() + m_index.size() * sizeof(GLuint);
+}
+
+size_t CuboidIndexedTriangles::vertexByteSize() const
+{
+    return sizeof(float) * componentCount();
+}
+
+size_t CuboidIndexedTriangles::componentCount() const
+{
+    return 7;
+}
+
+void CuboidIndexedTriangles::resize(size_t count)
+{
+    m_vertex.resize(count * verticesPerCuboid());
+    m_normal.resize(count * verticesPerCuboid());
+    m_colorValue.resize(count * verticesPerCuboid());
+
+    // The indices only depend on the cuboid count
+    m_index.resize(count * indicesPerCuboid());
+
+#pragma omp parallel for
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto base = static_cast<GLuint>(i * verticesPerCuboid());
+        const auto target = m_index.data() + i * indicesPerCuboid();
+
+        if (m_primitiveRestart)
+        {
+            for (auto j = size_t(0); j < 14; ++j)
+            {
+                target[j] = base + stripIndices[j];
+            }
+
+            target[14] = restartIndex;
+        }
+        else
+        {
+            for (auto j = size_t(0); j < 36; ++j)
+            {
+                target[j] = base + triangleIndices[j];
+            }
+        }
+    }
+}
+
+size_t CuboidIndexedTriangles::cpuByteSize() const
+{
+    return containerByteSize(m_vertex)
+        + containerByteSize(m_normal)
+        + containerByteSize(m_colorValue)
+        + containerByteSize(m_index);
+}
+
+std::vector<gl::GLuint> CuboidIndexedTriangles::buffers() const
+{
+    return { m_vertices, m_indices };
+}
+
+void CuboidIndexedTriangles::onRender()
+{
+    glBindVertexArray(m_vao);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    glDisable(GL_CULL_FACE);
+    //glCullFace(GL_BACK);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    glUseProgram(m_program);
+
+    if (m_primitiveRestart)
+    {
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(restartIndex);
+
+        glDrawElements(GL_TRIANGLE_STRIP, static_cast<GLsizei>(m_index.size()), GL_UNSIGNED_INT, nullptr);
+
+        glDisable(GL_PRIMITIVE_RESTART);
+    }
+    else
+    {
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_index.size()), GL_UNSIGNED_INT, nullptr);
+    }
+
+    glDepthMask(GL_TRUE);
+
+    glUseProgram(0);
+
+    glBindVertexArray(0);
+}
+
+gl::GLuint CuboidIndexedTriangles::program() const
+{
+    return m_program;
+}
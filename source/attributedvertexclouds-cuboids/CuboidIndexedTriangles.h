@@ -0,0 +1,65 @@
+
+#pragma once
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include <glbinding/gl/types.h>
+
+#include "Cuboid.h"
+#include "CuboidImplementation.h"
+
+
+// 24 shared vertices per cuboid (four per face, as the faces need distinct normals), drawn through
+// an element buffer either as triangle list or as triangle strips separated by primitive restart
+class CuboidIndexedTriangles : public CuboidImplementation
+{
+public:
+    CuboidIndexedTriangles(bool usePrimitiveRestart);
+    ~CuboidIndexedTriangles();
+
+    virtual void onInitialize() override;
+    virtual void onRender() override;
+
+    virtual bool loadShader() override;
+
+    virtual void setCube(size_t index, const Cuboid & cuboid) override;
+    virtual void setCubes(size_t first, const Cuboid * cuboids, size_t count) override;
+    virtual void updateBuffers() override;
+
+    virtual size_t size() const override;
+    virtual size_t verticesCount() const override;
+    virtual size_t staticByteSize() const override;
+    virtual size_t byteSize() const override;
+    virtual size_t vertexByteSize() const override;
+    virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
+
+    virtual void resize(size_t count) override;
+
+    virtual std::vector<gl::GLuint> buffers() const override;
+
+    virtual gl::GLuint program() const override;
+public:
+    bool m_primitiveRestart;
+
+    std::vector<glm::vec3> m_vertex;
+    std::vector<glm::vec3> m_normal;
+    std::vector<float> m_colorValue;
+
+    std::vector<gl::GLuint> m_index;
+
+    gl::GLuint m_vertices;
+    gl::GLuint m_indices;
+    gl::GLuint m_vao;
+
+    gl::GLuint m_vertexShader;
+    gl::GLuint m_fragmentShader;
+
+    gl::GLuint m_program;
+
+    void initializeVAO();
+    size_t verticesPerCuboid() const;
+    size_t indicesPerCuboid() const;
+};
@@ -20,6 +20,11 @@ CuboidInstancing::CuboidInstancing()
 
 CuboidInstancing::~CuboidInstancing()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteBuffers(1, &m_attributes);
     glDeleteVertexArrays(1, &m_vao);
@@ -106,18 +111,22 @@ void CuboidInstancing::initializeVAO()
     glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 0, verticesCount() * sizeof(float) * 3, m_position.data());
     glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 3, verticesCount() * sizeof(float) * 3, m_scale.data());
     glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 6, verticesCount() * sizeof(float) * 1, m_colorValue.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 7, verticesCount() * sizeof(float) * 1, m_rotation.data());
 
     glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 0));
     glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 3));
     glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 6));
+    glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 7));
 
     glVertexAttribDivisor(2, 1);
     glVertexAttribDivisor(3, 1);
     glVertexAttribDivisor(4, 1);
+    glVertexAttribDivisor(5, 1);
 
     glEnableVertexAttribArray(2);
     glEnableVertexAttribArray(3);
     glEnableVertexAttribArray(4);
+    glEnableVertexAttribArray(5);
 
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -168,6 +177,12 @@ void CuboidInstancing::setCube(size_t index, const Cuboid & cuboid)
     m_position[index] = cuboid.center;
     m_scale[index] = cuboid.extent / glm::vec3(2.0f);
     m_colorValue[index] = cuboid.colorValue;
+    m_rotation[index] = cuboid.rotation;
+}
+
+void CuboidInstancing::updateBuffers()
+{
+    initializeVAO();
 }
 
 size_t CuboidInstancing::size() const
@@ -202,7 +217,7 @@ size_t CuboidInstancing::vertexByteSize() const
 
 size_t CuboidInstancing::componentCount() const
 {
-    return 7;
+    return 8;
 }
 
 void CuboidInstancing::resize(size_t count)
@@ -210,6 +225,25 @@ void CuboidInstancing::resize(size_t count)
     m_position.resize(count * verticesPerCuboid());
     m_scale.resize(count * verticesPerCuboid());
     m_colorValue.resize(count * verticesPerCuboid());
+    m_rotation.resize(count * verticesPerCuboid());
+}
+
+size_t CuboidInstancing::cpuByteSize() const
+{
+    return containerByteSize(m_position)
+        + containerByteSize(m_scale)
+        + containerByteSize(m_colorValue)
+        + containerByteSize(m_rotation);
+}
+
+size_t CuboidInstancing::orientationByteSize() const
+{
+    return verticesCount() * sizeof(float);
+}
+
+std::vector<gl::GLuint> CuboidInstancing::buffers() const
+{
+    return { m_vertices, m_attributes };
 }
 
 void CuboidInstancing::onRender()
@@ -23,6 +23,7 @@ public:
     virtual bool loadShader() override;
 
     virtual void setCube(size_t index, const Cuboid & cuboid) override;
+    virtual void updateBuffers() override;
 
     virtual size_t size() const override;
     virtual size_t verticesCount() const override;
@@ -30,14 +31,19 @@ public:
     virtual size_t byteSize() const override;
     virtual size_t vertexByteSize() const override;
     virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
+    virtual size_t orientationByteSize() const override;
 
     virtual void resize(size_t count) override;
 
+    virtual std::vector<gl::GLuint> buffers() const override;
+
     virtual gl::GLuint program() const override;
 public:
     std::vector<glm::vec3> m_position;
     std::vector<glm::vec3> m_scale;
     std::vector<float> m_colorValue;
+    std::vector<float> m_rotation;
 
     gl::GLuint m_vertices;
     gl::GLuint m_attributes;
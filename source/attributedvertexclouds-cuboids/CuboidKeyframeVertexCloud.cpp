@@ -0,0 +1,333 @@
+
+#include "CuboidKeyframeVertexCloud.h"
+
+#include <glm/common.hpp>
+
+#include <glbinding/gl/gl.h>
+
+#include "common.h"
+
+using namespace gl;
+
+
+CuboidKeyframeVertexCloud::CuboidKeyframeVertexCloud()
+: CuboidImplementation("Attributed Vertex Cloud (Keyframes)")
+, m_target(1)
+, m_transitionStart(0)
+, m_transitionFrames(0)
+, m_frame(0)
+, m_vertices(0)
+, m_vao(0)
+, m_vertexShader(0)
+, m_geometryShader(0)
+, m_fragmentShader(0)
+{
+}
+
+CuboidKeyframeVertexCloud::~CuboidKeyframeVertexCloud()
+{
+    if (!initialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_vertices);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteShader(m_vertexShader);
+    glDeleteShader(m_geometryShader);
+    glDeleteShader(m_fragmentShader);
+    glDeleteProgram(m_program);
+}
+
+void CuboidKeyframeVertexCloud::onInitialize()
+{
+    glGenBuffers(1, &m_vertices);
+    glGenVertexArrays(1, &m_vao);
+
+    initializeVAO();
+
+    m_vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    m_geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
+    m_fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+    m_program = glCreateProgram();
+
+    glAttachShader(m_program, m_vertexShader);
+    glAttachShader(m_program, m_geometryShader);
+    glAttachShader(m_program, m_fragmentShader);
+
+    loadShader();
+}
+
+void CuboidKeyframeVertexCloud::initializeVAO()
+{
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_DYNAMIC_DRAW);
+
+    for (auto keyframe = size_t(0); keyframe < 2; ++keyframe)
+    {
+        uploadKeyframe(keyframe);
+
+        const auto offset = keyframe * keyframeByteSize();
+        const auto location = static_cast<GLuint>(keyframe * 4);
+
+        glVertexAttribPointer(location + 0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(offset + verticesCount() * sizeof(float) * 0));
+        glVertexAttribPointer(location + 1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(offset + verticesCount() * sizeof(float) * 2));
+        glVertexAttribPointer(location + 2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(offset + verticesCount() * sizeof(float) * 4));
+        glVertexAttribPointer(location + 3, 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void*>(offset + verticesCount() * sizeof(float) * 6));
+
+        // The rotations follow the attributes of both keyframes
+        glVertexAttribPointer(static_cast<GLuint>(8 + keyframe), 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void*>(offset + verticesCount() * sizeof(float) * 7));
+
+        glEnableVertexAttribArray(location + 0);
+        glEnableVertexAttribArray(location + 1);
+        glEnableVertexAttribArray(location + 2);
+        glEnableVertexAttribArray(location + 3);
+        glEnableVertexAttribArray(static_cast<GLuint>(8 + keyframe));
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void CuboidKeyframeVertexCloud::uploadKeyframe(size_t keyframe)
+{
+    const auto offset = keyframe * keyframeByteSize();
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+
+    glBufferSubData(GL_ARRAY_BUFFER, offset + verticesCount() * sizeof(float) * 0, verticesCount() * sizeof(float) * 2, m_center[keyframe].data());
+    glBufferSubData(GL_ARRAY_BUFFER, offset + verticesCount() * sizeof(float) * 2, verticesCount() * sizeof(float) * 2, m_extent[keyframe].data());
+    glBufferSubData(GL_ARRAY_BUFFER, offset + verticesCount() * sizeof(float) * 4, verticesCount() * sizeof(float) * 2, m_heightRange[keyframe].data());
+    glBufferSubData(GL_ARRAY_BUFFER, offset + verticesCount() * sizeof(float) * 6, verticesCount() * sizeof(float) * 1, m_colorValue[keyframe].data());
+    glBufferSubData(GL_ARRAY_BUFFER, offset + verticesCount() * sizeof(float) * 7, verticesCount() * sizeof(float) * 1, m_rotation[keyframe].data());
+}
+
+bool CuboidKeyframeVertexCloud::loadShader()
+{
+    const auto vertexShaderSource = loadShaderSource("/cuboids-avc/keyframe.vert");
+    const auto vertexShaderSource_ptr = vertexShaderSource.c_str();
+    if(vertexShaderSource_ptr)
+        glShaderSource(m_vertexShader, 1, &vertexShaderSource_ptr, 0);
+
+    glCompileShader(m_vertexShader);
+
+    bool success = checkForCompilationError(m_vertexShader, "vertex shader");
+
+
+    const auto geometryShaderSource = loadShaderSource("/cuboids-avc/standard.geom");
+    const auto geometryShaderSource_ptr = geometryShaderSource.c_str();
+    if(geometryShaderSource_ptr)
+        glShaderSource(m_geometryShader, 1, &geometryShaderSource_ptr, 0);
+
+    glCompileShader(m_geometryShader);
+
+    success &= checkForCompilationError(m_geometryShader, "geometry shader");
+
+
+    const auto fragmentShaderSource = loadShaderSource("/visualization.frag");
+    const auto fragmentShaderSource_ptr = fragmentShaderSource.c_str();
+    if(fragmentShaderSource_ptr)
+        glShaderSource(m_fragmentShader, 1, &fragmentShaderSource_ptr, 0);
+
+    glCompileShader(m_fragmentShader);
+
+    success &= checkForCompilationError(m_fragmentShader, "fragment shader");
+
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glLinkProgram(m_program);
+
+    success &= checkForLinkerError(m_program, "program");
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glBindFragDataLocation(m_program, 0, "out_color");
+
+    return true;
+}
+
+void CuboidKeyframeVertexCloud::setCube(size_t index, const Cuboid & cuboid)
+{
+    for (auto keyframe = size_t(0); keyframe < 2; ++keyframe)
+    {
+        m_center[keyframe][index] = glm::vec2(cuboid.center.x, cuboid.center.z);
+        m_extent[keyframe][index] = glm::vec2(cuboid.extent.x, cuboid.extent.z);
+        m_heightRange[keyframe][index] = glm::vec2(cuboid.center.y - cuboid.extent.y / 2.0f, cuboid.extent.y);
+        m_colorValue[keyframe][index] = cuboid.colorValue;
+        m_rotation[keyframe][index] = cuboid.rotation;
+    }
+}
+
+Cuboid CuboidKeyframeVertexCloud::targetCube(size_t index) const
+{
+    const auto & center = m_center[m_target][index];
+    const auto & extent = m_extent[m_target][index];
+    const auto & heightRange = m_heightRange[m_target][index];
+
+    auto cuboid = Cuboid();
+    cuboid.center = glm::vec3(center.x, heightRange.x + heightRange.y / 2.0f, center.y);
+    cuboid.extent = glm::vec3(extent.x, heightRange.y, extent.y);
+    cuboid.colorValue = m_colorValue[m_target][index];
+    cuboid.rotation = m_rotation[m_target][index];
+
+    return cuboid;
+}
+
+void CuboidKeyframeVertexCloud::setTargetCube(size_t index, const Cuboid & cuboid)
+{
+    const auto next = 1 - m_target;
+
+    m_center[next][index] = glm::vec2(cuboid.center.x, cuboid.center.z);
+    m_extent[next][index] = glm::vec2(cuboid.extent.x, cuboid.extent.z);
+    m_heightRange[next][index] = glm::vec2(cuboid.center.y - cuboid.extent.y / 2.0f, cuboid.extent.y);
+    m_colorValue[next][index] = cuboid.colorValue;
+    m_rotation[next][index] = cuboid.rotation;
+}
+
+void CuboidKeyframeVertexCloud::startTransition(size_t frame, size_t frames)
+{
+    m_target = 1 - m_target;
+
+    // Before initialization, both keyframes are uploaded with the VAO
+    if (initialized())
+    {
+        uploadKeyframe(m_target);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    m_transitionStart = frame;
+    m_transitionFrames = frames;
+}
+
+void CuboidKeyframeVertexCloud::setFrame(size_t frame)
+{
+    m_frame = frame;
+}
+
+void CuboidKeyframeVertexCloud::updateBuffers()
+{
+    initializeVAO();
+}
+
+size_t CuboidKeyframeVertexCloud::size() const
+{
+    return m_center[0].size();
+}
+
+size_t CuboidKeyframeVertexCloud::verticesPerCuboid() const
+{
+    return 1;
+}
+
+size_t CuboidKeyframeVertexCloud::verticesCount() const
+{
+    return size() * verticesPerCuboid();
+}
+
+size_t CuboidKeyframeVertexCloud::staticByteSize() const
+{
+    return 0;
+}
+
+size_t CuboidKeyframeVertexCloud::keyframeByteSize() const
+{
+    return verticesCount() * vertexByteSize() / 2;
+}
+
+size_t CuboidKeyframeVertexCloud::byteSize() const
+{
+    return verticesPerCuboid() * size() * vertexByteSize();
+}
+
+size_t CuboidKeyframeVertexCloud::vertexByteSize() const
+{
+    return sizeof(float) * componentCount();
+}
+
+size_t CuboidKeyframeVertexCloud::componentCount() const
+{
+    return 16;
+}
+
+void CuboidKeyframeVertexCloud::resize(size_t count)
+{
+    for (auto keyframe = size_t(0); keyframe < 2; ++keyframe)
+    {
+        m_center[keyframe].resize(count);
+        m_extent[keyframe].resize(count);
+        m_heightRange[keyframe].resize(count);
+        m_colorValue[keyframe].resize(count);
+        m_rotation[keyframe].resize(count);
+    }
+}
+
+size_t CuboidKeyframeVertexCloud::cpuByteSize() const
+{
+    auto result = size_t(0);
+
+    for (auto keyframe = size_t(0); keyframe < 2; ++keyframe)
+    {
+        result += containerByteSize(m_center[keyframe])
+            + containerByteSize(m_extent[keyframe])
+            + containerByteSize(m_heightRange[keyframe])
+            + containerByteSize(m_colorValue[keyframe])
+            + containerByteSize(m_rotation[keyframe]);
+    }
+
+    return result;
+}
+
+size_t CuboidKeyframeVertexCloud::orientationByteSize() const
+{
+    return 2 * verticesCount() * sizeof(float);
+}
+
+std::vector<gl::GLuint> CuboidKeyframeVertexCloud::buffers() const
+{
+    return { m_vertices };
+}
+
+void CuboidKeyframeVertexCloud::onRender()
+{
+    const auto elapsed = m_frame > m_transitionStart ? m_frame - m_transitionStart : size_t(0);
+    const auto t = m_transitionFrames > 0 ? glm::clamp(static_cast<float>(elapsed) / static_cast<float>(m_transitionFrames), 0.0f, 1.0f) : 1.0f;
+    const auto progress = t * t * (3.0f - 2.0f * t);
+
+    glBindVertexArray(m_vao);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    glUseProgram(m_program);
+
+    // The shader blends from keyframe 0 to 1; transitions into keyframe 0 run backwards
+    glUniform1f(glGetUniformLocation(m_program, "interpolation"), m_target == 1 ? progress : 1.0f - progress);
+
+    glDrawArrays(GL_POINTS, 0, size());
+
+    glUseProgram(0);
+
+    glBindVertexArray(0);
+}
+
+gl::GLuint CuboidKeyframeVertexCloud::program() const
+{
+    return m_program;
+}
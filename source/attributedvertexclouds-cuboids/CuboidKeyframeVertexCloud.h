@@ -0,0 +1,87 @@
+
+#pragma once
+
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include <glbinding/gl/types.h>
+
+#include "Cuboid.h"
+#include "CuboidImplementation.h"
+
+
+// The attributed vertex cloud with two keyframes per cuboid, blended in the vertex shader.
+// The keyframes alternate between two buffer regions: a transition writes its target state over the
+// older keyframe, so only that half of the vertex data is uploaded and the animation itself costs one uniform per frame.
+class CuboidKeyframeVertexCloud : public CuboidImplementation
+{
+public:
+    CuboidKeyframeVertexCloud();
+    ~CuboidKeyframeVertexCloud();
+
+    virtual void onInitialize() override;
+    virtual void onRender() override;
+
+    virtual bool loadShader() override;
+
+    // Sets both keyframes, so the cuboid stands still
+    virtual void setCube(size_t index, const Cuboid & cuboid) override;
+    virtual void updateBuffers() override;
+
+    // State at the end of the current transition
+    Cuboid targetCube(size_t index) const;
+
+    // Sets the state of the next transition; a running transition keeps its target until the next one starts
+    void setTargetCube(size_t index, const Cuboid & cuboid);
+
+    // Animates from the current target states to those set since over the given number of frames, starting at the
+    // given frame index; a running transition is completed at once
+    void startTransition(size_t frame, size_t frames);
+
+    // Frame index the next rendering shows, see Rendering::m_frame, so transitions replay frame by frame
+    void setFrame(size_t frame);
+
+    virtual size_t size() const override;
+    virtual size_t verticesCount() const override;
+    virtual size_t staticByteSize() const override;
+    virtual size_t byteSize() const override;
+    virtual size_t vertexByteSize() const override;
+    virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
+    virtual size_t orientationByteSize() const override;
+
+    virtual void resize(size_t count) override;
+
+    virtual std::vector<gl::GLuint> buffers() const override;
+
+    virtual gl::GLuint program() const override;
+public:
+    // Attributes of both keyframes
+    std::vector<glm::vec2> m_center[2];
+    std::vector<glm::vec2> m_extent[2];
+    std::vector<glm::vec2> m_heightRange[2];
+    std::vector<float> m_colorValue[2];
+    std::vector<float> m_rotation[2];
+
+    // Keyframe that the current transition ends in
+    size_t m_target;
+
+    size_t m_transitionStart;
+    size_t m_transitionFrames;
+    size_t m_frame;
+
+    gl::GLuint m_vertices;
+    gl::GLuint m_vao;
+
+    gl::GLuint m_vertexShader;
+    gl::GLuint m_geometryShader;
+    gl::GLuint m_fragmentShader;
+
+    gl::GLuint m_program;
+
+    void initializeVAO();
+    void uploadKeyframe(size_t keyframe);
+    size_t keyframeByteSize() const;
+    size_t verticesPerCuboid() const;
+};
@@ -0,0 +1,625 @@
+
+#include "CuboidLODVertexCloud.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec4.hpp>
+
+#include <glbinding/gl/gl.h>
+
+#include "common.h"
+#include "Trace.h"
+
+using namespace gl;
+
+
+namespace
+{
+
+
+// Octree leaves hold up to this many cuboids and are split no further
+static const auto maxCuboidsPerNode = std::uint32_t(8);
+
+// Upper bound of cuboids drawn per frame
+static const auto cutBudget = size_t(1) << 20;
+
+// Nodes projecting to fewer pixels are drawn as their merged cuboid
+static const auto minPixelThreshold = 1.0f;
+
+
+// Spreads the lower 10 bits of value to every third bit
+std::uint32_t spreadBits(std::uint32_t value)
+{
+    value &= 0x3ff;
+    value = (value | (value << 16)) & 0x030000ff;
+    value = (value | (value << 8)) & 0x0300f00f;
+    value = (value | (value << 4)) & 0x030c30c3;
+    value = (value | (value << 2)) & 0x09249249;
+
+    return value;
+}
+
+// 30-bit Morton code of a position in the unit cube
+std::uint32_t mortonCode(const glm::vec3 & position)
+{
+    const auto cell = glm::clamp(position, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f)) * 1023.0f;
+
+    return spreadBits(static_cast<std::uint32_t>(cell.x))
+        | (spreadBits(static_cast<std::uint32_t>(cell.y)) << 1)
+        | (spreadBits(static_cast<std::uint32_t>(cell.z)) << 2);
+}
+
+int highestBit(std::uint32_t value)
+{
+    auto bit = -1;
+
+    while (value != 0)
+    {
+        value >>= 1;
+        ++bit;
+    }
+
+    return bit;
+}
+
+bool outsideFrustum(const glm::vec4 * planes, const glm::vec3 & min, const glm::vec3 & max)
+{
+    for (auto i = 0; i < 6; ++i)
+    {
+        const auto & plane = planes[i];
+        const auto farthest = glm::vec3(plane.x > 0.0f ? max.x : min.x, plane.y > 0.0f ? max.y : min.y, plane.z > 0.0f ? max.z : min.z);
+
+        if (glm::dot(glm::vec3(plane), farthest) + plane.w < 0.0f)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+} // namespace
+
+
+CuboidLODVertexCloud::CuboidLODVertexCloud()
+: CuboidImplementation("Attributed Vertex Cloud (LOD)")
+, m_cuboidCount(0)
+, m_eye(0.0f, 0.0f, 0.0f)
+, m_viewProjection(1.0f)
+, m_pixelsPerUnit(1.0f)
+, m_pixelThreshold(minPixelThreshold)
+, m_vertices(0)
+, m_indices(0)
+, m_vao(0)
+, m_vertexShader(0)
+, m_geometryShader(0)
+, m_fragmentShader(0)
+{
+}
+
+CuboidLODVertexCloud::~CuboidLODVertexCloud()
+{
+    if (!initialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_vertices);
+    glDeleteBuffers(1, &m_indices);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteShader(m_vertexShader);
+    glDeleteShader(m_geometryShader);
+    glDeleteShader(m_fragmentShader);
+    glDeleteProgram(m_program);
+}
+
+void CuboidLODVertexCloud::onInitialize()
+{
+    glGenBuffers(1, &m_vertices);
+    glGenBuffers(1, &m_indices);
+    glGenVertexArrays(1, &m_vao);
+
+    initializeVAO();
+
+    m_vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    m_geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
+    m_fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+    m_program = glCreateProgram();
+
+    glAttachShader(m_program, m_vertexShader);
+    glAttachShader(m_program, m_geometryShader);
+    glAttachShader(m_program, m_fragmentShader);
+
+    loadShader();
+}
+
+void CuboidLODVertexCloud::buildHierarchy()
+{
+    // Drop the merged cuboids of an earlier build
+    m_center.resize(m_cuboidCount);
+    m_extent.resize(m_cuboidCount);
+    m_heightRange.resize(m_cuboidCount);
+    m_colorValue.resize(m_cuboidCount);
+    m_rotation.resize(m_cuboidCount);
+
+    m_order.clear();
+    m_nodeFirstCuboid.clear();
+    m_nodeCuboidCount.clear();
+    m_nodeFirstChild.clear();
+    m_nodeChildCount.clear();
+    m_nodeMin.clear();
+    m_nodeMax.clear();
+    m_nodeVertex.clear();
+
+    // Bounds of the rotated footprint
+    const auto box = [this](size_t i, glm::vec3 & min, glm::vec3 & max) {
+        const auto c = std::abs(std::cos(m_rotation[i]));
+        const auto s = std::abs(std::sin(m_rotation[i]));
+        const auto footprint = glm::vec2(c * m_extent[i].x + s * m_extent[i].y, s * m_extent[i].x + c * m_extent[i].y);
+
+        min = glm::vec3(m_center[i].x - footprint.x / 2.0f, m_heightRange[i].x, m_center[i].y - footprint.y / 2.0f);
+        max = glm::vec3(m_center[i].x + footprint.x / 2.0f, m_heightRange[i].x + std::max(m_heightRange[i].y, 0.0f), m_center[i].y + footprint.y / 2.0f);
+    };
+
+    // Cuboids without a footprint are never drawn and stay out of the hierarchy
+    auto boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    auto boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+    auto visibleCount = size_t(0);
+
+    for (auto i = size_t(0); i < m_cuboidCount; ++i)
+    {
+        if (m_extent[i].x <= 0.0f || m_extent[i].y <= 0.0f)
+        {
+            continue;
+        }
+
+        auto min = glm::vec3();
+        auto max = glm::vec3();
+        box(i, min, max);
+
+        boundsMin = glm::min(boundsMin, min);
+        boundsMax = glm::max(boundsMax, max);
+        ++visibleCount;
+    }
+
+    if (visibleCount == 0)
+    {
+        return;
+    }
+
+    const auto boundsSize = glm::max(boundsMax - boundsMin, glm::vec3(std::numeric_limits<float>::min()));
+
+    auto keys = std::vector<std::uint64_t>();
+    keys.reserve(visibleCount);
+
+    for (auto i = size_t(0); i < m_cuboidCount; ++i)
+    {
+        if (m_extent[i].x <= 0.0f || m_extent[i].y <= 0.0f)
+        {
+            continue;
+        }
+
+        auto min = glm::vec3();
+        auto max = glm::vec3();
+        box(i, min, max);
+
+        const auto code = mortonCode(((min + max) / 2.0f - boundsMin) / boundsSize);
+
+        keys.push_back((static_cast<std::uint64_t>(code) << 32) | i);
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    auto codes = std::vector<std::uint32_t>(keys.size());
+    m_order.resize(keys.size());
+
+    for (auto i = size_t(0); i < keys.size(); ++i)
+    {
+        codes[i] = static_cast<std::uint32_t>(keys[i] >> 32);
+        m_order[i] = static_cast<std::uint32_t>(keys[i]);
+    }
+
+    keys = std::vector<std::uint64_t>();
+
+    m_nodeFirstCuboid.push_back(0);
+    m_nodeCuboidCount.push_back(static_cast<std::uint32_t>(m_order.size()));
+
+    // Breadth-first; a node is split at the highest octree level at which its cuboids differ,
+    // so chains of single children are skipped
+    for (auto node = size_t(0); node < m_nodeFirstCuboid.size(); ++node)
+    {
+        const auto first = m_nodeFirstCuboid[node];
+        const auto end = first + m_nodeCuboidCount[node];
+
+        m_nodeFirstChild.push_back(static_cast<std::uint32_t>(m_nodeFirstCuboid.size()));
+        m_nodeChildCount.push_back(0);
+
+        const auto difference = codes[first] ^ codes[end - 1];
+
+        if (end - first <= maxCuboidsPerNode || difference == 0)
+        {
+            continue;
+        }
+
+        const auto shift = highestBit(difference) / 3 * 3;
+
+        for (auto begin = first; begin < end; )
+        {
+            const auto next = (codes[begin] >> shift) + 1;
+            const auto childEnd = static_cast<std::uint32_t>(std::lower_bound(codes.begin() + begin, codes.begin() + end, next << shift) - codes.begin());
+
+            m_nodeFirstCuboid.push_back(begin);
+            m_nodeCuboidCount.push_back(childEnd - begin);
+            ++m_nodeChildCount[node];
+
+            begin = childEnd;
+        }
+    }
+
+    const auto nodeCount = m_nodeFirstCuboid.size();
+
+    m_nodeMin.resize(nodeCount);
+    m_nodeMax.resize(nodeCount);
+    m_nodeVertex.resize(nodeCount);
+
+    // Children come after their parents, so a reverse pass merges bottom-up
+    for (auto node = nodeCount; node-- > 0; )
+    {
+        auto min = glm::vec3(std::numeric_limits<float>::max());
+        auto max = glm::vec3(-std::numeric_limits<float>::max());
+        auto colorSum = 0.0f;
+
+        if (m_nodeChildCount[node] == 0)
+        {
+            for (auto i = m_nodeFirstCuboid[node]; i < m_nodeFirstCuboid[node] + m_nodeCuboidCount[node]; ++i)
+            {
+                auto cuboidMin = glm::vec3();
+                auto cuboidMax = glm::vec3();
+                box(m_order[i], cuboidMin, cuboidMax);
+
+                min = glm::min(min, cuboidMin);
+                max = glm::max(max, cuboidMax);
+                colorSum += glm::clamp(m_colorValue[m_order[i]], 0.0f, 1.0f);
+            }
+        }
+        else
+        {
+            for (auto child = m_nodeFirstChild[node]; child < m_nodeFirstChild[node] + m_nodeChildCount[node]; ++child)
+            {
+                min = glm::min(min, m_nodeMin[child]);
+                max = glm::max(max, m_nodeMax[child]);
+                colorSum += glm::clamp(m_colorValue[m_nodeVertex[child]], 0.0f, 1.0f) * m_nodeCuboidCount[child];
+            }
+        }
+
+        m_nodeMin[node] = min;
+        m_nodeMax[node] = max;
+
+        if (m_nodeCuboidCount[node] == 1)
+        {
+            m_nodeVertex[node] = m_order[m_nodeFirstCuboid[node]];
+
+            continue;
+        }
+
+        m_nodeVertex[node] = static_cast<std::uint32_t>(m_center.size());
+
+        m_center.push_back(glm::vec2(min.x + max.x, min.z + max.z) / 2.0f);
+        m_extent.push_back(glm::vec2(max.x - min.x, max.z - min.z));
+        m_heightRange.push_back(glm::vec2(min.y, max.y - min.y));
+        m_colorValue.push_back(colorSum / m_nodeCuboidCount[node]);
+
+        // Merged cuboids are the axis-aligned bounds of their leaves
+        m_rotation.push_back(0.0f);
+    }
+}
+
+void CuboidLODVertexCloud::selectCut()
+{
+    TraceZone zone("CuboidLODVertexCloud::selectCut");
+
+    m_cut.clear();
+
+    if (m_nodeVertex.empty())
+    {
+        return;
+    }
+
+    // Frustum planes as sums and differences of the rows of the view projection
+    const auto & m = m_viewProjection;
+    const auto row = [&m](int i) {
+        return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    };
+
+    const glm::vec4 planes[6] = {
+        row(3) + row(0), row(3) - row(0),
+        row(3) + row(1), row(3) - row(1),
+        row(3) + row(2), row(3) - row(2)
+    };
+
+    m_stack.assign(1, 0);
+
+    // Each node on the stack yields at least one cuboid, which keeps the cut within the budget
+    while (!m_stack.empty())
+    {
+        const auto node = m_stack.back();
+        m_stack.pop_back();
+
+        const auto & min = m_nodeMin[node];
+        const auto & max = m_nodeMax[node];
+
+        if (outsideFrustum(planes, min, max))
+        {
+            continue;
+        }
+
+        if (m_nodeCuboidCount[node] == 1)
+        {
+            m_cut.push_back(m_nodeVertex[node]);
+
+            continue;
+        }
+
+        const auto radius = glm::length(max - min) / 2.0f;
+        const auto distance = glm::length((min + max) / 2.0f - m_eye);
+        const auto projectedSize = 2.0f * radius / distance * m_pixelsPerUnit;
+
+        const auto leaf = m_nodeChildCount[node] == 0;
+        const auto refinedCount = leaf ? m_nodeCuboidCount[node] : m_nodeChildCount[node];
+        const auto refine = (distance <= radius || projectedSize >= m_pixelThreshold)
+            && m_cut.size() + m_stack.size() + refinedCount <= cutBudget;
+
+        if (!refine)
+        {
+            m_cut.push_back(m_nodeVertex[node]);
+        }
+        else if (leaf)
+        {
+            for (auto i = m_nodeFirstCuboid[node]; i < m_nodeFirstCuboid[node] + m_nodeCuboidCount[node]; ++i)
+            {
+                m_cut.push_back(m_order[i]);
+            }
+        }
+        else
+        {
+            for (auto child = m_nodeFirstChild[node]; child < m_nodeFirstChild[node] + m_nodeChildCount[node]; ++child)
+            {
+                m_stack.push_back(child);
+            }
+        }
+    }
+
+    // The cut grows roughly with the inverse square of the threshold; aim at three quarters of the budget,
+    // as a cut close to the budget has been capped and is refined unevenly
+    const auto cutSize = static_cast<float>(m_cut.size());
+
+    if (m_cut.size() > cutBudget / 8 * 7 || (m_cut.size() < cutBudget / 2 && m_pixelThreshold > minPixelThreshold))
+    {
+        m_pixelThreshold = std::max(minPixelThreshold, m_pixelThreshold * std::sqrt(cutSize / (0.75f * cutBudget)));
+    }
+}
+
+void CuboidLODVertexCloud::initializeVAO()
+{
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferData(GL_ARRAY_BUFFER, verticesCount() * vertexByteSize(), nullptr, GL_STATIC_DRAW);
+
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 0, verticesCount() * sizeof(float) * 2, m_center.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 2, verticesCount() * sizeof(float) * 2, m_extent.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 4, verticesCount() * sizeof(float) * 2, m_heightRange.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 6, verticesCount() * sizeof(float) * 1, m_colorValue.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 7, verticesCount() * sizeof(float) * 1, m_rotation.data());
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 0));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 2));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 4));
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 6));
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 7));
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+    glEnableVertexAttribArray(4);
+
+    // The index buffer is refilled with the cut of each frame
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indices);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, cutBudget * sizeof(GLuint), nullptr, GL_STREAM_DRAW);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+bool CuboidLODVertexCloud::loadShader()
+{
+    const auto vertexShaderSource = loadShaderSource("/cuboids-avc/standard.vert");
+    const auto vertexShaderSource_ptr = vertexShaderSource.c_str();
+    if(vertexShaderSource_ptr)
+        glShaderSource(m_vertexShader, 1, &vertexShaderSource_ptr, 0);
+
+    glCompileShader(m_vertexShader);
+
+    bool success = checkForCompilationError(m_vertexShader, "vertex shader");
+
+
+    const auto geometryShaderSource = loadShaderSource("/cuboids-avc/standard.geom");
+    const auto geometryShaderSource_ptr = geometryShaderSource.c_str();
+    if(geometryShaderSource_ptr)
+        glShaderSource(m_geometryShader, 1, &geometryShaderSource_ptr, 0);
+
+    glCompileShader(m_geometryShader);
+
+    success &= checkForCompilationError(m_geometryShader, "geometry shader");
+
+
+    const auto fragmentShaderSource = loadShaderSource("/visualization.frag");
+    const auto fragmentShaderSource_ptr = fragmentShaderSource.c_str();
+    if(fragmentShaderSource_ptr)
+        glShaderSource(m_fragmentShader, 1, &fragmentShaderSource_ptr, 0);
+
+    glCompileShader(m_fragmentShader);
+
+    success &= checkForCompilationError(m_fragmentShader, "fragment shader");
+
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glLinkProgram(m_program);
+
+    success &= checkForLinkerError(m_program, "program");
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glBindFragDataLocation(m_program, 0, "out_color");
+
+    return true;
+}
+
+void CuboidLODVertexCloud::setCamera(const glm::vec3 & eye, const glm::mat4 & viewProjection, float pixelsPerUnit)
+{
+    m_eye = eye;
+    m_viewProjection = viewProjection;
+    m_pixelsPerUnit = pixelsPerUnit;
+}
+
+void CuboidLODVertexCloud::setCube(size_t index, const Cuboid & cuboid)
+{
+    m_center[index] = glm::vec2(cuboid.center.x, cuboid.center.z);
+    m_extent[index] = glm::vec2(cuboid.extent.x, cuboid.extent.z);
+    m_heightRange[index] = glm::vec2(cuboid.center.y - cuboid.extent.y / 2.0f, cuboid.extent.y);
+    m_colorValue[index] = cuboid.colorValue;
+    m_rotation[index] = cuboid.rotation;
+}
+
+void CuboidLODVertexCloud::finishCubes()
+{
+    buildHierarchy();
+}
+
+void CuboidLODVertexCloud::updateBuffers()
+{
+    initializeVAO();
+}
+
+size_t CuboidLODVertexCloud::size() const
+{
+    return m_cuboidCount;
+}
+
+size_t CuboidLODVertexCloud::verticesPerCuboid() const
+{
+    return 1;
+}
+
+size_t CuboidLODVertexCloud::verticesCount() const
+{
+    // Includes the merged cuboids once the hierarchy is built
+    return m_center.size();
+}
+
+size_t CuboidLODVertexCloud::staticByteSize() const
+{
+    return 0;
+}
+
+size_t CuboidLODVertexCloud::byteSize() const
+{
+    return verticesCount() * vertexByteSize() + cutBudget * sizeof(GLuint);
+}
+
+size_t CuboidLODVertexCloud::vertexByteSize() const
+{
+    return sizeof(float) * componentCount();
+}
+
+size_t CuboidLODVertexCloud::componentCount() const
+{
+    return 8;
+}
+
+void CuboidLODVertexCloud::resize(size_t count)
+{
+    m_cuboidCount = count;
+
+    m_center.resize(count);
+    m_extent.resize(count);
+    m_heightRange.resize(count);
+    m_colorValue.resize(count);
+    m_rotation.resize(count);
+}
+
+size_t CuboidLODVertexCloud::cpuByteSize() const
+{
+    return containerByteSize(m_center)
+        + containerByteSize(m_extent)
+        + containerByteSize(m_heightRange)
+        + containerByteSize(m_colorValue)
+        + containerByteSize(m_rotation)
+        + containerByteSize(m_order)
+        + containerByteSize(m_nodeMin)
+        + containerByteSize(m_nodeMax)
+        + containerByteSize(m_nodeVertex)
+        + containerByteSize(m_nodeFirstChild)
+        + containerByteSize(m_nodeChildCount)
+        + containerByteSize(m_nodeFirstCuboid)
+        + containerByteSize(m_nodeCuboidCount)
+        + containerByteSize(m_cut)
+        + containerByteSize(m_stack);
+}
+
+size_t CuboidLODVertexCloud::orientationByteSize() const
+{
+    return verticesCount() * sizeof(float);
+}
+
+std::vector<gl::GLuint> CuboidLODVertexCloud::buffers() const
+{
+    return { m_vertices, m_indices };
+}
+
+void CuboidLODVertexCloud::onRender()
+{
+    selectCut();
+
+    glBindVertexArray(m_vao);
+
+    // Orphans the previous frame's indices instead of waiting for their draw
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, cutBudget * sizeof(GLuint), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, m_cut.size() * sizeof(GLuint), m_cut.data());
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    glUseProgram(m_program);
+    glDrawElements(GL_POINTS, static_cast<GLsizei>(m_cut.size()), GL_UNSIGNED_INT, nullptr);
+
+    glUseProgram(0);
+
+    glBindVertexArray(0);
+}
+
+gl::GLuint CuboidLODVertexCloud::program() const
+{
+    return m_program;
+}
@@ -0,0 +1,96 @@
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <glbinding/gl/types.h>
+
+#include "Cuboid.h"
+#include "CuboidImplementation.h"
+
+
+// The attributed vertex cloud over an octree of the cuboids, whose inner nodes are drawn as merged bounding cuboids.
+// Each frame draws a cut through the octree: nodes are refined while they project to at least a few pixels,
+// with the pixel threshold adapting so that the cut stays within a fixed budget of cuboids.
+// Leaves and merged cuboids share one vertex buffer; only the indices of the cut are streamed per frame.
+class CuboidLODVertexCloud : public CuboidImplementation
+{
+public:
+    CuboidLODVertexCloud();
+    ~CuboidLODVertexCloud();
+
+    virtual void onInitialize() override;
+    virtual void onRender() override;
+
+    virtual bool loadShader() override;
+
+    virtual void setCamera(const glm::vec3 & eye, const glm::mat4 & viewProjection, float pixelsPerUnit) override;
+    virtual void setCube(size_t index, const Cuboid & cuboid) override;
+    virtual void finishCubes() override;
+    virtual void updateBuffers() override;
+
+    virtual size_t size() const override;
+    virtual size_t verticesCount() const override;
+    virtual size_t staticByteSize() const override;
+    virtual size_t byteSize() const override;
+    virtual size_t vertexByteSize() const override;
+    virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
+    virtual size_t orientationByteSize() const override;
+
+    virtual void resize(size_t count) override;
+
+    virtual std::vector<gl::GLuint> buffers() const override;
+
+    virtual gl::GLuint program() const override;
+public:
+    // The cuboids followed by the merged cuboids of the octree nodes
+    std::vector<glm::vec2> m_center;
+    std::vector<glm::vec2> m_extent;
+    std::vector<glm::vec2> m_heightRange;
+    std::vector<float> m_colorValue;
+    std::vector<float> m_rotation;
+
+    size_t m_cuboidCount;
+
+    // Visible cuboids in Morton order; each node covers a range of them
+    std::vector<std::uint32_t> m_order;
+
+    // Octree nodes in breadth-first order, so the children of a node are consecutive
+    std::vector<glm::vec3> m_nodeMin;
+    std::vector<glm::vec3> m_nodeMax;
+    std::vector<std::uint32_t> m_nodeVertex;
+    std::vector<std::uint32_t> m_nodeFirstChild;
+    std::vector<std::uint32_t> m_nodeChildCount;
+    std::vector<std::uint32_t> m_nodeFirstCuboid;
+    std::vector<std::uint32_t> m_nodeCuboidCount;
+
+    glm::vec3 m_eye;
+    glm::mat4 m_viewProjection;
+    float m_pixelsPerUnit;
+    float m_pixelThreshold;
+
+    std::vector<gl::GLuint> m_cut;
+    std::vector<std::uint32_t> m_stack;
+
+    gl::GLuint m_vertices;
+    gl::GLuint m_indices;
+    gl::GLuint m_vao;
+
+    gl::GLuint m_vertexShader;
+    gl::GLuint m_geometryShader;
+    gl::GLuint m_fragmentShader;
+
+    gl::GLuint m_program;
+
+    void buildHierarchy();
+    void selectCut();
+
+    void initializeVAO();
+    size_t verticesPerCuboid() const;
+};
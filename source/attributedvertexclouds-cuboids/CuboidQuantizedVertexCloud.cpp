@@ -0,0 +1,367 @@
+
+#include "CuboidQuantizedVertexCloud.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/common.hpp>
+#include <glm/exponential.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <glbinding/gl/gl.h>
+
+#include "common.h"
+
+#include "CuboidVertexCloud.h"
+
+using namespace gl;
+
+
+namespace
+{
+
+
+// Smallest range of the extents in cells; generated cuboids fill at most one cell
+static const auto maxExtentCells = 2.0f;
+
+static const auto unormMax = 65535.0f;
+
+static const auto fullTurn = glm::two_pi<float>();
+
+
+std::uint16_t quantize(float value)
+{
+    return static_cast<std::uint16_t>(std::floor(glm::clamp(value, 0.0f, 1.0f) * unormMax + 0.5f));
+}
+
+float dequantize(std::uint16_t value)
+{
+    return static_cast<float>(value) / unormMax;
+}
+
+// Rotations are stored as fractions of a full turn
+float turns(float rotation)
+{
+    const auto value = rotation / fullTurn;
+
+    return value - std::floor(value);
+}
+
+// Angle between two rotations, as a cuboid looks the same after a full turn
+float rotationDifference(float a, float b)
+{
+    const auto difference = turns(a - b);
+
+    return std::min(difference, 1.0f - difference) * fullTurn;
+}
+
+
+} // namespace
+
+
+CuboidQuantizationError::CuboidQuantizationError()
+: center(0.0f)
+, extent(0.0f)
+, height(0.0f)
+, colorValue(0.0f)
+, rotation(0.0f)
+, cellSize(0.0f)
+{
+}
+
+
+CuboidQuantizedVertexCloud::CuboidQuantizedVertexCloud()
+: CuboidImplementation("Quantized Attributed Vertex Cloud")
+, m_origin(-1.0f, -1.0f, -1.0f)
+, m_positionScale(2.0f, 2.0f, 2.0f)
+, m_extentScale(maxExtentCells, maxExtentCells, maxExtentCells)
+, m_cellSize(1.0f, 1.0f, 1.0f)
+, m_vertices(0)
+, m_vao(0)
+, m_vertexShader(0)
+, m_geometryShader(0)
+, m_fragmentShader(0)
+{
+}
+
+CuboidQuantizedVertexCloud::~CuboidQuantizedVertexCloud()
+{
+    if (!initialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_vertices);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteShader(m_vertexShader);
+    glDeleteShader(m_geometryShader);
+    glDeleteShader(m_fragmentShader);
+    glDeleteProgram(m_program);
+}
+
+void CuboidQuantizedVertexCloud::onInitialize()
+{
+    glGenBuffers(1, &m_vertices);
+    glGenVertexArrays(1, &m_vao);
+
+    initializeVAO();
+
+    m_vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    m_geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
+    m_fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+    m_program = glCreateProgram();
+
+    glAttachShader(m_program, m_vertexShader);
+    glAttachShader(m_program, m_geometryShader);
+    glAttachShader(m_program, m_fragmentShader);
+
+    loadShader();
+}
+
+void CuboidQuantizedVertexCloud::initializeVAO()
+{
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
+    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_STATIC_DRAW);
+
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(std::uint16_t) * 0, verticesCount() * sizeof(std::uint16_t) * 2, m_center.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(std::uint16_t) * 2, verticesCount() * sizeof(std::uint16_t) * 2, m_extent.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(std::uint16_t) * 4, verticesCount() * sizeof(std::uint16_t) * 2, m_heightRange.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(std::uint16_t) * 6, verticesCount() * sizeof(std::uint16_t) * 1, m_colorValue.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(std::uint16_t) * 7, verticesCount() * sizeof(std::uint16_t) * 1, m_rotation.data());
+
+    glVertexAttribPointer(0, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(glm::u16vec2), reinterpret_cast<void*>(verticesCount() * sizeof(std::uint16_t) * 0));
+    glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(glm::u16vec2), reinterpret_cast<void*>(verticesCount() * sizeof(std::uint16_t) * 2));
+    glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(glm::u16vec2), reinterpret_cast<void*>(verticesCount() * sizeof(std::uint16_t) * 4));
+    glVertexAttribPointer(3, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(std::uint16_t), reinterpret_cast<void*>(verticesCount() * sizeof(std::uint16_t) * 6));
+    glVertexAttribPointer(4, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(std::uint16_t), reinterpret_cast<void*>(verticesCount() * sizeof(std::uint16_t) * 7));
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+    glEnableVertexAttribArray(4);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool CuboidQuantizedVertexCloud::loadShader()
+{
+    const auto vertexShaderSource = loadShaderSource("/cuboids-avc/quantized.vert");
+    const auto vertexShaderSource_ptr = vertexShaderSource.c_str();
+    if(vertexShaderSource_ptr)
+        glShaderSource(m_vertexShader, 1, &vertexShaderSource_ptr, 0);
+
+    glCompileShader(m_vertexShader);
+
+    bool success = checkForCompilationError(m_vertexShader, "vertex shader");
+
+
+    const auto geometryShaderSource = loadShaderSource("/cuboids-avc/standard.geom");
+    const auto geometryShaderSource_ptr = geometryShaderSource.c_str();
+    if(geometryShaderSource_ptr)
+        glShaderSource(m_geometryShader, 1, &geometryShaderSource_ptr, 0);
+
+    glCompileShader(m_geometryShader);
+
+    success &= checkForCompilationError(m_geometryShader, "geometry shader");
+
+
+    const auto fragmentShaderSource = loadShaderSource("/visualization.frag");
+    const auto fragmentShaderSource_ptr = fragmentShaderSource.c_str();
+    if(fragmentShaderSource_ptr)
+        glShaderSource(m_fragmentShader, 1, &fragmentShaderSource_ptr, 0);
+
+    glCompileShader(m_fragmentShader);
+
+    success &= checkForCompilationError(m_fragmentShader, "fragment shader");
+
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glLinkProgram(m_program);
+
+    success &= checkForLinkerError(m_program, "program");
+
+    if (!success)
+    {
+        return false;
+    }
+
+    glBindFragDataLocation(m_program, 0, "out_color");
+
+    return true;
+}
+
+void CuboidQuantizedVertexCloud::setGrid(const glm::vec3 & origin, const glm::vec3 & cellSize, const glm::ivec3 & cellCount)
+{
+    // One cell of margin on each side, as offsets and extents reach out of the grid
+    m_origin = origin - cellSize;
+    m_positionScale = cellSize * (glm::vec3(cellCount) + glm::vec3(2.0f, 2.0f, 2.0f));
+    // Extents may span the whole grid, as the platforms of a treemap cover many cells of its leaves
+    m_extentScale = cellSize * glm::max(glm::vec3(cellCount), glm::vec3(maxExtentCells));
+    m_cellSize = cellSize;
+}
+
+void CuboidQuantizedVertexCloud::setCube(size_t index, const Cuboid & cuboid)
+{
+    const auto position = (cuboid.center - m_origin) / m_positionScale;
+    // Square roots keep the relative precision of small extents within the range of the whole grid
+    const auto extent = glm::sqrt(glm::max(cuboid.extent, 0.0f) / m_extentScale);
+    const auto bottom = (cuboid.center.y - cuboid.extent.y / 2.0f - m_origin.y) / m_positionScale.y;
+
+    m_center[index] = glm::u16vec2(quantize(position.x), quantize(position.z));
+    m_extent[index] = glm::u16vec2(quantize(extent.x), quantize(extent.z));
+    m_heightRange[index] = glm::u16vec2(quantize(bottom), quantize(extent.y));
+    m_colorValue[index] = quantize(cuboid.colorValue);
+
+    // A full turn wraps around to zero
+    m_rotation[index] = static_cast<std::uint16_t>(static_cast<std::uint32_t>(quantize(turns(cuboid.rotation))) % 65535u);
+}
+
+Cuboid CuboidQuantizedVertexCloud::cube(size_t index) const
+{
+    auto cuboid = Cuboid();
+
+    const auto extent = glm::vec3(dequantize(m_extent[index].x), dequantize(m_heightRange[index].y), dequantize(m_extent[index].y));
+
+    cuboid.extent = extent * extent * m_extentScale;
+    cuboid.center = m_origin + glm::vec3(dequantize(m_center[index].x), dequantize(m_heightRange[index].x), dequantize(m_center[index].y)) * m_positionScale;
+    cuboid.center.y += cuboid.extent.y / 2.0f;
+    cuboid.colorValue = dequantize(m_colorValue[index]);
+    cuboid.rotation = dequantize(m_rotation[index]) * fullTurn;
+
+    return cuboid;
+}
+
+CuboidQuantizationError CuboidQuantizedVertexCloud::error(const CuboidVertexCloud & reference) const
+{
+    auto result = CuboidQuantizationError();
+    result.cellSize = std::min(m_cellSize.x, std::min(m_cellSize.y, m_cellSize.z));
+
+    const auto count = std::min(size(), reference.size());
+
+    for (auto i = size_t(0); i < count; ++i)
+    {
+        const auto decoded = cube(i);
+        const auto bottom = decoded.center.y - decoded.extent.y / 2.0f;
+
+        result.center = std::max(result.center, std::abs(decoded.center.x - reference.m_center[i].x));
+        result.center = std::max(result.center, std::abs(decoded.center.z - reference.m_center[i].y));
+        result.center = std::max(result.center, std::abs(bottom - reference.m_heightRange[i].x));
+
+        // Non-positive extents hide a cuboid and the gradient lookup clamps, so these compare as clamped
+        result.extent = std::max(result.extent, std::abs(decoded.extent.x - std::max(reference.m_extent[i].x, 0.0f)));
+        result.extent = std::max(result.extent, std::abs(decoded.extent.z - std::max(reference.m_extent[i].y, 0.0f)));
+        result.height = std::max(result.height, std::abs(decoded.extent.y - std::max(reference.m_heightRange[i].y, 0.0f)));
+        result.colorValue = std::max(result.colorValue, std::abs(decoded.colorValue - glm::clamp(reference.m_colorValue[i], 0.0f, 1.0f)));
+        result.rotation = std::max(result.rotation, rotationDifference(decoded.rotation, reference.m_rotation[i]));
+    }
+
+    return result;
+}
+
+void CuboidQuantizedVertexCloud::updateBuffers()
+{
+    initializeVAO();
+}
+
+size_t CuboidQuantizedVertexCloud::size() const
+{
+    return m_center.size();
+}
+
+size_t CuboidQuantizedVertexCloud::verticesPerCuboid() const
+{
+    return 1;
+}
+
+size_t CuboidQuantizedVertexCloud::verticesCount() const
+{
+    return size() * verticesPerCuboid();
+}
+
+size_t CuboidQuantizedVertexCloud::staticByteSize() const
+{
+    return 0;
+}
+
+size_t CuboidQuantizedVertexCloud::byteSize() const
+{
+    return verticesPerCuboid() * size() * vertexByteSize();
+}
+
+size_t CuboidQuantizedVertexCloud::vertexByteSize() const
+{
+    return sizeof(std::uint16_t) * componentCount();
+}
+
+size_t CuboidQuantizedVertexCloud::componentCount() const
+{
+    return 8;
+}
+
+void CuboidQuantizedVertexCloud::resize(size_t count)
+{
+    m_center.resize(count);
+    m_extent.resize(count);
+    m_heightRange.resize(count);
+    m_colorValue.resize(count);
+    m_rotation.resize(count);
+}
+
+size_t CuboidQuantizedVertexCloud::cpuByteSize() const
+{
+    return containerByteSize(m_center)
+        + containerByteSize(m_extent)
+        + containerByteSize(m_heightRange)
+        + containerByteSize(m_colorValue)
+        + containerByteSize(m_rotation);
+}
+
+size_t CuboidQuantizedVertexCloud::orientationByteSize() const
+{
+    return verticesCount() * sizeof(std::uint16_t);
+}
+
+std::vector<gl::GLuint> CuboidQuantizedVertexCloud::buffers() const
+{
+    return { m_vertices };
+}
+
+void CuboidQuantizedVertexCloud::onRender()
+{
+    glBindVertexArray(m_vao);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    glUseProgram(m_program);
+
+    glUniform3f(glGetUniformLocation(m_program, "origin"), m_origin.x, m_origin.y, m_origin.z);
+    glUniform3f(glGetUniformLocation(m_program, "positionScale"), m_positionScale.x, m_positionScale.y, m_positionScale.z);
+    glUniform3f(glGetUniformLocation(m_program, "extentScale"), m_extentScale.x, m_extentScale.y, m_extentScale.z);
+
+    glDrawArrays(GL_POINTS, 0, size());
+
+    glUseProgram(0);
+
+    glBindVertexArray(0);
+}
+
+gl::GLuint CuboidQuantizedVertexCloud::program() const
+{
+    return m_program;
+}
@@ -0,0 +1,96 @@
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+#include <glbinding/gl/types.h>
+
+#include "Cuboid.h"
+#include "CuboidImplementation.h"
+
+
+class CuboidVertexCloud;
+
+
+// Largest deviation of the quantized attributes from the float layout, in world units
+class CuboidQuantizationError
+{
+public:
+    CuboidQuantizationError();
+
+    float center;
+    float extent;
+    float height;
+    float colorValue;
+    float rotation;
+
+    // Smallest cell edge, to relate the errors to
+    float cellSize;
+};
+
+
+// The attributed vertex cloud with all attributes as normalized 16-bit integers (16 instead of 32 bytes per cuboid).
+// Positions are relative to the generation grid, extents are square roots relative to the grid size.
+class CuboidQuantizedVertexCloud : public CuboidImplementation
+{
+public:
+    CuboidQuantizedVertexCloud();
+    ~CuboidQuantizedVertexCloud();
+
+    virtual void onInitialize() override;
+    virtual void onRender() override;
+
+    virtual bool loadShader() override;
+
+    virtual void setGrid(const glm::vec3 & origin, const glm::vec3 & cellSize, const glm::ivec3 & cellCount) override;
+    virtual void setCube(size_t index, const Cuboid & cuboid) override;
+    virtual void updateBuffers() override;
+
+    // Decodes the quantized attributes
+    Cuboid cube(size_t index) const;
+
+    CuboidQuantizationError error(const CuboidVertexCloud & reference) const;
+
+    virtual size_t size() const override;
+    virtual size_t verticesCount() const override;
+    virtual size_t staticByteSize() const override;
+    virtual size_t byteSize() const override;
+    virtual size_t vertexByteSize() const override;
+    virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
+    virtual size_t orientationByteSize() const override;
+
+    virtual void resize(size_t count) override;
+
+    virtual std::vector<gl::GLuint> buffers() const override;
+
+    virtual gl::GLuint program() const override;
+public:
+    std::vector<glm::u16vec2> m_center;
+    std::vector<glm::u16vec2> m_extent;
+    std::vector<glm::u16vec2> m_heightRange;
+    std::vector<std::uint16_t> m_colorValue;
+    std::vector<std::uint16_t> m_rotation;
+
+    // World space ranges of the normalized positions and extents
+    glm::vec3 m_origin;
+    glm::vec3 m_positionScale;
+    glm::vec3 m_extentScale;
+    glm::vec3 m_cellSize;
+
+    gl::GLuint m_vertices;
+    gl::GLuint m_vao;
+
+    gl::GLuint m_vertexShader;
+    gl::GLuint m_geometryShader;
+    gl::GLuint m_fragmentShader;
+
+    gl::GLuint m_program;
+
+    void initializeVAO();
+    size_t verticesPerCuboid() const;
+};
@@ -4,18 +4,26 @@
 #include <iostream>
 #include <chrono>
 #include <algorithm>
+#include <array>
 
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/random.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include <glbinding/gl/gl.h>
 
 #include "common.h"
+#include "PrimitiveGrid.h"
+#include "Trace.h"
 
 #include "CuboidVertexCloud.h"
+#include "CuboidQuantizedVertexCloud.h"
 #include "CuboidTriangles.h"
 #include "CuboidTriangleStrip.h"
 #include "CuboidInstancing.h"
+#include "CuboidIndexedTriangles.h"
+#include "CuboidKeyframeVertexCloud.h"
+#include "CuboidLODVertexCloud.h"
 
 
 using namespace gl;
@@ -27,11 +35,57 @@ namespace
 
 static const auto gridOffset = 0.2f;
 
+// Cuboids generated per call of setCubes; small enough to stay in the L1 cache
+static const size_t cuboidBatchSize = 256;
+
+// One second at the frame rate of the camera path
+static const auto transitionFrames = size_t(60);
+
+// Seed of the random yaw of oriented cuboids
+static const auto orientationSeed = size_t(0);
+
 static const auto lightGray = glm::vec3(200) / 255.0f;
 static const auto red = glm::vec3(196, 30, 20) / 255.0f;
 static const auto orange = glm::vec3(255, 114, 70) / 255.0f;
 static const auto yellow = glm::vec3(255, 200, 107) / 255.0f;
 
+// Techniques of createImplementation() that the demo drives beyond rendering
+static const auto vertexCloudIndex = size_t(3);
+static const auto quantizedVertexCloudIndex = size_t(6);
+static const auto keyframeVertexCloudIndex = size_t(9);
+
+
+// Generates the cuboids in batches and passes each batch to all implementations
+template <typename Generator>
+void setCuboids(size_t cuboidCount, const std::vector<Implementation *> & implementations, Generator generator)
+{
+    const auto batchCount = (cuboidCount + cuboidBatchSize - 1) / cuboidBatchSize;
+
+#pragma omp parallel for
+    for (size_t batch = 0; batch < batchCount; ++batch)
+    {
+        const auto first = batch * cuboidBatchSize;
+        const auto count = std::min(cuboidBatchSize, cuboidCount - first);
+
+        std::array<Cuboid, cuboidBatchSize> cuboids;
+
+        for (auto j = size_t(0); j < count; ++j)
+        {
+            cuboids[j] = generator(first + j);
+        }
+
+        for (auto implementation : implementations)
+        {
+            static_cast<CuboidImplementation*>(implementation)->setCubes(first, cuboids.data(), count);
+        }
+    }
+
+    for (auto implementation : implementations)
+    {
+        static_cast<CuboidImplementation*>(implementation)->finishCubes();
+    }
+}
+
 
 } // namespace
 
@@ -39,6 +93,12 @@ static const auto yellow = glm::vec3(255, 200, 107) / 255.0f;
 CuboidRendering::CuboidRendering()
 : Rendering("Cuboids")
 , m_gradientTexture(0)
+, m_vertexCloud(nullptr)
+, m_quantizedVertexCloud(nullptr)
+, m_keyframeVertexCloud(nullptr)
+, m_transitionCount(0)
+, m_squarified(true)
+, m_oriented(false)
 {
 }
 
@@ -46,12 +106,36 @@ CuboidRendering::~CuboidRendering()
 {
 }
 
+Implementation * CuboidRendering::createImplementation(size_t index)
+{
+    switch (index)
+    {
+    case 0: return new CuboidTriangles;
+    case 1: return new CuboidTriangleStrip(StripDrawMode::MultiDraw);
+    case 2: return new CuboidInstancing;
+    case vertexCloudIndex: return new CuboidVertexCloud(false);
+    case 4: return new CuboidIndexedTriangles(false);
+    case 5: return new CuboidIndexedTriangles(true);
+    case quantizedVertexCloudIndex: return new CuboidQuantizedVertexCloud;
+    case 7: return new CuboidVertexCloud(true);
+    case 8: return new CuboidLODVertexCloud;
+    case keyframeVertexCloudIndex: return new CuboidKeyframeVertexCloud;
+    case 10: return new CuboidTriangleStrip(StripDrawMode::PrimitiveRestart);
+    case 11: return new CuboidTriangleStrip(StripDrawMode::Degenerate);
+    default: return nullptr;
+    }
+}
+
 void CuboidRendering::onInitialize()
 {
-    addImplementation(new CuboidTriangles);
-    addImplementation(new CuboidTriangleStrip);
-    addImplementation(new CuboidInstancing);
-    addImplementation(new CuboidVertexCloud);
+    for (auto index = size_t(0); auto implementation = createImplementation(index); ++index)
+    {
+        addImplementation(implementation);
+    }
+
+    m_vertexCloud = static_cast<CuboidVertexCloud*>(m_implementations[vertexCloudIndex]);
+    m_quantizedVertexCloud = static_cast<CuboidQuantizedVertexCloud*>(m_implementations[quantizedVertexCloudIndex]);
+    m_keyframeVertexCloud = static_cast<CuboidKeyframeVertexCloud*>(m_implementations[keyframeVertexCloudIndex]);
 
     glGenTextures(1, &m_gradientTexture);
 
@@ -74,49 +158,220 @@ void CuboidRendering::onInitialize()
 void CuboidRendering::onDeinitialize()
 {
     glDeleteTextures(1, &m_gradientTexture);
+
+    m_outdated.clear();
 }
 
 void CuboidRendering::onCreateGeometry()
 {
-    const auto cuboidGridSize = static_cast<std::size_t>(m_gridSize);
-    const auto cuboidCount = static_cast<std::size_t>(cuboidGridSize * cuboidGridSize * cuboidGridSize);
-    const auto worldScale = glm::vec3(1.0f) / glm::vec3(cuboidGridSize, cuboidGridSize, cuboidGridSize);
-
-    for (auto implementation : m_implementations)
+    if (!m_treemap.empty())
     {
-        implementation->resize(cuboidCount);
+        m_primitiveCount = m_treemap.size();
+
+        createTreemapGeometry();
+
+        m_outdated.clear();
+
+        return;
     }
 
-    std::array<std::vector<float>, 4> noise;
-    for (auto i = size_t(0); i < noise.size(); ++i)
+    createGeometry(m_primitiveCount, geometryImplementations(), m_oriented);
+}
+
+void CuboidRendering::createGeometry(size_t cuboidCount, const std::vector<Implementation *> & implementations, bool oriented)
+{
+    auto grid = PrimitiveGrid(cuboidCount);
+    const auto worldScale = glm::vec3(1.0f) / glm::vec3(grid.size());
+
+    for (auto implementation : implementations)
     {
-        noise[i] = loadNoise("/noise-"+std::to_string(cuboidGridSize)+"-"+std::to_string(i)+".raw");
+        implementation->resize(cuboidCount);
+        static_cast<CuboidImplementation*>(implementation)->setGrid(glm::vec3(-0.5f, -0.5f, -0.5f), worldScale, grid.size());
     }
 
-#pragma omp parallel for
-    for (size_t i = 0; i < cuboidCount; ++i)
-    {
-        const auto position = glm::ivec3(i % cuboidGridSize, (i / cuboidGridSize) % cuboidGridSize, i / cuboidGridSize / cuboidGridSize);
+    grid.loadNoise(4);
+
+    setCuboids(cuboidCount, implementations, [&grid, &worldScale, oriented](size_t i) {
+        const auto position = grid.position(i);
         const auto offset = glm::vec3(
             (position.y + position.z) % 2 ? gridOffset : 0.0f,
             (position.x + position.z) % 2 ? gridOffset : 0.0f,
             (position.x + position.y) % 2 ? gridOffset : 0.0f
         );
 
-        Cuboid c;
+        auto c = Cuboid();
         c.center = glm::vec3(-0.5f, -0.5f, -0.5f) + (glm::vec3(position) + offset) * worldScale;
-        c.extent = glm::mix(glm::vec3(0.2f, 0.2f, 0.2f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(noise[0][i], noise[1][i], noise[2][i])) * worldScale;
-        c.colorValue = glm::mix(0.0f, 1.0f, noise[3][i]);
+        c.extent = glm::mix(glm::vec3(0.2f, 0.2f, 0.2f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(grid.noise(0, i), grid.noise(1, i), grid.noise(2, i))) * worldScale;
+        c.colorValue = glm::mix(0.0f, 1.0f, grid.noise(3, i));
+        c.rotation = oriented ? hashValue(i, orientationSeed) * glm::two_pi<float>() : 0.0f;
 
-        for (auto implementation : m_implementations)
-        {
-            static_cast<CuboidImplementation*>(implementation)->setCube(i, c);
-        }
+        return c;
+    });
+}
+
+bool CuboidRendering::loadTreemap(const std::string & filename)
+{
+    return m_treemap.load(filename);
+}
+
+size_t CuboidRendering::treemapSize() const
+{
+    return m_treemap.size();
+}
+
+void CuboidRendering::toggleTreemapLayout()
+{
+    if (m_treemap.empty())
+    {
+        return;
+    }
+
+    m_squarified = !m_squarified;
+
+    record("treemapLayout", m_squarified);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    m_treemap.layout(m_squarified);
+
+    const auto layoutEnd = std::chrono::high_resolution_clock::now();
+
+    // The node count and the quantization grid stay the same, so the arrays and buffers are reused; only the
+    // current technique is filled and uploaded right away
+    m_outdated.insert(m_implementations.begin(), m_implementations.end());
+
+    updateOutdated();
+
+    glFinish();
+
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << (m_squarified ? "Squarified" : "Slice-and-dice") << " layout of " << m_treemap.size() << " nodes took "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(layoutEnd - start).count() << "ms, "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms including the upload for "
+        << m_current->name() << std::endl;
+}
+
+void CuboidRendering::toggleOrientation()
+{
+    if (!m_treemap.empty())
+    {
+        return;
     }
+
+    m_oriented = !m_oriented;
+
+    record("orientation", m_oriented);
+
+    recreateGeometry();
+
+    std::cout << (m_oriented ? "Oriented" : "Axis-aligned") << " cuboids" << std::endl;
+}
+
+void CuboidRendering::startTransition()
+{
+    if (m_keyframeVertexCloud == nullptr)
+    {
+        return;
+    }
+
+    const auto seed = ++m_transitionCount;
+
+    // The seed is replayed along with the transition
+    record("transition", static_cast<int>(seed));
+
+    const auto count = m_keyframeVertexCloud->size();
+
+    // Footprints stay, heights scale with the footprint and colors are redrawn
+#pragma omp parallel for
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto cuboid = m_keyframeVertexCloud->targetCube(i);
+
+        const auto bottom = cuboid.center.y - cuboid.extent.y / 2.0f;
+
+        cuboid.extent.y = glm::max(cuboid.extent.x, cuboid.extent.z) * glm::mix(0.2f, 1.0f, hashValue(2 * i, seed));
+        cuboid.center.y = bottom + cuboid.extent.y / 2.0f;
+        cuboid.colorValue = hashValue(2 * i + 1, seed);
+
+        m_keyframeVertexCloud->setTargetCube(i, cuboid);
+    }
+
+    m_keyframeVertexCloud->startTransition(m_frame, transitionFrames);
+
+    std::cout << "Transition " << m_transitionCount << " of " << m_keyframeVertexCloud->name() << std::endl;
+}
+
+void CuboidRendering::createTreemapGeometry()
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    m_treemap.layout(m_squarified);
+
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << (m_squarified ? "Squarified" : "Slice-and-dice") << " layout of " << m_treemap.size() << " nodes took "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+
+    // The treemap fills the unit square; cells of about the size of a leaf keep small leaves apart in the quantization
+    const auto grid = PrimitiveGrid(m_treemap.leafCount(), 2);
+    const auto cellCount = glm::ivec3(grid.size().x, 1, grid.size().y);
+    const auto implementations = geometryImplementations();
+
+    for (auto implementation : implementations)
+    {
+        implementation->resize(m_treemap.size());
+        static_cast<CuboidImplementation*>(implementation)->setGrid(glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(1.0f) / glm::vec3(cellCount), cellCount);
+    }
+
+    setTreemapCuboids(implementations);
+}
+
+void CuboidRendering::setTreemapCuboids(const std::vector<Implementation *> & implementations)
+{
+    const auto & treemap = m_treemap;
+
+    setCuboids(m_treemap.size(), implementations, [&treemap](size_t i) {
+        return treemap.cuboid(i);
+    });
+}
+
+void CuboidRendering::updateOutdated()
+{
+    if (m_outdated.count(m_current) == 0)
+    {
+        return;
+    }
+
+    TraceZone zone("CuboidRendering::refill", m_current->name());
+
+    setTreemapCuboids(std::vector<Implementation *>(1, m_current));
+
+    // Uninitialized techniques upload the new layout on initialization
+    if (m_current->initialized())
+    {
+        static_cast<CuboidImplementation*>(m_current)->updateBuffers();
+    }
+
+    m_outdated.erase(m_current);
 }
 
 void CuboidRendering::onPrepareRendering()
 {
+    updateOutdated();
+
+    auto eye = glm::vec3(0.0f, 0.0f, 0.0f);
+    auto viewProjection = glm::mat4(1.0f);
+
+    camera(eye, viewProjection);
+
+    static_cast<CuboidImplementation*>(m_current)->setCamera(eye, viewProjection, pixelsPerUnit());
+
+    if (m_keyframeVertexCloud != nullptr)
+    {
+        m_keyframeVertexCloud->setFrame(m_frame);
+    }
+
     GLuint program = m_current->program();
     const auto gradientSamplerLocation = glGetUniformLocation(program, "gradient");
     glUseProgram(program);
@@ -131,3 +386,67 @@ void CuboidRendering::onFinalizeRendering()
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_1D, 0);
 }
+
+void CuboidRendering::onSpaceMeasurement()
+{
+    const auto error = m_quantizedVertexCloud->error(*m_vertexCloud);
+    const auto relative = [&error](float value) {
+        return value / error.cellSize * 100.0f;
+    };
+
+    std::cout << std::endl << "Quantization error against " << m_vertexCloud->name() << " (maximum, % of a cell)" << std::endl
+        << "  center " << error.center << " (" << relative(error.center) << "%)" << std::endl
+        << "  extent " << error.extent << " (" << relative(error.extent) << "%)" << std::endl
+        << "  height " << error.height << " (" << relative(error.height) << "%)" << std::endl
+        << "  color value " << error.colorValue << std::endl
+        << "  rotation " << error.rotation << " rad" << std::endl;
+
+    // Triangle techniques bake the rotation into their vertices and spend no memory on it
+    std::cout << std::endl << "Orientation (rotation attribute, % of estimated size)" << std::endl;
+
+    for (const auto implementation : m_implementations)
+    {
+        const auto byteSize = static_cast<CuboidImplementation*>(implementation)->orientationByteSize();
+        const auto fullByteSize = implementation->fullByteSize();
+
+        std::cout << "  " << implementation->name() << " " << (byteSize / 1024) << "kB ("
+            << (fullByteSize > 0 ? 100.0f * byteSize / fullByteSize : 0.0f) << "%)" << std::endl;
+    }
+}
+
+void CuboidRendering::onStartRecording()
+{
+    record("treemapLayout", m_squarified);
+    record("orientation", m_oriented);
+}
+
+bool CuboidRendering::onReplay(const InteractionEvent & event)
+{
+    if (event.command == "treemapLayout")
+    {
+        if (m_squarified != (event.value != 0))
+        {
+            toggleTreemapLayout();
+        }
+    }
+    else if (event.command == "orientation")
+    {
+        if (m_oriented != (event.value != 0))
+        {
+            toggleOrientation();
+        }
+    }
+    else if (event.command == "transition")
+    {
+        // Continues with the recorded seed
+        m_transitionCount = static_cast<size_t>(std::max(event.value, 1) - 1);
+
+        startTransition();
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
@@ -1,8 +1,19 @@
 
+#pragma once
+
+#include <set>
+
 #include <glbinding/gl/types.h>
 
 #include "Rendering.h"
 
+#include "Treemap.h"
+
+
+class CuboidVertexCloud;
+class CuboidQuantizedVertexCloud;
+class CuboidKeyframeVertexCloud;
+
 
 class CuboidRendering : public Rendering
 {
@@ -10,12 +21,51 @@ public:
     CuboidRendering();
     virtual ~CuboidRendering();
 
+    // Fills the implementations with the given number of cuboids on a grid; needs no GL context
+    // With oriented, each cuboid is turned by a random yaw
+    static void createGeometry(size_t primitiveCount, const std::vector<Implementation *> & implementations, bool oriented = false);
+
+    // Creates the technique at the given position of the demo's list, or nullptr past its end; needs no GL context
+    static Implementation * createImplementation(size_t index);
+
+    // Replaces the grid by one cuboid per node of the hierarchy in the file
+    bool loadTreemap(const std::string & filename);
+    size_t treemapSize() const;
+
+    // Switches between the squarified and the slice-and-dice treemap layout
+    void toggleTreemapLayout();
+
+    // Animates the keyframe technique to new heights and color values
+    void startTransition();
+
+    // Switches the grid between axis-aligned and randomly rotated cuboids
+    void toggleOrientation();
+
 protected:
     gl::GLuint m_gradientTexture;
 
+    CuboidVertexCloud * m_vertexCloud;
+    CuboidQuantizedVertexCloud * m_quantizedVertexCloud;
+    CuboidKeyframeVertexCloud * m_keyframeVertexCloud;
+    size_t m_transitionCount;
+
+    Treemap m_treemap;
+    bool m_squarified;
+    bool m_oriented;
+
+    // Techniques that still hold the previous treemap layout; each is refilled once it is rendered again
+    std::set<Implementation *> m_outdated;
+
     virtual void onInitialize() override;
     virtual void onDeinitialize() override;
     virtual void onCreateGeometry() override;
     virtual void onPrepareRendering() override;
     virtual void onFinalizeRendering() override;
+    virtual void onSpaceMeasurement() override;
+    virtual void onStartRecording() override;
+    virtual bool onReplay(const InteractionEvent & event) override;
+
+    void createTreemapGeometry();
+    void setTreemapCuboids(const std::vector<Implementation *> & implementations);
+    void updateOutdated();
 };
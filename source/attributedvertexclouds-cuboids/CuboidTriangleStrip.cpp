@@ -2,15 +2,74 @@
 #include "CuboidTriangleStrip.h"
 
 #include <algorithm>
+#include <array>
 
 #include <glbinding/gl/gl.h>
 
 #include "common.h"
 
+#include "CuboidExpansion.h"
+
 using namespace gl;
 
-CuboidTriangleStrip::CuboidTriangleStrip()
-: CuboidImplementation("Triangle Strip")
+
+namespace
+{
+
+
+// Corner and normal of each strip vertex, for a unit cube around the origin
+std::array<glm::vec3, 14> unitCubeVertices()
+{
+    static const glm::vec3 corners[8] = {
+        glm::vec3(-0.5f, 0.5f, -0.5f), // A = H
+        glm::vec3(-0.5f, 0.5f, 0.5f), // B = F
+        glm::vec3(0.5f, 0.5f, -0.5f), // C = J
+        glm::vec3(0.5f, 0.5f, 0.5f), // D
+        glm::vec3(0.5f, -0.5f, 0.5f), // E = L
+        glm::vec3(-0.5f, -0.5f, 0.5f), // G
+        glm::vec3(-0.5f, -0.5f, -0.5f), // I
+        glm::vec3(0.5f, -0.5f, -0.5f) // K
+    };
+
+    static const size_t indices[14] = { 0, 1, 2, 3, 4, 1, 5, 0, 6, 2, 7, 4, 6, 5 };
+
+    auto vertices = std::array<glm::vec3, 14>();
+
+    for (auto i = size_t(0); i < vertices.size(); ++i)
+    {
+        vertices[i] = corners[indices[i]];
+    }
+
+    return vertices;
+}
+
+std::array<glm::vec3, 14> unitCubeNormals()
+{
+    static const auto NEGATIVE_X = glm::vec3(-1.0, 0.0, 0.0);
+    static const auto NEGATIVE_Y = glm::vec3(0.0, -1.0, 0.0);
+    static const auto NEGATIVE_Z = glm::vec3(0.0, 0.0, -1.0);
+    static const auto POSITIVE_X = glm::vec3(1.0, 0.0, 0.0);
+    static const auto POSITIVE_Y = glm::vec3(0.0, 1.0, 0.0);
+    static const auto POSITIVE_Z = glm::vec3(0.0, 0.0, 1.0);
+
+    return {{
+        POSITIVE_Y, POSITIVE_Y, POSITIVE_Y, POSITIVE_Y,
+        POSITIVE_X,
+        POSITIVE_Z, POSITIVE_Z,
+        NEGATIVE_X, NEGATIVE_X,
+        NEGATIVE_Z, NEGATIVE_Z,
+        POSITIVE_X,
+        NEGATIVE_Y, NEGATIVE_Y
+    }};
+}
+
+
+} // namespace
+
+
+CuboidTriangleStrip::CuboidTriangleStrip(StripDrawMode mode)
+: CuboidImplementation(StripDrawing::name("Triangle Strip", mode))
+, m_stripDrawing(mode)
 , m_vertices(0)
 , m_vao(0)
 , m_vertexShader(0)
@@ -20,6 +79,11 @@ CuboidTriangleStrip::CuboidTriangleStrip()
 
 CuboidTriangleStrip::~CuboidTriangleStrip()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteVertexArrays(1, &m_vao);
     glDeleteShader(m_vertexShader);
@@ -47,10 +111,19 @@ void CuboidTriangleStrip::onInitialize()
 
 void CuboidTriangleStrip::initializeVAO()
 {
+    const auto order = m_stripDrawing.vertexOrder(m_multiStarts, m_multiCounts);
+
+    if (!order.empty())
+    {
+        gatherVertices(m_vertex, order);
+        gatherVertices(m_normal, order);
+        gatherVertices(m_colorValue, order);
+    }
+
     glBindVertexArray(m_vao);
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
-    glBufferData(GL_ARRAY_BUFFER, byteSize(), nullptr, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, verticesCount() * vertexByteSize(), nullptr, GL_STATIC_DRAW);
 
     glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 0, verticesCount() * sizeof(float) * 3, m_vertex.data());
     glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 3, verticesCount() * sizeof(float) * 3, m_normal.data());
@@ -64,8 +137,11 @@ void CuboidTriangleStrip::initializeVAO()
     glEnableVertexAttribArray(1);
     glEnableVertexAttribArray(2);
 
+    m_stripDrawing.initialize(m_multiStarts, m_multiCounts, verticesCount());
+
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 bool CuboidTriangleStrip::loadShader()
@@ -110,62 +186,29 @@ bool CuboidTriangleStrip::loadShader()
 
 void CuboidTriangleStrip::setCube(size_t index, const Cuboid & cuboid)
 {
-    static const auto NEGATIVE_X = glm::vec3(-1.0, 0.0, 0.0);
-    static const auto NEGATIVE_Y = glm::vec3(0.0, -1.0, 0.0);
-    static const auto NEGATIVE_Z = glm::vec3(0.0, 0.0, -1.0);
-    static const auto POSITIVE_X = glm::vec3(1.0, 0.0, 0.0);
-    static const auto POSITIVE_Y = glm::vec3(0.0, 1.0, 0.0);
-    static const auto POSITIVE_Z = glm::vec3(0.0, 0.0, 1.0);
-
-    const auto llf = cuboid.center - cuboid.extent / glm::vec3(2.0);
-    const auto urb = cuboid.center + cuboid.extent / glm::vec3(2.0);
-
-    const auto vertices = std::array<glm::vec3, 8>{{
-        glm::vec3(llf.x, urb.y, llf.z), // A = H
-        glm::vec3(llf.x, urb.y, urb.z), // B = F
-        glm::vec3(urb.x, urb.y, llf.z), // C = J
-        glm::vec3(urb.x, urb.y, urb.z), // D
-        glm::vec3(urb.x, llf.y, urb.z), // E = L
-        glm::vec3(llf.x, llf.y, urb.z), // G
-        glm::vec3(llf.x, llf.y, llf.z), // I
-        glm::vec3(urb.x, llf.y, llf.z) // K
-    }};
-
-    size_t i = 0;
-    const auto emitVertex = [this, index, &cuboid, &i](const glm::vec3 & vertex, const glm::vec3 & normal)
-    {
-        m_vertex[index * verticesPerCuboid() + i] = vertex;
-        m_normal[index * verticesPerCuboid() + i] = normal;
-        m_colorValue[index * verticesPerCuboid() + i] = cuboid.colorValue;
-
-        ++i;
-    };
-
-    emitVertex(vertices[0], POSITIVE_Y); // A
-    emitVertex(vertices[1], POSITIVE_Y); // B
-    emitVertex(vertices[2], POSITIVE_Y); // C
-    emitVertex(vertices[3], POSITIVE_Y); // D
-
-    emitVertex(vertices[4], POSITIVE_X); // E
-
-    emitVertex(vertices[1], POSITIVE_Z); // F
-    emitVertex(vertices[5], POSITIVE_Z); // G
+    setCubes(index, &cuboid, 1);
+}
 
-    emitVertex(vertices[0], NEGATIVE_X); // H
-    emitVertex(vertices[6], NEGATIVE_X); // I
+void CuboidTriangleStrip::setCubes(size_t first, const Cuboid * cuboids, size_t count)
+{
+    static const auto vertices = unitCubeVertices();
+    static const auto normals = unitCubeNormals();
 
-    emitVertex(vertices[2], NEGATIVE_Z); // J
-    emitVertex(vertices[7], NEGATIVE_Z); // K
+    const auto offset = verticesPerCuboid() * first;
 
-    emitVertex(vertices[4], POSITIVE_X); // L
+    expandCuboidPositions(cuboids, count, vertices.data(), vertices.size(), m_vertex.data() + offset);
+    expandCuboidNormals(cuboids, count, normals.data(), normals.size(), m_normal.data() + offset);
+    expandCuboidColors(cuboids, count, verticesPerCuboid(), m_colorValue.data() + offset);
+}
 
-    emitVertex(vertices[6], NEGATIVE_Y); // I
-    emitVertex(vertices[5], NEGATIVE_Y); // G
+void CuboidTriangleStrip::updateBuffers()
+{
+    initializeVAO();
 }
 
 size_t CuboidTriangleStrip::size() const
 {
-    return m_vertex.size() / verticesPerCuboid();
+    return m_multiCounts.size();
 }
 
 size_t CuboidTriangleStrip::verticesPerCuboid() const
@@ -175,7 +218,8 @@ size_t CuboidTriangleStrip::verticesPerCuboid() const
 
 size_t CuboidTriangleStrip::verticesCount() const
 {
-    return size() * verticesPerCuboid();
+    // Stitched strips carry degenerate vertices in addition
+    return m_vertex.size();
 }
 
 size_t CuboidTriangleStrip::staticByteSize() const
@@ -185,7 +229,7 @@ size_t CuboidTriangleStrip::staticByteSize() const
 
 size_t CuboidTriangleStrip::byteSize() const
 {
-    return verticesCount() * vertexByteSize();
+    return verticesCount() * vertexByteSize() + m_stripDrawing.byteSize();
 }
 
 size_t CuboidTriangleStrip::vertexByteSize() const
@@ -216,6 +260,25 @@ void CuboidTriangleStrip::resize(size_t count)
     });
 }
 
+size_t CuboidTriangleStrip::cpuByteSize() const
+{
+    return containerByteSize(m_vertex)
+        + containerByteSize(m_normal)
+        + containerByteSize(m_colorValue)
+        + containerByteSize(m_multiStarts)
+        + containerByteSize(m_multiCounts);
+}
+
+std::vector<gl::GLuint> CuboidTriangleStrip::buffers() const
+{
+    if (m_stripDrawing.buffer() != 0)
+    {
+        return { m_vertices, m_stripDrawing.buffer() };
+    }
+
+    return { m_vertices };
+}
+
 void CuboidTriangleStrip::onRender()
 {
     glBindVertexArray(m_vao);
@@ -230,7 +293,7 @@ void CuboidTriangleStrip::onRender()
     glDepthMask(GL_TRUE);
 
     glUseProgram(m_program);
-    glMultiDrawArrays(GL_TRIANGLE_STRIP, m_multiStarts.data(), m_multiCounts.data(), size());
+    m_stripDrawing.draw(m_multiStarts, m_multiCounts);
 
     glDepthMask(GL_TRUE);
 
@@ -9,12 +9,13 @@
 
 #include "Cuboid.h"
 #include "CuboidImplementation.h"
+#include "StripDrawing.h"
 
 
 class CuboidTriangleStrip : public CuboidImplementation
 {
 public:
-    CuboidTriangleStrip();
+    CuboidTriangleStrip(StripDrawMode mode);
     ~CuboidTriangleStrip();
 
     virtual void onInitialize() override;
@@ -23,6 +24,8 @@ public:
     virtual bool loadShader() override;
 
     virtual void setCube(size_t index, const Cuboid & cuboid) override;
+    virtual void setCubes(size_t first, const Cuboid * cuboids, size_t count) override;
+    virtual void updateBuffers() override;
 
     virtual size_t size() const override;
     virtual size_t verticesCount() const override;
@@ -30,9 +33,12 @@ public:
     virtual size_t byteSize() const override;
     virtual size_t vertexByteSize() const override;
     virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
 
     virtual void resize(size_t count) override;
 
+    virtual std::vector<gl::GLuint> buffers() const override;
+
     virtual gl::GLuint program() const override;
 public:
     std::vector<glm::vec3> m_vertex;
@@ -42,6 +48,8 @@ public:
     std::vector<gl::GLint> m_multiStarts;
     std::vector<gl::GLint> m_multiCounts;
 
+    StripDrawing m_stripDrawing;
+
     gl::GLuint m_vertices;
     gl::GLuint m_vao;
 
@@ -2,13 +2,79 @@
 #include "CuboidTriangles.h"
 
 #include <algorithm>
+#include <array>
 
 #include <glbinding/gl/gl.h>
 
 #include "common.h"
 
+#include "CuboidExpansion.h"
+
 using namespace gl;
 
+
+namespace
+{
+
+
+// Corner and normal of each vertex, two triangles per face, for a unit cube around the origin
+std::array<glm::vec3, 36> unitCubeVertices()
+{
+    static const glm::vec3 corners[8] = {
+        glm::vec3(-0.5f, 0.5f, -0.5f), // A = H
+        glm::vec3(-0.5f, 0.5f, 0.5f), // B = F
+        glm::vec3(0.5f, 0.5f, -0.5f), // C = J
+        glm::vec3(0.5f, 0.5f, 0.5f), // D
+        glm::vec3(0.5f, -0.5f, 0.5f), // E = L
+        glm::vec3(-0.5f, -0.5f, 0.5f), // G
+        glm::vec3(-0.5f, -0.5f, -0.5f), // I
+        glm::vec3(0.5f, -0.5f, -0.5f), // K
+    };
+
+    static const size_t indices[36] = {
+        1, 0, 5, 5, 0, 6, // -x
+        6, 0, 7, 7, 0, 2, // -z
+        2, 3, 7, 7, 3, 4, // +x
+        4, 3, 5, 5, 3, 1, // +z
+        1, 3, 0, 0, 3, 2, // +y
+        4, 5, 6, 6, 7, 4  // -y
+    };
+
+    auto vertices = std::array<glm::vec3, 36>();
+
+    for (auto i = size_t(0); i < vertices.size(); ++i)
+    {
+        vertices[i] = corners[indices[i]];
+    }
+
+    return vertices;
+}
+
+std::array<glm::vec3, 36> unitCubeNormals()
+{
+    static const glm::vec3 faceNormals[6] = {
+        glm::vec3(-1.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, -1.0f),
+        glm::vec3(1.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, -1.0f, 0.0f)
+    };
+
+    auto normals = std::array<glm::vec3, 36>();
+
+    for (auto i = size_t(0); i < normals.size(); ++i)
+    {
+        normals[i] = faceNormals[i / 6];
+    }
+
+    return normals;
+}
+
+
+} // namespace
+
+
 CuboidTriangles::CuboidTriangles()
 : CuboidImplementation("Triangles")
 , m_vertices(0)
@@ -20,6 +86,11 @@ CuboidTriangles::CuboidTriangles()
 
 CuboidTriangles::~CuboidTriangles()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteVertexArrays(1, &m_vao);
     glDeleteShader(m_vertexShader);
@@ -110,113 +181,24 @@ bool CuboidTriangles::loadShader()
 
 void CuboidTriangles::setCube(size_t index, const Cuboid & cuboid)
 {
-    static const glm::vec3 NEGATIVE_X = glm::vec3(-1.0, 0.0, 0.0);
-    static const glm::vec3 NEGATIVE_Y = glm::vec3(0.0, -1.0, 0.0);
-    static const glm::vec3 NEGATIVE_Z = glm::vec3(0.0, 0.0, -1.0);
-    static const glm::vec3 POSITIVE_X = glm::vec3(1.0, 0.0, 0.0);
-    static const glm::vec3 POSITIVE_Y = glm::vec3(0.0, 1.0, 0.0);
-    static const glm::vec3 POSITIVE_Z = glm::vec3(0.0, 0.0, 1.0);
-
-    static const glm::vec3 vertices[8] = {
-        glm::vec3(-0.5f, 0.5f, -0.5f), // A = H
-        glm::vec3(-0.5f, 0.5f, 0.5f), // B = F
-        glm::vec3(0.5f, 0.5f, -0.5f), // C = J
-        glm::vec3(0.5f, 0.5f, 0.5f), // D
-        glm::vec3(0.5f, -0.5f, 0.5f), // E = L
-        glm::vec3(-0.5f, -0.5f, 0.5f), // G
-        glm::vec3(-0.5f, -0.5f, -0.5f), // I
-        glm::vec3(0.5f, -0.5f, -0.5f), // K
-    };
+    setCubes(index, &cuboid, 1);
+}
 
-    m_normal[verticesPerCuboid() * index + 0] = NEGATIVE_X;
-    m_normal[verticesPerCuboid() * index + 1] = NEGATIVE_X;
-    m_normal[verticesPerCuboid() * index + 2] = NEGATIVE_X;
-    m_normal[verticesPerCuboid() * index + 3] = NEGATIVE_X;
-    m_normal[verticesPerCuboid() * index + 4] = NEGATIVE_X;
-    m_normal[verticesPerCuboid() * index + 5] = NEGATIVE_X;
-
-    m_normal[verticesPerCuboid() * index + 6] = NEGATIVE_Z;
-    m_normal[verticesPerCuboid() * index + 7] = NEGATIVE_Z;
-    m_normal[verticesPerCuboid() * index + 8] = NEGATIVE_Z;
-    m_normal[verticesPerCuboid() * index + 9] = NEGATIVE_Z;
-    m_normal[verticesPerCuboid() * index + 10] = NEGATIVE_Z;
-    m_normal[verticesPerCuboid() * index + 11] = NEGATIVE_Z;
-
-    m_normal[verticesPerCuboid() * index + 12] = POSITIVE_X;
-    m_normal[verticesPerCuboid() * index + 13] = POSITIVE_X;
-    m_normal[verticesPerCuboid() * index + 14] = POSITIVE_X;
-    m_normal[verticesPerCuboid() * index + 15] = POSITIVE_X;
-    m_normal[verticesPerCuboid() * index + 16] = POSITIVE_X;
-    m_normal[verticesPerCuboid() * index + 17] = POSITIVE_X;
-
-    m_normal[verticesPerCuboid() * index + 18] = POSITIVE_Z;
-    m_normal[verticesPerCuboid() * index + 19] = POSITIVE_Z;
-    m_normal[verticesPerCuboid() * index + 20] = POSITIVE_Z;
-    m_normal[verticesPerCuboid() * index + 21] = POSITIVE_Z;
-    m_normal[verticesPerCuboid() * index + 22] = POSITIVE_Z;
-    m_normal[verticesPerCuboid() * index + 23] = POSITIVE_Z;
-
-    m_normal[verticesPerCuboid() * index + 24] = POSITIVE_Y;
-    m_normal[verticesPerCuboid() * index + 25] = POSITIVE_Y;
-    m_normal[verticesPerCuboid() * index + 26] = POSITIVE_Y;
-    m_normal[verticesPerCuboid() * index + 27] = POSITIVE_Y;
-    m_normal[verticesPerCuboid() * index + 28] = POSITIVE_Y;
-    m_normal[verticesPerCuboid() * index + 29] = POSITIVE_Y;
-
-    m_normal[verticesPerCuboid() * index + 30] = NEGATIVE_Y;
-    m_normal[verticesPerCuboid() * index + 31] = NEGATIVE_Y;
-    m_normal[verticesPerCuboid() * index + 32] = NEGATIVE_Y;
-    m_normal[verticesPerCuboid() * index + 33] = NEGATIVE_Y;
-    m_normal[verticesPerCuboid() * index + 34] = NEGATIVE_Y;
-    m_normal[verticesPerCuboid() * index + 35] = NEGATIVE_Y;
-
-    m_vertex[verticesPerCuboid() * index + 0] = vertices[1];
-    m_vertex[verticesPerCuboid() * index + 1] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 2] = vertices[5];
-    m_vertex[verticesPerCuboid() * index + 3] = vertices[5];
-    m_vertex[verticesPerCuboid() * index + 4] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 5] = vertices[6];
-
-    m_vertex[verticesPerCuboid() * index + 6] = vertices[6];
-    m_vertex[verticesPerCuboid() * index + 7] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 8] = vertices[7];
-    m_vertex[verticesPerCuboid() * index + 9] = vertices[7];
-    m_vertex[verticesPerCuboid() * index + 10] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 11] = vertices[2];
-
-    m_vertex[verticesPerCuboid() * index + 12] = vertices[2];
-    m_vertex[verticesPerCuboid() * index + 13] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 14] = vertices[7];
-    m_vertex[verticesPerCuboid() * index + 15] = vertices[7];
-    m_vertex[verticesPerCuboid() * index + 16] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 17] = vertices[4];
-
-    m_vertex[verticesPerCuboid() * index + 18] = vertices[4];
-    m_vertex[verticesPerCuboid() * index + 19] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 20] = vertices[5];
-    m_vertex[verticesPerCuboid() * index + 21] = vertices[5];
-    m_vertex[verticesPerCuboid() * index + 22] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 23] = vertices[1];
-
-    m_vertex[verticesPerCuboid() * index + 24] = vertices[1];
-    m_vertex[verticesPerCuboid() * index + 25] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 26] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 27] = vertices[0];
-    m_vertex[verticesPerCuboid() * index + 28] = vertices[3];
-    m_vertex[verticesPerCuboid() * index + 29] = vertices[2];
-
-    m_vertex[verticesPerCuboid() * index + 30] = vertices[4];
-    m_vertex[verticesPerCuboid() * index + 31] = vertices[5];
-    m_vertex[verticesPerCuboid() * index + 32] = vertices[6];
-    m_vertex[verticesPerCuboid() * index + 33] = vertices[6];
-    m_vertex[verticesPerCuboid() * index + 34] = vertices[7];
-    m_vertex[verticesPerCuboid() * index + 35] = vertices[4];
-
-    for (auto i = 0ull; i < verticesPerCuboid(); ++i)
-    {
-        m_vertex[verticesPerCuboid() * index + i] = cuboid.center + cuboid.extent * m_vertex[verticesPerCuboid() * index + i];
-        m_colorValue[verticesPerCuboid() * index + i] = cuboid.colorValue;
-    }
+void CuboidTriangles::setCubes(size_t first, const Cuboid * cuboids, size_t count)
+{
+    static const auto vertices = unitCubeVertices();
+    static const auto normals = unitCubeNormals();
+
+    const auto offset = verticesPerCuboid() * first;
+
+    expandCuboidPositions(cuboids, count, vertices.data(), vertices.size(), m_vertex.data() + offset);
+    expandCuboidNormals(cuboids, count, normals.data(), normals.size(), m_normal.data() + offset);
+    expandCuboidColors(cuboids, count, verticesPerCuboid(), m_colorValue.data() + offset);
+}
+
+void CuboidTriangles::updateBuffers()
+{
+    initializeVAO();
 }
 
 size_t CuboidTriangles::size() const
@@ -261,6 +243,18 @@ void CuboidTriangles::resize(size_t count)
     m_colorValue.resize(count * verticesPerCuboid());
 }
 
+size_t CuboidTriangles::cpuByteSize() const
+{
+    return containerByteSize(m_vertex)
+        + containerByteSize(m_normal)
+        + containerByteSize(m_colorValue);
+}
+
+std::vector<gl::GLuint> CuboidTriangles::buffers() const
+{
+    return { m_vertices };
+}
+
 void CuboidTriangles::onRender()
 {
     glBindVertexArray(m_vao);
@@ -23,6 +23,8 @@ public:
     virtual bool loadShader() override;
 
     virtual void setCube(size_t index, const Cuboid & cuboid) override;
+    virtual void setCubes(size_t first, const Cuboid * cuboids, size_t count) override;
+    virtual void updateBuffers() override;
 
     virtual size_t size() const override;
     virtual size_t verticesCount() const override;
@@ -30,9 +32,12 @@ public:
     virtual size_t byteSize() const override;
     virtual size_t vertexByteSize() const override;
     virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
 
     virtual void resize(size_t count) override;
 
+    virtual std::vector<gl::GLuint> buffers() const override;
+
     virtual gl::GLuint program() const override;
 public:
     std::vector<glm::vec3> m_vertex;
@@ -7,8 +7,9 @@
 
 using namespace gl;
 
-CuboidVertexCloud::CuboidVertexCloud()
-: CuboidImplementation("Attributed Vertex Cloud")
+CuboidVertexCloud::CuboidVertexCloud(bool visibleFacesOnly)
+: CuboidImplementation(visibleFacesOnly ? "Attributed Vertex Cloud (Visible Faces)" : "Attributed Vertex Cloud")
+, m_visibleFacesOnly(visibleFacesOnly)
 , m_vertices(0)
 , m_vao(0)
 , m_vertexShader(0)
@@ -19,6 +20,11 @@ CuboidVertexCloud::CuboidVertexCloud()
 
 CuboidVertexCloud::~CuboidVertexCloud()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteVertexArrays(1, &m_vao);
     glDeleteShader(m_vertexShader);
@@ -58,16 +64,19 @@ void CuboidVertexCloud::initializeVAO()
     glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 2, verticesCount() * sizeof(float) * 2, m_extent.data());
     glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 4, verticesCount() * sizeof(float) * 2, m_heightRange.data());
     glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 6, verticesCount() * sizeof(float) * 1, m_colorValue.data());
+    glBufferSubData(GL_ARRAY_BUFFER, verticesCount() * sizeof(float) * 7, verticesCount() * sizeof(float) * 1, m_rotation.data());
 
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 0));
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 2));
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 4));
     glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 6));
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(float), reinterpret_cast<void*>(verticesCount() * sizeof(float) * 7));
 
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
     glEnableVertexAttribArray(2);
     glEnableVertexAttribArray(3);
+    glEnableVertexAttribArray(4);
 
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -85,7 +94,7 @@ bool CuboidVertexCloud::loadShader()
     bool success = checkForCompilationError(m_vertexShader, "vertex shader");
 
 
-    const auto geometryShaderSource = loadShaderSource("/cuboids-avc/standard.geom");
+    const auto geometryShaderSource = loadShaderSource(m_visibleFacesOnly ? "/cuboids-avc/visible.geom" : "/cuboids-avc/standard.geom");
     const auto geometryShaderSource_ptr = geometryShaderSource.c_str();
     if(geometryShaderSource_ptr)
         glShaderSource(m_geometryShader, 1, &geometryShaderSource_ptr, 0);
@@ -130,6 +139,12 @@ void CuboidVertexCloud::setCube(size_t index, const Cuboid & cuboid)
     m_extent[index] = glm::vec2(cuboid.extent.x, cuboid.extent.z);
     m_heightRange[index] = glm::vec2(cuboid.center.y - cuboid.extent.y / 2.0f, cuboid.extent.y);
     m_colorValue[index] = cuboid.colorValue;
+    m_rotation[index] = cuboid.rotation;
+}
+
+void CuboidVertexCloud::updateBuffers()
+{
+    initializeVAO();
 }
 
 size_t CuboidVertexCloud::size() const
@@ -164,7 +179,7 @@ size_t CuboidVertexCloud::vertexByteSize() const
 
 size_t CuboidVertexCloud::componentCount() const
 {
-    return 7;
+    return 8;
 }
 
 void CuboidVertexCloud::resize(size_t count)
@@ -173,6 +188,26 @@ void CuboidVertexCloud::resize(size_t count)
     m_extent.resize(count);
     m_heightRange.resize(count);
     m_colorValue.resize(count);
+    m_rotation.resize(count);
+}
+
+size_t CuboidVertexCloud::cpuByteSize() const
+{
+    return containerByteSize(m_center)
+        + containerByteSize(m_extent)
+        + containerByteSize(m_heightRange)
+        + containerByteSize(m_colorValue)
+        + containerByteSize(m_rotation);
+}
+
+size_t CuboidVertexCloud::orientationByteSize() const
+{
+    return verticesCount() * sizeof(float);
+}
+
+std::vector<gl::GLuint> CuboidVertexCloud::buffers() const
+{
+    return { m_vertices };
 }
 
 void CuboidVertexCloud::onRender()
@@ -182,8 +217,16 @@ void CuboidVertexCloud::onRender()
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
 
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    // The visible faces strip relies on the depth test instead of a consistent winding
+    if (m_visibleFacesOnly)
+    {
+        glDisable(GL_CULL_FACE);
+    }
+    else
+    {
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_BACK);
+    }
 
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glDepthMask(GL_TRUE);
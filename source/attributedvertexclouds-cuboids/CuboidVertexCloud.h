@@ -14,7 +14,7 @@
 class CuboidVertexCloud : public CuboidImplementation
 {
 public:
-    CuboidVertexCloud();
+    CuboidVertexCloud(bool visibleFacesOnly);
     ~CuboidVertexCloud();
 
     virtual void onInitialize() override;
@@ -23,6 +23,7 @@ public:
     virtual bool loadShader() override;
 
     virtual void setCube(size_t index, const Cuboid & cuboid) override;
+    virtual void updateBuffers() override;
 
     virtual size_t size() const override;
     virtual size_t verticesCount() const override;
@@ -30,15 +31,22 @@ public:
     virtual size_t byteSize() const override;
     virtual size_t vertexByteSize() const override;
     virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
+    virtual size_t orientationByteSize() const override;
 
     virtual void resize(size_t count) override;
 
+    virtual std::vector<gl::GLuint> buffers() const override;
+
     virtual gl::GLuint program() const override;
 public:
+    bool m_visibleFacesOnly;
+
     std::vector<glm::vec2> m_center;
     std::vector<glm::vec2> m_extent;
     std::vector<glm::vec2> m_heightRange;
     std::vector<float> m_colorValue;
+    std::vector<float> m_rotation;
 
     gl::GLuint m_vertices;
     gl::GLuint m_vao;
@@ -0,0 +1,400 @@
+
+#include "Treemap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+
+#include "common.h"
+
+
+namespace
+{
+
+
+static const auto rootRect = glm::vec4(-0.5f, -0.5f, 0.5f, 0.5f);
+
+// Inset of the children from the border of their parent, relative to its shorter side
+static const auto padding = 0.03f;
+
+static const auto groundHeight = -0.25f;
+static const auto platformHeight = 0.01f;
+static const auto maxLeafHeight = 0.3f;
+
+
+float width(const glm::vec4 & rect)
+{
+    return rect.z - rect.x;
+}
+
+float depth(const glm::vec4 & rect)
+{
+    return rect.w - rect.y;
+}
+
+// Worst aspect ratio of a row of areas along a side of the given length
+float worstAspectRatio(float sum, float minArea, float maxArea, float side)
+{
+    const auto side2 = side * side;
+    const auto sum2 = sum * sum;
+
+    return std::max(side2 * maxArea / sum2, sum2 / (side2 * minArea));
+}
+
+
+} // namespace
+
+
+Treemap::Treemap()
+: m_maxHeight(0.0f)
+{
+}
+
+bool Treemap::load(const std::string & filename)
+{
+    auto text = rawFromFile(filename);
+
+    if (text.empty())
+    {
+        return false;
+    }
+
+    text.push_back('\0');
+
+    auto parent = std::vector<int>();
+    auto weight = std::vector<float>();
+    auto height = std::vector<float>();
+    auto colorValue = std::vector<float>();
+
+    auto lineNumber = size_t(0);
+
+    for (auto line = text.data(); *line != '\0'; )
+    {
+        auto end = line;
+
+        while (*end != '\0' && *end != '\n')
+        {
+            ++end;
+        }
+
+        ++lineNumber;
+
+        const auto next = *end == '\0' ? end : end + 1;
+        *end = '\0';
+
+        auto current = line;
+        line = next;
+
+        while (*current == ' ' || *current == '\t' || *current == '\r')
+        {
+            ++current;
+        }
+
+        if (*current == '\0' || *current == '#')
+        {
+            continue;
+        }
+
+        auto position = static_cast<char *>(nullptr);
+        const auto parentIndex = std::strtol(current, &position, 10);
+        const auto nodeWeight = std::strtod(position, &current);
+
+        const auto index = static_cast<long>(parent.size());
+
+        // NaN and infinite weights would spread through the sums of the inner nodes into every layout
+        const auto validWeight = nodeWeight >= 0.0 && std::isfinite(static_cast<float>(nodeWeight));
+
+        if (current == position || (index == 0) != (parentIndex < 0) || parentIndex >= index || !validWeight)
+        {
+            std::cerr << filename << ":" << lineNumber << ": expected the index of an earlier parent node and a finite, non-negative weight" << std::endl;
+
+            return false;
+        }
+
+        parent.push_back(static_cast<int>(parentIndex));
+        weight.push_back(static_cast<float>(nodeWeight));
+
+        const auto nodeHeight = std::strtod(current, &position);
+        height.push_back(position != current ? static_cast<float>(nodeHeight) : 1.0f);
+
+        const auto nodeColorValue = std::strtod(position, &current);
+        colorValue.push_back(position != current ? static_cast<float>(nodeColorValue) : -1.0f);
+    }
+
+    if (parent.empty())
+    {
+        std::cerr << "Treemap file '" << filename << "' contains no nodes." << std::endl;
+
+        return false;
+    }
+
+    const auto count = parent.size();
+
+    m_parent = std::move(parent);
+    m_weight = std::move(weight);
+    m_height = std::move(height);
+    m_colorValue = std::move(colorValue);
+
+    // Parents precede their children, so a forward pass suffices for the depths
+    m_depth.assign(count, 0);
+
+    for (auto i = size_t(1); i < count; ++i)
+    {
+        m_depth[i] = m_depth[m_parent[i]] + 1;
+    }
+
+    const auto levelCount = *std::max_element(m_depth.begin(), m_depth.end()) + 1;
+
+    // Children and levels as counting sorts of the nodes by parent and by depth
+    m_firstChild.assign(count + 1, 0);
+    m_firstOfLevel.assign(levelCount + 1, 0);
+
+    for (auto i = size_t(0); i < count; ++i)
+    {
+        if (i > 0)
+        {
+            ++m_firstChild[m_parent[i] + 1];
+        }
+
+        ++m_firstOfLevel[m_depth[i] + 1];
+    }
+
+    std::partial_sum(m_firstChild.begin(), m_firstChild.end(), m_firstChild.begin());
+    std::partial_sum(m_firstOfLevel.begin(), m_firstOfLevel.end(), m_firstOfLevel.begin());
+
+    m_children.resize(count - 1);
+    m_levelOrder.resize(count);
+
+    auto nextChild = std::vector<size_t>(m_firstChild.begin(), m_firstChild.end() - 1);
+    auto nextOfLevel = std::vector<size_t>(m_firstOfLevel.begin(), m_firstOfLevel.end() - 1);
+
+    for (auto i = size_t(0); i < count; ++i)
+    {
+        if (i > 0)
+        {
+            m_children[nextChild[m_parent[i]]++] = i;
+        }
+
+        m_levelOrder[nextOfLevel[m_depth[i]]++] = i;
+    }
+
+    // Inner nodes weigh as much as their leaves; children come after their parents
+    for (auto i = count; i-- > 0; )
+    {
+        if (m_firstChild[i] == m_firstChild[i + 1])
+        {
+            continue;
+        }
+
+        m_weight[i] = 0.0f;
+
+        for (auto j = m_firstChild[i]; j < m_firstChild[i + 1]; ++j)
+        {
+            m_weight[i] += m_weight[m_children[j]];
+        }
+    }
+
+    m_maxHeight = 0.0f;
+
+    for (auto i = size_t(0); i < count; ++i)
+    {
+        if (m_firstChild[i] == m_firstChild[i + 1])
+        {
+            m_maxHeight = std::max(m_maxHeight, m_height[i]);
+        }
+
+        // Without a given color, nodes are colored by depth
+        if (m_colorValue[i] < 0.0f)
+        {
+            m_colorValue[i] = levelCount > 1 ? static_cast<float>(m_depth[i]) / (levelCount - 1) : 0.0f;
+        }
+    }
+
+    m_rect.assign(count, rootRect);
+
+    std::cout << "Treemap with " << count << " nodes, " << leafCount() << " leaves and " << levelCount << " levels loaded" << std::endl;
+
+    return true;
+}
+
+bool Treemap::empty() const
+{
+    return m_parent.empty();
+}
+
+size_t Treemap::size() const
+{
+    return m_parent.size();
+}
+
+size_t Treemap::leafCount() const
+{
+    // Each node except the root is the child of one inner node
+    auto innerCount = size_t(0);
+
+    for (auto i = size_t(0); i < size(); ++i)
+    {
+        innerCount += m_firstChild[i] != m_firstChild[i + 1] ? 1 : 0;
+    }
+
+    return size() - innerCount;
+}
+
+void Treemap::layout(bool squarified)
+{
+    if (empty())
+    {
+        return;
+    }
+
+    m_rect[0] = rootRect;
+
+    // The children of a level's nodes are disjoint, so the nodes of each level are laid out in parallel
+    for (auto level = size_t(0); level + 1 < m_firstOfLevel.size(); ++level)
+    {
+        const auto first = m_firstOfLevel[level];
+        const auto last = m_firstOfLevel[level + 1];
+
+#pragma omp parallel
+        {
+            auto sorted = std::vector<size_t>();
+
+#pragma omp for schedule(dynamic, 256)
+            for (long i = static_cast<long>(first); i < static_cast<long>(last); ++i)
+            {
+                const auto node = m_levelOrder[i];
+                const auto & rect = m_rect[node];
+                const auto inset = padding * std::min(width(rect), depth(rect));
+                const auto inner = rect + glm::vec4(inset, inset, -inset, -inset);
+
+                if (squarified)
+                {
+                    layoutSquarified(node, inner, sorted);
+                }
+                else
+                {
+                    layoutSliceAndDice(node, inner);
+                }
+            }
+        }
+    }
+}
+
+void Treemap::layoutSliceAndDice(size_t node, const glm::vec4 & rect)
+{
+    const auto alongX = m_depth[node] % 2 == 0;
+    const auto length = alongX ? width(rect) : depth(rect);
+    const auto scale = m_weight[node] > 0.0f ? length / m_weight[node] : 0.0f;
+
+    auto offset = alongX ? rect.x : rect.y;
+
+    for (auto j = m_firstChild[node]; j < m_firstChild[node + 1]; ++j)
+    {
+        const auto child = m_children[j];
+        const auto next = offset + m_weight[child] * scale;
+
+        m_rect[child] = alongX ? glm::vec4(offset, rect.y, next, rect.w) : glm::vec4(rect.x, offset, rect.z, next);
+
+        offset = next;
+    }
+}
+
+void Treemap::layoutSquarified(size_t node, const glm::vec4 & rect, std::vector<size_t> & sorted)
+{
+    sorted.assign(m_children.begin() + m_firstChild[node], m_children.begin() + m_firstChild[node + 1]);
+
+    if (sorted.empty())
+    {
+        return;
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [this](size_t a, size_t b) {
+        return m_weight[a] > m_weight[b];
+    });
+
+    const auto scale = m_weight[node] > 0.0f ? width(rect) * depth(rect) / m_weight[node] : 0.0f;
+
+    auto remaining = rect;
+    auto rowBegin = size_t(0);
+
+    // Places the row of children [rowBegin, rowEnd) with the given total area along the shorter side of the remaining rectangle
+    const auto placeRow = [this, &sorted, &remaining, scale](size_t rowBegin, size_t rowEnd, float area) {
+        const auto alongZ = width(remaining) >= depth(remaining);
+        const auto side = alongZ ? depth(remaining) : width(remaining);
+        const auto thickness = side > 0.0f ? area / side : 0.0f;
+
+        auto offset = alongZ ? remaining.y : remaining.x;
+
+        for (auto k = rowBegin; k < rowEnd; ++k)
+        {
+            const auto child = sorted[k];
+            const auto length = thickness > 0.0f ? m_weight[child] * scale / thickness : 0.0f;
+
+            m_rect[child] = alongZ
+                ? glm::vec4(remaining.x, offset, remaining.x + thickness, offset + length)
+                : glm::vec4(offset, remaining.y, offset + length, remaining.y + thickness);
+
+            offset += length;
+        }
+
+        if (alongZ)
+        {
+            remaining.x += thickness;
+        }
+        else
+        {
+            remaining.y += thickness;
+        }
+    };
+
+    auto rowArea = 0.0f;
+    auto rowMin = 0.0f;
+    auto rowMax = 0.0f;
+
+    for (auto k = size_t(0); k < sorted.size(); ++k)
+    {
+        const auto area = m_weight[sorted[k]] * scale;
+
+        if (k > rowBegin && area > 0.0f)
+        {
+            const auto side = std::min(width(remaining), depth(remaining));
+
+            // Start a new row once adding the child would worsen the row's aspect ratios
+            if (worstAspectRatio(rowArea + area, std::min(rowMin, area), rowMax, side) > worstAspectRatio(rowArea, rowMin, rowMax, side))
+            {
+                placeRow(rowBegin, k, rowArea);
+
+                rowBegin = k;
+                rowArea = 0.0f;
+            }
+        }
+
+        if (k == rowBegin)
+        {
+            rowMin = area;
+            rowMax = area;
+        }
+
+        rowArea += area;
+        rowMin = std::min(rowMin, area);
+    }
+
+    placeRow(rowBegin, sorted.size(), rowArea);
+}
+
+Cuboid Treemap::cuboid(size_t node) const
+{
+    const auto & rect = m_rect[node];
+    const auto leaf = m_firstChild[node] == m_firstChild[node + 1];
+    const auto bottom = groundHeight + m_depth[node] * platformHeight;
+    const auto height = leaf && m_maxHeight > 0.0f ? m_height[node] / m_maxHeight * maxLeafHeight : platformHeight;
+
+    auto result = Cuboid();
+    result.center = glm::vec3((rect.x + rect.z) / 2.0f, bottom + height / 2.0f, (rect.y + rect.w) / 2.0f);
+    result.extent = glm::vec3(width(rect), height, depth(rect));
+    result.colorValue = m_colorValue[node];
+
+    return result;
+}
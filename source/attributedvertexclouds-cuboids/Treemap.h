@@ -0,0 +1,56 @@
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/vec4.hpp>
+
+#include "Cuboid.h"
+
+
+// Hierarchy laid out as 2.5D treemap, one cuboid per node: inner nodes become flat platforms,
+// leaves stand on top of their parent's platform with a height of their own.
+// Files list one node per line: "parent weight [height [colorValue]]", where parent is the zero-based
+// index of an earlier node (-1 for the root, which has to come first); lines starting with '#' are ignored.
+// Inner nodes are weighted by the sum of their leaves, so only the weights of leaves matter.
+class Treemap
+{
+public:
+    Treemap();
+
+    bool load(const std::string & filename);
+
+    bool empty() const;
+    size_t size() const;
+    size_t leafCount() const;
+
+    // Lays out all nodes into the unit square around the origin, level by level with the nodes of a level in parallel;
+    // slice-and-dice alternates between splitting along x and z with each level
+    void layout(bool squarified);
+
+    Cuboid cuboid(size_t node) const;
+
+protected:
+    std::vector<int> m_parent;
+    std::vector<float> m_weight;
+    std::vector<float> m_height;
+    std::vector<float> m_colorValue;
+    std::vector<size_t> m_depth;
+
+    // Children of node i are m_children[m_firstChild[i]] to m_children[m_firstChild[i + 1] - 1]
+    std::vector<size_t> m_firstChild;
+    std::vector<size_t> m_children;
+
+    // Nodes of level i are m_levelOrder[m_firstOfLevel[i]] to m_levelOrder[m_firstOfLevel[i + 1] - 1]
+    std::vector<size_t> m_levelOrder;
+    std::vector<size_t> m_firstOfLevel;
+
+    float m_maxHeight;
+
+    // Footprint of each node as (x0, z0, x1, z1)
+    std::vector<glm::vec4> m_rect;
+
+    void layoutSliceAndDice(size_t node, const glm::vec4 & rect);
+    void layoutSquarified(size_t node, const glm::vec4 & rect, std::vector<size_t> & sorted);
+};
@@ -11,6 +11,7 @@
 #include <glbinding/gl/gl.h>
 
 #include "common.h"
+#include "PrimitiveGrid.h"
 
 #include "PolygonVertexCloud.h"
 #include "PolygonTriangles.h"
@@ -46,11 +47,25 @@ PolygonRendering::~PolygonRendering()
 {
 }
 
+Implementation * PolygonRendering::createImplementation(size_t index)
+{
+    switch (index)
+    {
+    case 0: return new PolygonTriangles;
+    case 1: return new PolygonTriangleStrip(StripDrawMode::MultiDraw);
+    case 2: return new PolygonVertexCloud;
+    case 3: return new PolygonTriangleStrip(StripDrawMode::PrimitiveRestart);
+    case 4: return new PolygonTriangleStrip(StripDrawMode::Degenerate);
+    default: return nullptr;
+    }
+}
+
 void PolygonRendering::onInitialize()
 {
-    addImplementation(new PolygonTriangles);
-    addImplementation(new PolygonTriangleStrip);
-    addImplementation(new PolygonVertexCloud);
+    for (auto index = size_t(0); auto implementation = createImplementation(index); ++index)
+    {
+        addImplementation(implementation);
+    }
 
     glGenTextures(1, &m_gradientTexture);
 
@@ -77,25 +92,25 @@ void PolygonRendering::onDeinitialize()
 
 void PolygonRendering::onCreateGeometry()
 {
-    const auto polygonGridSize = static_cast<std::size_t>(m_gridSize);
-    const auto polygonCount = static_cast<std::size_t>(polygonGridSize * polygonGridSize * polygonGridSize);
-    const auto worldScale = glm::vec3(1.0f) / glm::vec3(polygonGridSize, polygonGridSize, polygonGridSize);
+    createGeometry(m_primitiveCount, geometryImplementations());
+}
+
+void PolygonRendering::createGeometry(size_t polygonCount, const std::vector<Implementation *> & implementations)
+{
+    auto grid = PrimitiveGrid(polygonCount);
+    const auto worldScale = glm::vec3(1.0f) / glm::vec3(grid.size());
 
-    for (auto implementation : m_implementations)
+    for (auto implementation : implementations)
     {
         implementation->resize(polygonCount);
     }
 
-    std::array<std::vector<float>, 4> noise;
-    for (auto i = size_t(0); i < noise.size(); ++i)
-    {
-        noise[i] = loadNoise("/noise-"+std::to_string(polygonGridSize)+"-"+std::to_string(i)+".raw");
-    }
+    grid.loadNoise(4);
 
 //#pragma omp parallel for
     for (size_t i = 0; i < polygonCount; ++i)
     {
-        const auto position = glm::ivec3(i % polygonGridSize, (i / polygonGridSize) % polygonGridSize, i / polygonGridSize / polygonGridSize);
+        const auto position = grid.position(i);
         const auto offset = glm::vec3(
             (position.y + position.z) % 2 ? gridOffset : 0.0f,
             (position.x + position.z) % 2 ? gridOffset : 0.0f,
@@ -104,12 +119,12 @@ void PolygonRendering::onCreateGeometry()
 
         Polygon p;
 
-        p.heightRange.x = -0.5f + (position.y + offset.y) * worldScale.y - 0.5f * noise[0][i] * worldScale.y;
-        p.heightRange.y = -0.5f + (position.y + offset.y) * worldScale.y + 0.5f * noise[0][i] * worldScale.y;
+        p.heightRange.x = -0.5f + (position.y + offset.y) * worldScale.y - 0.5f * grid.noise(0, i) * worldScale.y;
+        p.heightRange.y = -0.5f + (position.y + offset.y) * worldScale.y + 0.5f * grid.noise(0, i) * worldScale.y;
 
-        const auto vertexCount = size_t(3) + size_t(glm::ceil(12.0f * noise[1][i]));
+        const auto vertexCount = size_t(3) + size_t(glm::ceil(12.0f * grid.noise(1, i)));
         const auto center = glm::vec2(-0.5f, -0.5f) + (glm::vec2(position.x, position.z) + glm::vec2(offset.x, offset.z)) * glm::vec2(worldScale.x, worldScale.z);
-        const auto radius = 0.5f * 0.5f * (noise[2][i] + 1.0f);
+        const auto radius = 0.5f * 0.5f * (grid.noise(2, i) + 1.0f);
 
         p.points.resize(vertexCount);
 
@@ -124,9 +139,9 @@ void PolygonRendering::onCreateGeometry()
             p.points[j] = center + glm::vec2(radius, radius) * normalizedPosition * glm::vec2(worldScale.x, worldScale.z);
         }
 
-        p.colorValue = noise[3][i];
+        p.colorValue = grid.noise(3, i);
 
-        for (auto implementation : m_implementations)
+        for (auto implementation : implementations)
         {
             static_cast<PolygonImplementation*>(implementation)->setPolygon(i, p);
         }
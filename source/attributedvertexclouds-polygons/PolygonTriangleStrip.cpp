@@ -7,8 +7,9 @@
 
 using namespace gl;
 
-PolygonTriangleStrip::PolygonTriangleStrip()
-: PolygonImplementation("Triangle Strip")
+PolygonTriangleStrip::PolygonTriangleStrip(StripDrawMode mode)
+: PolygonImplementation(StripDrawing::name("Triangle Strip", mode))
+, m_stripDrawing(mode)
 , m_vertices(0)
 , m_vao(0)
 , m_vertexShader(0)
@@ -18,6 +19,11 @@ PolygonTriangleStrip::PolygonTriangleStrip()
 
 PolygonTriangleStrip::~PolygonTriangleStrip()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteVertexArrays(1, &m_vao);
 
@@ -47,6 +53,16 @@ void PolygonTriangleStrip::onInitialize()
 
 void PolygonTriangleStrip::initializeVAO()
 {
+    const auto order = m_stripDrawing.vertexOrder(m_multiStarts, m_multiCounts);
+
+    // Stitching keeps each strip at an even position, so back-face culling still applies
+    if (!order.empty())
+    {
+        gatherVertices(m_position, order);
+        gatherVertices(m_normal, order);
+        gatherVertices(m_colorValue, order);
+    }
+
     glBindVertexArray(m_vao);
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
@@ -64,8 +80,11 @@ void PolygonTriangleStrip::initializeVAO()
     glEnableVertexAttribArray(1);
     glEnableVertexAttribArray(2);
 
+    m_stripDrawing.initialize(m_multiStarts, m_multiCounts, size());
+
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 bool PolygonTriangleStrip::loadShader()
@@ -220,7 +239,7 @@ size_t PolygonTriangleStrip::staticByteSize() const
 
 size_t PolygonTriangleStrip::byteSize() const
 {
-    return size() * vertexByteSize();
+    return size() * vertexByteSize() + m_stripDrawing.byteSize();
 }
 
 size_t PolygonTriangleStrip::vertexByteSize() const
@@ -235,10 +254,33 @@ size_t PolygonTriangleStrip::componentCount() const
 
 void PolygonTriangleStrip::resize(size_t count)
 {
+    m_position.clear();
+    m_normal.clear();
+    m_colorValue.clear();
+
     m_multiStarts.resize(3 * count);
     m_multiCounts.resize(3 * count);
 }
 
+size_t PolygonTriangleStrip::cpuByteSize() const
+{
+    return containerByteSize(m_position)
+        + containerByteSize(m_normal)
+        + containerByteSize(m_colorValue)
+        + containerByteSize(m_multiStarts)
+        + containerByteSize(m_multiCounts);
+}
+
+std::vector<gl::GLuint> PolygonTriangleStrip::buffers() const
+{
+    if (m_stripDrawing.buffer() != 0)
+    {
+        return { m_vertices, m_stripDrawing.buffer() };
+    }
+
+    return { m_vertices };
+}
+
 void PolygonTriangleStrip::onRender()
 {
     glBindVertexArray(m_vao);
@@ -253,7 +295,7 @@ void PolygonTriangleStrip::onRender()
     glDepthMask(GL_TRUE);
 
     glUseProgram(m_program);
-    glMultiDrawArrays(GL_TRIANGLE_STRIP, m_multiStarts.data(), m_multiCounts.data(), m_multiStarts.size());
+    m_stripDrawing.draw(m_multiStarts, m_multiCounts);
 
     glUseProgram(0);
 
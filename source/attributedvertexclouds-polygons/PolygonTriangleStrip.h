@@ -11,12 +11,13 @@
 
 #include "Polygon.h"
 #include "PolygonImplementation.h"
+#include "StripDrawing.h"
 
 
 class PolygonTriangleStrip : public PolygonImplementation
 {
 public:
-    PolygonTriangleStrip();
+    PolygonTriangleStrip(StripDrawMode mode);
     ~PolygonTriangleStrip();
 
     virtual void onInitialize() override;
@@ -32,9 +33,12 @@ public:
     virtual size_t byteSize() const override;
     virtual size_t vertexByteSize() const override;
     virtual size_t componentCount() const override;
+    virtual size_t cpuByteSize() const override;
 
     virtual void resize(size_t count) override;
 
+    virtual std::vector<gl::GLuint> buffers() const override;
+
     virtual gl::GLuint program() const override;
 public:
     std::vector<glm::vec3> m_position;
@@ -44,6 +48,8 @@ public:
     std::vector<gl::GLint> m_multiStarts;
     std::vector<gl::GLint> m_multiCounts;
 
+    StripDrawing m_stripDrawing;
+
     gl::GLuint m_vertices;
     gl::GLuint m_vao;
 
@@ -18,6 +18,11 @@ PolygonTriangles::PolygonTriangles()
 
 PolygonTriangles::~PolygonTriangles()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteVertexArrays(1, &m_vao);
 
@@ -216,7 +221,22 @@ size_t PolygonTriangles::componentCount() const
 
 void PolygonTriangles::resize(size_t /*count*/)
 {
-    // TODO: should implement
+    // Vertices are appended by setPolygon as their number depends on the polygons
+    m_position.clear();
+    m_normal.clear();
+    m_colorValue.clear();
+}
+
+size_t PolygonTriangles::cpuByteSize() const
+{
+    return containerByteSize(m_position)
+        + containerByteSize(m_normal)
+        + containerByteSize(m_colorValue);
+}
+
+std::vector<gl::GLuint> PolygonTriangles::buffers() const
+{
+    return { m_vertices };
 }
 
 void PolygonTriangles::onRender()
@@ -23,6 +23,11 @@ PolygonVertexCloud::PolygonVertexCloud()
 
 PolygonVertexCloud::~PolygonVertexCloud()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteBuffers(1, &m_centerHeightRangeBuffer);
     glDeleteBuffers(1, &m_colorValueBuffer);
@@ -233,6 +238,23 @@ void PolygonVertexCloud::resize(size_t count)
     m_center.resize(count);
     m_heightRange.resize(count);
     m_colorValue.resize(count);
+
+    m_positions.clear();
+    m_polygonIndices.clear();
+}
+
+size_t PolygonVertexCloud::cpuByteSize() const
+{
+    return containerByteSize(m_center)
+        + containerByteSize(m_heightRange)
+        + containerByteSize(m_colorValue)
+        + containerByteSize(m_positions)
+        + containerByteSize(m_polygonIndices);
+}
+
+std::vector<gl::GLuint> PolygonVertexCloud::buffers() const
+{
+    return { m_vertices, m_centerHeightRangeBuffer, m_colorValueBuffer };
 }
 
 void PolygonVertexCloud::onRender()
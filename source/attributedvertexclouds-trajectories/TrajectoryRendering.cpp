@@ -11,6 +11,7 @@
 #include <glbinding/gl/gl.h>
 
 #include "common.h"
+#include "PrimitiveGrid.h"
 
 #include "TrajectoryVertexCloud.h"
 
@@ -41,9 +42,21 @@ TrajectoryRendering::~TrajectoryRendering()
 {
 }
 
+Implementation * TrajectoryRendering::createImplementation(size_t index)
+{
+    switch (index)
+    {
+    case 0: return new TrajectoryVertexCloud;
+    default: return nullptr;
+    }
+}
+
 void TrajectoryRendering::onInitialize()
 {
-    addImplementation(new TrajectoryVertexCloud);
+    for (auto index = size_t(0); auto implementation = createImplementation(index); ++index)
+    {
+        addImplementation(implementation);
+    }
 
     glGenTextures(1, &m_gradientTexture);
 
@@ -70,20 +83,21 @@ void TrajectoryRendering::onDeinitialize()
 
 void TrajectoryRendering::onCreateGeometry()
 {
-    const auto trajectoryGridSize = static_cast<std::size_t>(m_gridSize);
-    const auto trajectoryCount = static_cast<std::size_t>(trajectoryGridSize * trajectoryGridSize);
+    createGeometry(m_primitiveCount, geometryImplementations());
+}
+
+void TrajectoryRendering::createGeometry(size_t trajectoryCount, const std::vector<Implementation *> & implementations)
+{
+    auto grid = PrimitiveGrid(trajectoryCount, 2);
+    const auto trajectoryGridSize = static_cast<std::size_t>(grid.size().x);
     const auto worldScale = glm::vec3(1.0f) / glm::vec3(trajectoryGridSize, trajectoryGridSize, trajectoryGridSize);
 
-    for (auto implementation : m_implementations)
+    for (auto implementation : implementations)
     {
         implementation->resize(trajectoryCount);
     }
 
-    std::array<std::vector<float>, 3> noise;
-    for (auto i = size_t(0); i < noise.size(); ++i)
-    {
-        noise[i] = loadNoise("/noise-"+std::to_string(trajectoryGridSize)+"-"+std::to_string(i)+".raw");
-    }
+    grid.loadNoise(3);
 
 #pragma omp parallel for
     for (size_t i = 0; i < trajectoryCount; ++i)
@@ -103,17 +117,22 @@ void TrajectoryRendering::onCreateGeometry()
             radius * glm::sin(2.0f * glm::pi<float>() * angle)
         );
         t.trajectoryID = position.x;
-        t.type = noise[0][i] > 0.0f ? 2 : 1;
-        t.sizeValue = glm::mix(0.3f, 0.9f, noise[1][i]) * worldScale.x;
-        t.colorValue = noise[2][i];
+        t.type = grid.noise(0, i) > 0.0f ? 2 : 1;
+        t.sizeValue = glm::mix(0.3f, 0.9f, grid.noise(1, i)) * worldScale.x;
+        t.colorValue = grid.noise(2, i);
 
-        for (auto implementation : m_implementations)
+        for (auto implementation : implementations)
         {
             static_cast<TrajectoryVertexCloud*>(implementation)->setTrajectoryNode(i, t);
         }
     }
 }
 
+size_t TrajectoryRendering::gridPrimitiveCount(int gridSize) const
+{
+    return static_cast<size_t>(gridSize) * gridSize;
+}
+
 void TrajectoryRendering::onPrepareRendering()
 {
     GLuint program = m_current->program();
@@ -1,4 +1,6 @@
 
+#pragma once
+
 #include <chrono>
 
 #include <glbinding/gl/types.h>
@@ -12,6 +14,15 @@ public:
     TrajectoryRendering();
     virtual ~TrajectoryRendering();
 
+    // Fills the implementations with a trajectory bundle of the given number of nodes; needs no GL context
+    static void createGeometry(size_t primitiveCount, const std::vector<Implementation *> & implementations);
+
+    // Creates the technique at the given position of the demo's list, or nullptr past its end; needs no GL context
+    static Implementation * createImplementation(size_t index);
+
+    // The trajectory bundle is a square grid of nodes
+    virtual size_t gridPrimitiveCount(int gridSize) const override;
+
 protected:
     gl::GLuint m_gradientTexture;
 
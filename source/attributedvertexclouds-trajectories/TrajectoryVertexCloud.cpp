@@ -21,6 +21,11 @@ TrajectoryVertexCloud::TrajectoryVertexCloud()
 
 TrajectoryVertexCloud::~TrajectoryVertexCloud()
 {
+    if (!initialized())
+    {
+        return;
+    }
+
     glDeleteBuffers(1, &m_vertices);
     glDeleteVertexArrays(1, &m_vao);
     glDeleteShader(m_vertexShader);
@@ -254,6 +259,22 @@ void TrajectoryVertexCloud::resize(size_t count)
     m_sizeValue.resize(count);
 }
 
+size_t TrajectoryVertexCloud::cpuByteSize() const
+{
+    return containerByteSize(m_position)
+        + containerByteSize(m_trajectoryID)
+        + containerByteSize(m_type)
+        + containerByteSize(m_incoming)
+        + containerByteSize(m_outgoing)
+        + containerByteSize(m_colorValue)
+        + containerByteSize(m_sizeValue);
+}
+
+std::vector<gl::GLuint> TrajectoryVertexCloud::buffers() const
+{
+    return { m_vertices };
+}
+
 void TrajectoryVertexCloud::onRender()
 {
     glBindVertexArray(m_vao);
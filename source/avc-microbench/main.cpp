@@ -0,0 +1,278 @@
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+#include "common.h"
+#include "Implementation.h"
+#include "Measurement.h"
+
+#include "CuboidRendering.h"
+#include "BlockWorldRendering.h"
+#include "PolygonRendering.h"
+#include "ArcRendering.h"
+#include "TrajectoryRendering.h"
+
+
+// Times the CPU side of the geometry creation of all demos without creating a GL context:
+// the scene generation alone and together with the set* calls of each technique,
+// for each primitive count and thread count.
+namespace
+{
+
+
+static const auto repetitionCount = size_t(7);
+
+// Technique name used for the scene generation without any technique attached
+static const auto generationOnly = std::string("Generation");
+
+
+using CreateGeometry = std::function<void(size_t, const std::vector<Implementation *> &)>;
+using CreateImplementation = std::function<Implementation *(size_t)>;
+using PrimitiveCount = std::function<size_t(int)>;
+
+
+size_t cubicPrimitiveCount(int gridSize)
+{
+    return static_cast<size_t>(gridSize * gridSize * gridSize);
+}
+
+size_t quadraticPrimitiveCount(int gridSize)
+{
+    return static_cast<size_t>(gridSize * gridSize);
+}
+
+std::vector<int> threadCounts()
+{
+    auto counts = std::vector<int>();
+
+#ifdef USE_OPENMP
+    const auto maxThreads = omp_get_max_threads();
+
+    for (auto count = 1; count < maxThreads; count *= 2)
+    {
+        counts.push_back(count);
+    }
+
+    counts.push_back(maxThreads);
+#else
+    counts.push_back(1);
+#endif
+
+    return counts;
+}
+
+void setThreadCount(int count)
+{
+#ifdef USE_OPENMP
+    omp_set_num_threads(count);
+#else
+    (void)count;
+#endif
+}
+
+size_t measureCreateGeometry(const CreateGeometry & createGeometry, size_t primitiveCount, const std::vector<Implementation *> & implementations)
+{
+    auto measurement = Measurement();
+    measurement.reset(repetitionCount);
+
+    // Untimed first run to load the noise into the file cache and to allocate the technique buffers
+    createGeometry(primitiveCount, implementations);
+
+    while (!measurement.full())
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        createGeometry(primitiveCount, implementations);
+
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        measurement.add(static_cast<size_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+    }
+
+    return static_cast<size_t>(measurement.statistics().median);
+}
+
+void writeResult(const std::string & executable, const std::string & technique, size_t primitiveCount, int threads, size_t time, size_t singleThreadTime, size_t bytesWritten)
+{
+    std::cout << executable << ","
+        << technique << ","
+        << primitiveCount << ","
+        << threads << ","
+        << time << ","
+        << (static_cast<double>(time) / primitiveCount) << ","
+        << bytesWritten << ","
+        << (time > 0 ? static_cast<double>(bytesWritten) / time : 0.0) << ","
+        << (time > 0 ? static_cast<double>(singleThreadTime) / time : 0.0) << std::endl;
+}
+
+void benchmark(const std::string & executable, const CreateGeometry & createGeometry, const CreateImplementation & createImplementation, const std::vector<size_t> & primitiveCounts)
+{
+    const auto threads = threadCounts();
+
+    for (const auto count : primitiveCounts)
+    {
+        auto singleThreadTime = size_t(0);
+
+        for (const auto threadCount : threads)
+        {
+            setThreadCount(threadCount);
+
+            const auto time = measureCreateGeometry(createGeometry, count, std::vector<Implementation *>());
+
+            singleThreadTime = threadCount == threads.front() ? time : singleThreadTime;
+
+            writeResult(executable, generationOnly, count, threadCount, time, singleThreadTime, 0);
+        }
+
+        for (auto index = size_t(0); ; ++index)
+        {
+            const auto implementation = createImplementation(index);
+
+            if (implementation == nullptr)
+            {
+                break;
+            }
+
+            for (const auto threadCount : threads)
+            {
+                setThreadCount(threadCount);
+
+                const auto time = measureCreateGeometry(createGeometry, count, std::vector<Implementation *>(1, implementation));
+
+                singleThreadTime = threadCount == threads.front() ? time : singleThreadTime;
+
+                writeResult(executable, implementation->name(), count, threadCount, time, singleThreadTime, implementation->byteSize());
+            }
+
+            // Never initialized, so the destructor issues no GL calls
+            delete implementation;
+        }
+    }
+}
+
+
+} // namespace
+
+
+int main(int argc, char ** argv)
+{
+    std::vector<int> gridSizes;
+    std::vector<size_t> primitiveCounts;
+    std::vector<std::string> executables;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument(argv[i]);
+
+        if (argument == "--count" && i + 1 < argc && parseCount(argv[i + 1]) > 0)
+        {
+            primitiveCounts.push_back(parseCount(argv[++i]));
+        }
+        else if (argument == "xxs")
+        {
+            gridSizes.push_back(2);
+        }
+        else if (argument == "xs")
+        {
+            gridSizes.push_back(8);
+        }
+        else if (argument == "s")
+        {
+            gridSizes.push_back(16);
+        }
+        else if (argument == "m")
+        {
+            gridSizes.push_back(32);
+        }
+        else if (argument == "l")
+        {
+            gridSizes.push_back(48);
+        }
+        else if (argument == "xl")
+        {
+            gridSizes.push_back(100);
+        }
+        else if (argument == "cuboids" || argument == "oriented-cuboids" || argument == "blockworld" || argument == "polygons" || argument == "arcs" || argument == "trajectories")
+        {
+            executables.push_back(argument);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [xxs|xs|s|m|l|xl] [--count <n>] [cuboids|oriented-cuboids|blockworld|polygons|arcs|trajectories]" << std::endl;
+
+            return 1;
+        }
+    }
+
+    if (gridSizes.empty() && primitiveCounts.empty())
+    {
+        gridSizes = { 2, 8, 16, 32, 48, 100 };
+    }
+
+    // Grid size presets map to a different primitive count per demo
+    const auto counts = [&gridSizes, &primitiveCounts](const PrimitiveCount & gridPrimitiveCount) {
+        auto result = std::vector<size_t>();
+
+        for (const auto gridSize : gridSizes)
+        {
+            result.push_back(gridPrimitiveCount(gridSize));
+        }
+
+        result.insert(result.end(), primitiveCounts.begin(), primitiveCounts.end());
+
+        return result;
+    };
+
+    const auto selected = [&executables](const std::string & executable) {
+        return executables.empty() || std::find(executables.begin(), executables.end(), executable) != executables.end();
+    };
+
+    std::cout << "executable,technique,primitiveCount,threads,medianNs,nsPerPrimitive,bytesWritten,bytesPerNs,speedup" << std::endl;
+
+    if (selected("cuboids"))
+    {
+        benchmark("Cuboids", [](size_t count, const std::vector<Implementation *> & implementations) {
+            CuboidRendering::createGeometry(count, implementations, false);
+        }, CuboidRendering::createImplementation, counts(cubicPrimitiveCount));
+    }
+
+    // Rotated cuboids leave the vectorized expansion of the triangle techniques
+    if (selected("oriented-cuboids"))
+    {
+        benchmark("OrientedCuboids", [](size_t count, const std::vector<Implementation *> & implementations) {
+            CuboidRendering::createGeometry(count, implementations, true);
+        }, CuboidRendering::createImplementation, counts(cubicPrimitiveCount));
+    }
+
+    if (selected("blockworld"))
+    {
+        benchmark("BlockWorld", [](size_t count, const std::vector<Implementation *> & implementations) {
+            BlockWorldRendering::createGeometry(count, implementations, BlockWorldRendering::initialBlockThreshold);
+        }, BlockWorldRendering::createImplementation, counts(cubicPrimitiveCount));
+    }
+
+    if (selected("polygons"))
+    {
+        benchmark("Polygons", PolygonRendering::createGeometry, PolygonRendering::createImplementation, counts(cubicPrimitiveCount));
+    }
+
+    if (selected("arcs"))
+    {
+        benchmark("Arcs", ArcRendering::createGeometry, ArcRendering::createImplementation, counts(cubicPrimitiveCount));
+    }
+
+    if (selected("trajectories"))
+    {
+        benchmark("Trajectories", TrajectoryRendering::createGeometry, TrajectoryRendering::createImplementation, counts(quadraticPrimitiveCount));
+    }
+
+    return 0;
+}
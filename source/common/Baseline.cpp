@@ -0,0 +1,261 @@
+
+#include "Baseline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "common.h"
+
+
+namespace
+{
+
+
+static const auto versionLine = std::string("# attributedvertexclouds-baseline 2");
+
+// Columns identifying a row; all of them have to be present in the benchmark CSV
+static const char * keyColumns[] = { "executable", "technique", "primitiveCount", "cameraPreset" };
+
+// Lower is better for all compared metrics
+static const char * comparedColumns[] = {
+    "createGeometryNs",
+    "initializeNs",
+    "geometryMedianNs",
+    "frameMedianNs",
+    "gpuByteSize",
+    "cpuByteSize",
+    "peakResidentSetSizeDuringGeometry"
+};
+
+
+} // namespace
+
+
+Baseline::Baseline()
+{
+}
+
+bool Baseline::loadBenchmark(const std::string & filename)
+{
+    auto stream = std::ifstream(filename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open benchmark file '" << filename << "'." << std::endl;
+
+        return false;
+    }
+
+    return read(stream, filename);
+}
+
+bool Baseline::load(const std::string & filename)
+{
+    auto stream = std::ifstream(filename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open baseline file '" << filename << "'." << std::endl;
+
+        return false;
+    }
+
+    auto line = std::string();
+    std::getline(stream, line);
+
+    if (line != versionLine)
+    {
+        std::cerr << "Baseline file '" << filename << "' has an unsupported version; expected '" << versionLine << "'." << std::endl;
+
+        return false;
+    }
+
+    return read(stream, filename);
+}
+
+bool Baseline::save(const std::string & filename) const
+{
+    auto stream = std::ofstream(filename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open output file '" << filename << "'." << std::endl;
+
+        return false;
+    }
+
+    const auto writeLine = [&stream](const std::vector<std::string> & values) {
+        for (auto i = size_t(0); i < values.size(); ++i)
+        {
+            stream << (i > 0 ? "," : "") << values[i];
+        }
+
+        stream << std::endl;
+    };
+
+    stream << versionLine << std::endl;
+
+    writeLine(m_columns);
+
+    for (const auto & row : m_rows)
+    {
+        writeLine(row.second);
+    }
+
+    std::cout << "Baseline with " << m_rows.size() << " entries written to " << filename << std::endl;
+
+    return true;
+}
+
+bool Baseline::read(std::istream & stream, const std::string & filename)
+{
+    auto line = std::string();
+
+    if (!std::getline(stream, line))
+    {
+        std::cerr << "File '" << filename << "' is empty." << std::endl;
+
+        return false;
+    }
+
+    m_columns = splitLine(line, ',');
+    m_rows.clear();
+
+    for (const auto column : keyColumns)
+    {
+        if (std::find(m_columns.begin(), m_columns.end(), column) == m_columns.end())
+        {
+            std::cerr << "File '" << filename << "' lacks the column '" << column << "'." << std::endl;
+
+            return false;
+        }
+    }
+
+    while (std::getline(stream, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+
+        auto values = splitLine(line, ',');
+        values.resize(m_columns.size());
+
+        m_rows[key(values)] = values;
+    }
+
+    return true;
+}
+
+std::string Baseline::key(const std::vector<std::string> & values) const
+{
+    auto result = std::string();
+
+    for (const auto column : keyColumns)
+    {
+        const auto index = static_cast<size_t>(std::find(m_columns.begin(), m_columns.end(), column) - m_columns.begin());
+
+        result += (result.empty() ? "" : " ") + values[index];
+    }
+
+    return result;
+}
+
+bool Baseline::value(const std::vector<std::string> & values, const std::string & column, double & result) const
+{
+    const auto index = static_cast<size_t>(std::find(m_columns.begin(), m_columns.end(), column) - m_columns.begin());
+
+    if (index >= values.size() || values[index].empty())
+    {
+        return false;
+    }
+
+    result = std::strtod(values[index].c_str(), nullptr);
+
+    return true;
+}
+
+size_t Baseline::compare(const Baseline & reference, double threshold, bool strict, std::ostream & stream) const
+{
+    auto regressions = size_t(0);
+    auto improvements = size_t(0);
+    auto missing = size_t(0);
+
+    // The caller's formatting is restored at the end
+    const auto flags = stream.flags();
+    const auto precision = stream.precision();
+
+    stream << std::left << std::setw(48) << "entry" << std::setw(36) << "metric"
+        << std::right << std::setw(16) << "baseline" << std::setw(16) << "current" << std::setw(10) << "change" << std::endl;
+
+    for (const auto & referenceRow : reference.m_rows)
+    {
+        const auto row = m_rows.find(referenceRow.first);
+
+        // Entries the run did not measure, e.g., of other sizes, are skipped; strict comparisons fail on them, e.g., for a technique that crashed
+        if (row == m_rows.end())
+        {
+            ++missing;
+
+            if (!strict)
+            {
+                continue;
+            }
+
+            stream << std::left << std::setw(48) << referenceRow.first << std::setw(36) << "-"
+                << std::right << std::setw(16) << "-" << std::setw(16) << "-" << std::setw(10) << "-" << "  MISSING" << std::endl;
+
+            continue;
+        }
+
+        for (const auto column : comparedColumns)
+        {
+            auto before = 0.0;
+            auto after = 0.0;
+
+            if (!reference.value(referenceRow.second, column, before) || !value(row->second, column, after) || before <= 0.0)
+            {
+                continue;
+            }
+
+            const auto change = (after - before) / before;
+
+            if (std::abs(change) <= threshold)
+            {
+                continue;
+            }
+
+            if (change > 0.0)
+            {
+                ++regressions;
+            }
+            else
+            {
+                ++improvements;
+            }
+
+            stream << std::left << std::setw(48) << referenceRow.first << std::setw(36) << column
+                << std::right << std::setw(16) << std::fixed << std::setprecision(0) << before << std::setw(16) << after
+                << std::setw(9) << std::showpos << std::setprecision(1) << (change * 100.0) << "%" << std::noshowpos
+                << (change > 0.0 ? "  REGRESSION" : "") << std::endl;
+        }
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+
+    stream << regressions << " regressions and " << improvements << " improvements beyond " << (threshold * 100.0) << "%";
+
+    if (missing > 0)
+    {
+        stream << "; " << missing << " baseline entries were not benchmarked" << (strict ? "" : " and skipped");
+    }
+
+    stream << std::endl;
+
+    return strict ? regressions + missing : regressions;
+}
@@ -0,0 +1,34 @@
+
+#pragma once
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+
+// Benchmark results as written by Rendering::benchmark, keyed by executable, technique, primitive count and camera preset.
+// Baseline files are the benchmark CSV preceded by a version line.
+class Baseline
+{
+public:
+    Baseline();
+
+    bool loadBenchmark(const std::string & filename);
+    bool load(const std::string & filename);
+    bool save(const std::string & filename) const;
+
+    // Prints a table of all metrics of the entries in both that changed by more than the relative threshold; returns the
+    // number of regressions, i.e., metrics that increased beyond it. Strict comparisons also list and count the reference
+    // entries missing from these results, e.g., of a technique that crashed, which are skipped otherwise.
+    size_t compare(const Baseline & reference, double threshold, bool strict, std::ostream & stream) const;
+
+protected:
+    std::vector<std::string> m_columns;
+    std::map<std::string, std::vector<std::string>> m_rows;
+
+    bool read(std::istream & stream, const std::string & filename);
+
+    std::string key(const std::vector<std::string> & values) const;
+    bool value(const std::vector<std::string> & values, const std::string & column, double & result) const;
+};
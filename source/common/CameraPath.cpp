@@ -0,0 +1,159 @@
+
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+
+namespace
+{
+
+
+glm::vec3 catmullRom(const glm::vec3 & p0, const glm::vec3 & p1, const glm::vec3 & p2, const glm::vec3 & p3, float t)
+{
+    const auto t2 = t * t;
+    const auto t3 = t2 * t;
+
+    return 0.5f * ((2.0f * p1)
+        + (p2 - p0) * t
+        + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2
+        + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+
+} // namespace
+
+
+CameraKeyframe::CameraKeyframe()
+: frame(0)
+, eye(0.0f, 0.0f, 0.0f)
+, center(0.0f, 0.0f, 0.0f)
+, up(0.0f, 1.0f, 0.0f)
+{
+}
+
+
+CameraPath::CameraPath()
+{
+}
+
+bool CameraPath::load(const std::string & filename)
+{
+    auto stream = std::ifstream(filename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open camera path '" << filename << "'." << std::endl;
+
+        return false;
+    }
+
+    auto keyframes = std::vector<CameraKeyframe>();
+    auto line = std::string();
+    auto lineNumber = size_t(0);
+
+    while (std::getline(stream, line))
+    {
+        ++lineNumber;
+
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        auto lineStream = std::istringstream(line);
+        auto keyframe = CameraKeyframe();
+
+        lineStream >> keyframe.frame
+            >> keyframe.eye.x >> keyframe.eye.y >> keyframe.eye.z
+            >> keyframe.center.x >> keyframe.center.y >> keyframe.center.z;
+
+        if (lineStream.fail())
+        {
+            std::cerr << filename << ":" << lineNumber << ": expected frame, eye and center" << std::endl;
+
+            return false;
+        }
+
+        auto up = glm::vec3(0.0f, 0.0f, 0.0f);
+
+        if (lineStream >> up.x >> up.y >> up.z)
+        {
+            keyframe.up = up;
+        }
+
+        if (!keyframes.empty() && keyframe.frame <= keyframes.back().frame)
+        {
+            std::cerr << filename << ":" << lineNumber << ": keyframes have to be in increasing frame order" << std::endl;
+
+            return false;
+        }
+
+        keyframes.push_back(keyframe);
+    }
+
+    if (keyframes.empty())
+    {
+        std::cerr << "Camera path '" << filename << "' has no keyframes." << std::endl;
+
+        return false;
+    }
+
+    m_keyframes = keyframes;
+
+    std::cout << "Loaded camera path with " << m_keyframes.size() << " keyframes over " << frameCount() << " frames" << std::endl;
+
+    return true;
+}
+
+bool CameraPath::empty() const
+{
+    return m_keyframes.empty();
+}
+
+size_t CameraPath::frameCount() const
+{
+    return m_keyframes.empty() ? 0 : m_keyframes.back().frame + 1;
+}
+
+void CameraPath::camera(size_t frame, glm::vec3 & eye, glm::vec3 & center, glm::vec3 & up) const
+{
+    frame = frame % frameCount();
+
+    // First keyframe after the requested frame
+    const auto next = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), frame, [](size_t f, const CameraKeyframe & keyframe) {
+        return f < keyframe.frame;
+    });
+
+    if (next == m_keyframes.begin() || next == m_keyframes.end())
+    {
+        const auto & keyframe = next == m_keyframes.end() ? m_keyframes.back() : m_keyframes.front();
+
+        eye = keyframe.eye;
+        center = keyframe.center;
+        up = keyframe.up;
+
+        return;
+    }
+
+    const auto i2 = static_cast<size_t>(next - m_keyframes.begin());
+    const auto i1 = i2 - 1;
+    const auto i0 = i1 > 0 ? i1 - 1 : i1;
+    const auto i3 = std::min(i2 + 1, m_keyframes.size() - 1);
+
+    const auto & k0 = m_keyframes[i0];
+    const auto & k1 = m_keyframes[i1];
+    const auto & k2 = m_keyframes[i2];
+    const auto & k3 = m_keyframes[i3];
+
+    const auto t = static_cast<float>(frame - k1.frame) / static_cast<float>(k2.frame - k1.frame);
+
+    eye = catmullRom(k0.eye, k1.eye, k2.eye, k3.eye, t);
+    center = catmullRom(k0.center, k1.center, k2.center, k3.center, t);
+    up = glm::normalize(glm::mix(k1.up, k2.up, t));
+}
@@ -0,0 +1,40 @@
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+
+class CameraKeyframe
+{
+public:
+    CameraKeyframe();
+
+    size_t frame;
+    glm::vec3 eye;
+    glm::vec3 center;
+    glm::vec3 up;
+};
+
+
+// Camera path keyed by frame index, so each run renders the same sequence of views.
+// Files list one keyframe per line: "frame eyeX eyeY eyeZ centerX centerY centerZ [upX upY upZ]";
+// lines starting with '#' are ignored. Positions are interpolated with a Catmull-Rom spline
+// and the path repeats after the last keyframe.
+class CameraPath
+{
+public:
+    CameraPath();
+
+    bool load(const std::string & filename);
+
+    bool empty() const;
+    size_t frameCount() const;
+
+    void camera(size_t frame, glm::vec3 & eye, glm::vec3 & center, glm::vec3 & up) const;
+
+protected:
+    std::vector<CameraKeyframe> m_keyframes;
+};
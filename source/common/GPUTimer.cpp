@@ -0,0 +1,129 @@
+
+#include "GPUTimer.h"
+
+#include <glbinding/gl/gl.h>
+
+#include "Trace.h"
+
+
+using namespace gl;
+
+
+GPUTimer::GPUTimer()
+: m_oldest(0)
+, m_pending(0)
+, m_dropped(0)
+, m_active(false)
+{
+}
+
+GPUTimer::~GPUTimer()
+{
+}
+
+bool GPUTimer::initialized() const
+{
+    return !m_queries.empty();
+}
+
+void GPUTimer::initialize(size_t ringSize)
+{
+    m_queries.resize(ringSize);
+
+    glGenQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+
+    m_oldest = 0;
+    m_pending = 0;
+    m_dropped = 0;
+    m_active = false;
+}
+
+void GPUTimer::deinitialize()
+{
+    glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+
+    m_queries.clear();
+}
+
+void GPUTimer::begin()
+{
+    if (m_pending == m_queries.size())
+    {
+        ++m_dropped;
+
+        Trace::instance().count("droppedTimerFrames");
+
+        return;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[(m_oldest + m_pending) % m_queries.size()]);
+
+    m_active = true;
+}
+
+void GPUTimer::end()
+{
+    if (!m_active)
+    {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+
+    m_active = false;
+    ++m_pending;
+}
+
+void GPUTimer::collect(const std::function<void(size_t)> & callback)
+{
+    collect(callback, false);
+}
+
+void GPUTimer::flush(const std::function<void(size_t)> & callback)
+{
+    collect(callback, true);
+}
+
+void GPUTimer::discard()
+{
+    flush([](size_t) { });
+
+    m_dropped = 0;
+}
+
+void GPUTimer::collect(const std::function<void(size_t)> & callback, bool wait)
+{
+    while (m_pending > 0)
+    {
+        const auto query = m_queries[m_oldest];
+
+        if (!wait)
+        {
+            auto available = static_cast<GLint>(0);
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+            if (!available)
+            {
+                return;
+            }
+        }
+
+        auto value = static_cast<GLuint64>(0);
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &value);
+
+        m_oldest = (m_oldest + 1) % m_queries.size();
+        --m_pending;
+
+        callback(static_cast<size_t>(value));
+    }
+}
+
+size_t GPUTimer::pending() const
+{
+    return m_pending;
+}
+
+size_t GPUTimer::dropped() const
+{
+    return m_dropped;
+}
@@ -0,0 +1,47 @@
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <glbinding/gl/types.h>
+
+
+// Ring of GL_TIME_ELAPSED queries whose results are read back a few frames later.
+// Neither begin() nor collect() wait for the GPU; if all queries of the ring are still in flight,
+// the frame is not timed and counted as dropped instead.
+class GPUTimer
+{
+public:
+    GPUTimer();
+    ~GPUTimer();
+
+    bool initialized() const;
+
+    void initialize(size_t ringSize);
+    void deinitialize();
+
+    void begin();
+    void end();
+
+    // Passes all available results, in submission order, to the callback without blocking
+    void collect(const std::function<void(size_t)> & callback);
+    // Waits for all pending results and passes them to the callback
+    void flush(const std::function<void(size_t)> & callback);
+    // Forgets pending results, e.g., when switching what is timed
+    void discard();
+
+    size_t pending() const;
+    size_t dropped() const;
+
+protected:
+    std::vector<gl::GLuint> m_queries;
+
+    size_t m_oldest;
+    size_t m_pending;
+    size_t m_dropped;
+    bool m_active;
+
+    void collect(const std::function<void(size_t)> & callback, bool wait);
+};
@@ -0,0 +1,229 @@
+
+#include "HeadlessContext.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifdef USE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+
+#ifdef USE_EGL
+
+
+namespace
+{
+
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+
+bool hasExtension(const char * extensions, const char * name)
+{
+    if (extensions == nullptr)
+    {
+        return false;
+    }
+
+    const auto length = std::strlen(name);
+
+    for (auto extension = std::strstr(extensions, name); extension != nullptr; extension = std::strstr(extension + length, name))
+    {
+        const auto begins = extension == extensions || extension[-1] == ' ';
+        const auto ends = extension[length] == ' ' || extension[length] == '\0';
+
+        if (begins && ends)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The first GPU device, then Mesa's surfaceless platform, then the default display, which may need a window system
+EGLDisplay openDisplay()
+{
+    const auto extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+    const auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+    if (getPlatformDisplay != nullptr && hasExtension(extensions, "EGL_EXT_platform_device"))
+    {
+        const auto queryDevices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(eglGetProcAddress("eglQueryDevicesEXT"));
+
+        auto deviceCount = EGLint(0);
+
+        if (queryDevices != nullptr && queryDevices(0, nullptr, &deviceCount) && deviceCount > 0)
+        {
+            auto devices = std::vector<EGLDeviceEXT>(static_cast<size_t>(deviceCount));
+
+            queryDevices(deviceCount, devices.data(), &deviceCount);
+
+            const auto display = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices.front(), nullptr);
+
+            if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+            {
+                return display;
+            }
+        }
+    }
+
+    if (getPlatformDisplay != nullptr && hasExtension(extensions, "EGL_MESA_platform_surfaceless"))
+    {
+        const auto display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+        {
+            return display;
+        }
+    }
+
+    const auto display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+    {
+        return display;
+    }
+
+    return EGL_NO_DISPLAY;
+}
+
+
+} // namespace
+
+
+#endif
+
+
+HeadlessContext::HeadlessContext()
+: m_display(nullptr)
+, m_surface(nullptr)
+, m_context(nullptr)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    destroy();
+}
+
+bool HeadlessContext::available()
+{
+#ifdef USE_EGL
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool HeadlessContext::create(int majorVersion, int minorVersion)
+{
+#ifdef USE_EGL
+    const auto display = openDisplay();
+
+    if (display == EGL_NO_DISPLAY)
+    {
+        std::cerr << "No EGL display available" << std::endl;
+
+        return false;
+    }
+
+    m_display = display;
+
+    static const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+
+    auto config = EGLConfig();
+    auto configCount = EGLint(0);
+
+    if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cerr << "No EGL configuration for desktop OpenGL available" << std::endl;
+
+        destroy();
+
+        return false;
+    }
+
+    static const EGLint surfaceAttributes[] = {
+        EGL_WIDTH, 1,
+        EGL_HEIGHT, 1,
+        EGL_NONE
+    };
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, majorVersion,
+        EGL_CONTEXT_MINOR_VERSION_KHR, minorVersion,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_CONTEXT_FLAGS_KHR, EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE_BIT_KHR,
+        EGL_NONE
+    };
+
+    m_surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    m_context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+
+    if (m_surface == EGL_NO_SURFACE || m_context == EGL_NO_CONTEXT || !eglMakeCurrent(display, m_surface, m_surface, m_context))
+    {
+        std::cerr << "Creating an OpenGL " << majorVersion << "." << minorVersion << " core context with EGL failed (error 0x"
+            << std::hex << eglGetError() << std::dec << ")" << std::endl;
+
+        destroy();
+
+        return false;
+    }
+
+    return true;
+#else
+    std::cerr << "Built without OPTION_HEADLESS_EGL, no OpenGL " << majorVersion << "." << minorVersion << " context without a window" << std::endl;
+
+    return false;
+#endif
+}
+
+void HeadlessContext::destroy()
+{
+#ifdef USE_EGL
+    if (m_display == nullptr)
+    {
+        return;
+    }
+
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (m_context != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(m_display, m_context);
+    }
+
+    if (m_surface != EGL_NO_SURFACE)
+    {
+        eglDestroySurface(m_display, m_surface);
+    }
+
+    eglTerminate(m_display);
+#endif
+
+    m_display = nullptr;
+    m_surface = nullptr;
+    m_context = nullptr;
+}
+
+HeadlessContext::ProcAddress HeadlessContext::procAddress(const char * name)
+{
+#ifdef USE_EGL
+    return eglGetProcAddress(name);
+#else
+    (void)name;
+
+    return nullptr;
+#endif
+}
@@ -0,0 +1,29 @@
+
+#pragma once
+
+
+// An OpenGL core profile context on an EGL display that needs no window system, e.g., a GPU render node.
+// Renders into framebuffer objects only; the surface is a single pixel pbuffer.
+// Available when built with OPTION_HEADLESS_EGL, otherwise create() always fails.
+class HeadlessContext
+{
+public:
+    using ProcAddress = void (*)();
+
+    HeadlessContext();
+    ~HeadlessContext();
+
+    static bool available();
+
+    // Creates the context and makes it current; prints the reason and returns false on failure
+    bool create(int majorVersion, int minorVersion);
+    void destroy();
+
+    // For glbinding::initialize()
+    static ProcAddress procAddress(const char * name);
+
+protected:
+    void * m_display;
+    void * m_surface;
+    void * m_context;
+};
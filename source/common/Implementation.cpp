@@ -1,6 +1,13 @@
 
 #include "Implementation.h"
 
+#include <glbinding/gl/gl.h>
+
+#include "Trace.h"
+
+
+using namespace gl;
+
 
 Implementation::Implementation(const std::string & name)
 : m_name(name)
@@ -26,6 +33,8 @@ void Implementation::initialize()
 {
     if (!initialized())
     {
+        TraceZone zone("Implementation::initialize", m_name);
+
         onInitialize();
 
         m_initialized = true;
@@ -36,6 +45,8 @@ void Implementation::render()
 {
     initialize();
 
+    TraceZone zone("Implementation::render", m_name);
+
     onRender();
 }
 
@@ -43,3 +54,27 @@ size_t Implementation::fullByteSize() const
 {
     return byteSize() + staticByteSize();
 }
+
+size_t Implementation::gpuByteSize() const
+{
+    if (!initialized())
+    {
+        return 0;
+    }
+
+    auto size = size_t(0);
+
+    for (const auto buffer : buffers())
+    {
+        auto bufferSize = static_cast<GLint64>(0);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glGetBufferParameteri64v(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &bufferSize);
+
+        size += static_cast<size_t>(bufferSize);
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    return size;
+}
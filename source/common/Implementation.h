@@ -2,6 +2,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <glbinding/gl/types.h>
 
@@ -20,6 +21,11 @@ public:
 
     size_t fullByteSize() const;
 
+    // Measured memory footprint: GL_BUFFER_SIZE of all buffers (zero before initialization)
+    // and the allocated capacity of all CPU-side containers
+    size_t gpuByteSize() const;
+    virtual size_t cpuByteSize() const = 0;
+
     virtual void onInitialize() = 0;
     virtual void onRender() = 0;
 
@@ -34,9 +40,21 @@ public:
 
     virtual void resize(size_t count) = 0;
 
+    virtual std::vector<gl::GLuint> buffers() const = 0;
+
     virtual gl::GLuint program() const = 0;
 
 protected:
     std::string m_name;
     bool m_initialized;
+
+    template <typename T>
+    static size_t containerByteSize(const std::vector<T> & container);
 };
+
+
+template <typename T>
+size_t Implementation::containerByteSize(const std::vector<T> & container)
+{
+    return container.capacity() * sizeof(T);
+}
@@ -0,0 +1,134 @@
+
+#include "InteractionLog.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+
+InteractionEvent::InteractionEvent()
+: frame(0)
+, value(0)
+{
+}
+
+InteractionEvent::InteractionEvent(size_t frame, const std::string & command, int value)
+: frame(frame)
+, command(command)
+, value(value)
+{
+}
+
+
+InteractionLog::InteractionLog()
+: m_next(0)
+{
+}
+
+bool InteractionLog::load(const std::string & filename)
+{
+    auto stream = std::ifstream(filename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open interaction log '" << filename << "'." << std::endl;
+
+        return false;
+    }
+
+    auto events = std::vector<InteractionEvent>();
+    auto line = std::string();
+    auto lineNumber = size_t(0);
+
+    while (std::getline(stream, line))
+    {
+        ++lineNumber;
+
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        auto lineStream = std::istringstream(line);
+        auto event = InteractionEvent();
+
+        if (!(lineStream >> event.frame >> event.command >> event.value))
+        {
+            std::cerr << filename << ":" << lineNumber << ": expected frame, command and value" << std::endl;
+
+            return false;
+        }
+
+        if (!events.empty() && event.frame < events.back().frame)
+        {
+            std::cerr << filename << ":" << lineNumber << ": events have to be in frame order" << std::endl;
+
+            return false;
+        }
+
+        events.push_back(event);
+    }
+
+    m_events = events;
+    m_next = 0;
+
+    return true;
+}
+
+bool InteractionLog::save(const std::string & filename) const
+{
+    auto stream = std::ofstream(filename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open output file '" << filename << "'." << std::endl;
+
+        return false;
+    }
+
+    stream << "# frame command value" << std::endl;
+
+    for (const auto & event : m_events)
+    {
+        stream << event.frame << " " << event.command << " " << event.value << std::endl;
+    }
+
+    std::cout << "Interaction log with " << m_events.size() << " events written to " << filename << std::endl;
+
+    return true;
+}
+
+void InteractionLog::clear()
+{
+    m_events.clear();
+    m_next = 0;
+}
+
+void InteractionLog::add(size_t frame, const std::string & command, int value)
+{
+    m_events.push_back(InteractionEvent(frame, command, value));
+}
+
+size_t InteractionLog::size() const
+{
+    return m_events.size();
+}
+
+std::vector<InteractionEvent> InteractionLog::advance(size_t frame)
+{
+    auto events = std::vector<InteractionEvent>();
+
+    while (m_next < m_events.size() && m_events[m_next].frame <= frame)
+    {
+        events.push_back(m_events[m_next]);
+
+        ++m_next;
+    }
+
+    return events;
+}
+
+bool InteractionLog::finished() const
+{
+    return m_next >= m_events.size();
+}
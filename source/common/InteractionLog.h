@@ -0,0 +1,42 @@
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+class InteractionEvent
+{
+public:
+    InteractionEvent();
+    InteractionEvent(size_t frame, const std::string & command, int value);
+
+    size_t frame;
+    std::string command;
+    int value;
+};
+
+
+// Interactive commands in the order they were issued, tagged with the frame index they were issued in.
+// Files list one event per line: "frame command value".
+class InteractionLog
+{
+public:
+    InteractionLog();
+
+    bool load(const std::string & filename);
+    bool save(const std::string & filename) const;
+
+    void clear();
+    void add(size_t frame, const std::string & command, int value = 0);
+
+    size_t size() const;
+
+    // Returns the events up to and including the given frame that were not returned before
+    std::vector<InteractionEvent> advance(size_t frame);
+    bool finished() const;
+
+protected:
+    std::vector<InteractionEvent> m_events;
+    size_t m_next;
+};
@@ -0,0 +1,169 @@
+
+#include "Measurement.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+
+
+// Samples with a modified z-score above this threshold are rejected (Iglewicz and Hoaglin)
+static const auto outlierThreshold = 3.5;
+static const auto madToStandardDeviation = 1.4826;
+
+
+double percentile(const std::vector<double> & sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+
+    const auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+
+    return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+}
+
+double median(std::vector<double> values)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+
+    const auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+
+    return *middle;
+}
+
+
+} // namespace
+
+
+MeasurementStatistics::MeasurementStatistics()
+: count(0)
+, outliers(0)
+, min(0.0)
+, median(0.0)
+, p90(0.0)
+, p99(0.0)
+, max(0.0)
+, mean(0.0)
+, stddev(0.0)
+{
+}
+
+
+Measurement::Measurement()
+: m_capacity(0)
+{
+}
+
+void Measurement::reset(size_t capacity)
+{
+    m_capacity = capacity;
+
+    m_samples.clear();
+    m_samples.reserve(capacity);
+}
+
+void Measurement::add(size_t sample)
+{
+    if (full())
+    {
+        return;
+    }
+
+    m_samples.push_back(sample);
+}
+
+size_t Measurement::count() const
+{
+    return m_samples.size();
+}
+
+size_t Measurement::capacity() const
+{
+    return m_capacity;
+}
+
+bool Measurement::full() const
+{
+    return m_samples.size() >= m_capacity;
+}
+
+const std::vector<size_t> & Measurement::samples() const
+{
+    return m_samples;
+}
+
+MeasurementStatistics Measurement::statistics() const
+{
+    auto result = MeasurementStatistics();
+
+    if (m_samples.empty())
+    {
+        return result;
+    }
+
+    auto sorted = std::vector<double>(m_samples.begin(), m_samples.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    result.count = sorted.size();
+    result.min = sorted.front();
+    result.median = percentile(sorted, 0.5);
+    result.p90 = percentile(sorted, 0.9);
+    result.p99 = percentile(sorted, 0.99);
+    result.max = sorted.back();
+
+    auto deviations = std::vector<double>(sorted.size());
+    std::transform(sorted.begin(), sorted.end(), deviations.begin(), [&result](double sample) {
+        return std::abs(sample - result.median);
+    });
+
+    const auto mad = madToStandardDeviation * median(deviations);
+
+    auto sum = 0.0;
+    auto squaredSum = 0.0;
+    auto inliers = size_t(0);
+
+    for (const auto sample : sorted)
+    {
+        if (mad > 0.0 && std::abs(sample - result.median) / mad > outlierThreshold)
+        {
+            continue;
+        }
+
+        sum += sample;
+        squaredSum += sample * sample;
+        ++inliers;
+    }
+
+    result.outliers = sorted.size() - inliers;
+    result.mean = sum / inliers;
+    result.stddev = std::sqrt(std::max(0.0, squaredSum / inliers - result.mean * result.mean));
+
+    return result;
+}
+
+bool Measurement::converged(double tolerance) const
+{
+    if (m_samples.size() < 8)
+    {
+        return false;
+    }
+
+    const auto quarter = m_samples.size() / 4;
+    const auto previous = median(std::vector<double>(m_samples.end() - 2 * quarter, m_samples.end() - quarter));
+    const auto last = median(std::vector<double>(m_samples.end() - quarter, m_samples.end()));
+
+    if (last <= 0.0)
+    {
+        return previous <= 0.0;
+    }
+
+    return std::abs(previous - last) / last <= tolerance;
+}
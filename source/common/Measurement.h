@@ -0,0 +1,56 @@
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+
+class MeasurementStatistics
+{
+public:
+    MeasurementStatistics();
+
+    size_t count;
+    size_t outliers;
+
+    // Order statistics over all samples
+    double min;
+    double median;
+    double p90;
+    double p99;
+    double max;
+
+    // Moments over the samples that survived the outlier rejection
+    double mean;
+    double stddev;
+};
+
+
+// Fixed-capacity sample buffer for timing measurements.
+// Samples are stored unaggregated so that tails and jitter can be evaluated after the run;
+// adding a sample never allocates once reset() reserved the capacity.
+class Measurement
+{
+public:
+    Measurement();
+
+    void reset(size_t capacity);
+    void add(size_t sample);
+
+    size_t count() const;
+    size_t capacity() const;
+    bool full() const;
+
+    const std::vector<size_t> & samples() const;
+
+    // Computes order statistics and MAD-based outlier-rejected mean and standard deviation
+    MeasurementStatistics statistics() const;
+
+    // Compares the medians of the last two quarters of the samples;
+    // used on warmup samples to check whether timings stopped drifting
+    bool converged(double tolerance) const;
+
+protected:
+    size_t m_capacity;
+    std::vector<size_t> m_samples;
+};
@@ -0,0 +1,128 @@
+
+#include "PipelineStatistics.h"
+
+#include <glbinding/gl/gl.h>
+
+#include "common.h"
+
+
+using namespace gl;
+
+
+namespace
+{
+
+
+static const size_t counterTotal = 11;
+
+// The first counter is part of core OpenGL 3; the others need ARB_pipeline_statistics_query
+static const GLenum counterTargets[counterTotal] = {
+    GL_PRIMITIVES_GENERATED,
+    GL_VERTICES_SUBMITTED,
+    GL_PRIMITIVES_SUBMITTED,
+    GL_VERTEX_SHADER_INVOCATIONS,
+    GL_TESS_CONTROL_SHADER_PATCHES,
+    GL_TESS_EVALUATION_SHADER_INVOCATIONS,
+    GL_GEOMETRY_SHADER_INVOCATIONS,
+    GL_GEOMETRY_SHADER_PRIMITIVES_EMITTED,
+    GL_CLIPPING_INPUT_PRIMITIVES,
+    GL_CLIPPING_OUTPUT_PRIMITIVES,
+    GL_FRAGMENT_SHADER_INVOCATIONS
+};
+
+static const char * counterNames[counterTotal] = {
+    "primitivesGenerated",
+    "verticesSubmitted",
+    "primitivesSubmitted",
+    "vertexShaderInvocations",
+    "tessControlPatches",
+    "tessEvaluationInvocations",
+    "geometryShaderInvocations",
+    "geometryShaderPrimitives",
+    "clippingInputPrimitives",
+    "clippingOutputPrimitives",
+    "fragmentShaderInvocations"
+};
+
+
+} // namespace
+
+
+PipelineStatistics::PipelineStatistics()
+: m_pipelineStatisticsSupported(false)
+, m_results(counterTotal, 0)
+{
+}
+
+PipelineStatistics::~PipelineStatistics()
+{
+}
+
+bool PipelineStatistics::initialized() const
+{
+    return !m_queries.empty();
+}
+
+void PipelineStatistics::initialize()
+{
+    auto major = static_cast<GLint>(0);
+    auto minor = static_cast<GLint>(0);
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+    m_pipelineStatisticsSupported = major > 4 || (major == 4 && minor >= 6) || hasExtension("GL_ARB_pipeline_statistics_query");
+
+    m_queries.resize(m_pipelineStatisticsSupported ? counterTotal : 1);
+
+    glGenQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+}
+
+void PipelineStatistics::deinitialize()
+{
+    glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+
+    m_queries.clear();
+}
+
+size_t PipelineStatistics::counterCount()
+{
+    return counterTotal;
+}
+
+const char * PipelineStatistics::counterName(size_t index)
+{
+    return counterNames[index];
+}
+
+bool PipelineStatistics::available(size_t index) const
+{
+    return index < m_queries.size();
+}
+
+size_t PipelineStatistics::result(size_t index) const
+{
+    return m_results[index];
+}
+
+void PipelineStatistics::measure(const std::function<void()> & callback)
+{
+    for (auto i = size_t(0); i < m_queries.size(); ++i)
+    {
+        glBeginQuery(counterTargets[i], m_queries[i]);
+    }
+
+    callback();
+
+    for (auto i = size_t(0); i < m_queries.size(); ++i)
+    {
+        glEndQuery(counterTargets[i]);
+    }
+
+    for (auto i = size_t(0); i < m_queries.size(); ++i)
+    {
+        auto value = static_cast<GLuint64>(0);
+        glGetQueryObjectui64v(m_queries[i], GL_QUERY_RESULT, &value);
+
+        m_results[i] = static_cast<size_t>(value);
+    }
+}
@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <glbinding/gl/types.h>
+
+
+// Counts the workload of a draw callback with GL_PRIMITIVES_GENERATED and,
+// if the context supports ARB_pipeline_statistics_query, the per-stage pipeline statistics.
+// Results are read back synchronously, so it is meant for single instrumented frames.
+class PipelineStatistics
+{
+public:
+    PipelineStatistics();
+    ~PipelineStatistics();
+
+    bool initialized() const;
+
+    void initialize();
+    void deinitialize();
+
+    static size_t counterCount();
+    static const char * counterName(size_t index);
+
+    bool available(size_t index) const;
+    size_t result(size_t index) const;
+
+    void measure(const std::function<void()> & callback);
+
+protected:
+    bool m_pipelineStatisticsSupported;
+
+    std::vector<gl::GLuint> m_queries;
+    std::vector<size_t> m_results;
+};
@@ -4,6 +4,7 @@
 #include <glbinding/gl/gl.h>
 
 #include "common.h"
+#include "Trace.h"
 
 using namespace gl;
 
@@ -49,6 +50,8 @@ void Postprocessing::initialize()
 
 void Postprocessing::render()
 {
+    TraceZone zone("Postprocessing::render");
+
     initialize();
 
     onRender();
@@ -0,0 +1,170 @@
+
+#include "PrimitiveGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <glm/common.hpp>
+
+#include "common.h"
+
+
+namespace
+{
+
+
+// Lattice cells of the generated noise along the largest grid dimension, independent of the primitive count
+static const auto noiseLatticeSize = 8.0f;
+
+
+size_t ceilRoot(size_t count, size_t dimensions)
+{
+    auto n = static_cast<size_t>(std::ceil(std::pow(static_cast<double>(count), 1.0 / dimensions)));
+
+    const auto power = [dimensions](size_t value) {
+        return dimensions == 3 ? value * value * value : value * value;
+    };
+
+    // Correct rounding errors of pow for large counts
+    while (n > 1 && power(n - 1) >= count)
+    {
+        --n;
+    }
+
+    while (power(n) < count)
+    {
+        ++n;
+    }
+
+    return std::max(n, size_t(1));
+}
+
+float hashNoise(const glm::ivec3 & corner, size_t component)
+{
+    auto h = static_cast<std::uint32_t>(corner.x) * 73856093u
+        ^ static_cast<std::uint32_t>(corner.y) * 19349663u
+        ^ static_cast<std::uint32_t>(corner.z) * 83492791u
+        ^ static_cast<std::uint32_t>(component) * 2654435761u;
+
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+
+    return static_cast<float>(h) / 4294967295.0f * 2.0f - 1.0f;
+}
+
+float valueNoise(const glm::vec3 & p, size_t component)
+{
+    const auto cell = glm::floor(p);
+    const auto corner = glm::ivec3(cell);
+    const auto t = glm::smoothstep(glm::vec3(0.0f), glm::vec3(1.0f), p - cell);
+
+    const auto x00 = glm::mix(hashNoise(corner + glm::ivec3(0, 0, 0), component), hashNoise(corner + glm::ivec3(1, 0, 0), component), t.x);
+    const auto x10 = glm::mix(hashNoise(corner + glm::ivec3(0, 1, 0), component), hashNoise(corner + glm::ivec3(1, 1, 0), component), t.x);
+    const auto x01 = glm::mix(hashNoise(corner + glm::ivec3(0, 0, 1), component), hashNoise(corner + glm::ivec3(1, 0, 1), component), t.x);
+    const auto x11 = glm::mix(hashNoise(corner + glm::ivec3(0, 1, 1), component), hashNoise(corner + glm::ivec3(1, 1, 1), component), t.x);
+
+    return glm::mix(glm::mix(x00, x10, t.y), glm::mix(x01, x11, t.y), t.z);
+}
+
+
+} // namespace
+
+
+PrimitiveGrid::PrimitiveGrid(size_t count, size_t dimensions)
+: m_count(count)
+, m_size(1, 1, 1)
+{
+    const auto n = ceilRoot(std::max(count, size_t(1)), dimensions);
+
+    m_size.x = static_cast<int>(n);
+
+    if (dimensions == 3)
+    {
+        m_size.y = static_cast<int>(n);
+        m_size.z = static_cast<int>((count + n * n - 1) / (n * n));
+    }
+    else
+    {
+        m_size.y = static_cast<int>((count + n - 1) / n);
+    }
+
+    m_size = glm::max(m_size, glm::ivec3(1, 1, 1));
+}
+
+size_t PrimitiveGrid::count() const
+{
+    return m_count;
+}
+
+const glm::ivec3 & PrimitiveGrid::size() const
+{
+    return m_size;
+}
+
+glm::ivec3 PrimitiveGrid::position(size_t index) const
+{
+    const auto x = static_cast<size_t>(m_size.x);
+    const auto y = static_cast<size_t>(m_size.y);
+
+    return glm::ivec3(index % x, (index / x) % y, index / x / y);
+}
+
+void PrimitiveGrid::loadNoise(size_t componentCount)
+{
+    m_noise.clear();
+
+    // The pre-generated noise covers cubic grids of a few sizes, which 2D grids index into as well
+    const auto gridSize = m_size.x;
+
+    if (m_size.y != gridSize || (m_size.z != gridSize && m_size.z != 1))
+    {
+        return;
+    }
+
+    const auto fileName = [gridSize](size_t component) {
+        return "/noise-" + std::to_string(gridSize) + "-" + std::to_string(component) + ".raw";
+    };
+
+    for (auto i = size_t(0); i < componentCount; ++i)
+    {
+        if (!std::ifstream(dataPath() + "/noise" + fileName(i)))
+        {
+            return;
+        }
+    }
+
+    for (auto i = size_t(0); i < componentCount; ++i)
+    {
+        m_noise.push_back(::loadNoise(fileName(i)));
+
+        if (m_noise.back().size() < m_count)
+        {
+            m_noise.clear();
+
+            return;
+        }
+    }
+}
+
+float PrimitiveGrid::noise(size_t component, size_t index) const
+{
+    if (!m_noise.empty())
+    {
+        return m_noise[component][index];
+    }
+
+    const auto scale = noiseLatticeSize / static_cast<float>(std::max(m_size.x, std::max(m_size.y, m_size.z)));
+
+    return valueNoise(glm::vec3(position(index)) * scale, component);
+}
+
+float PrimitiveGrid::valueNoise(const glm::vec3 & p, size_t component)
+{
+    return ::valueNoise(p, component);
+}
@@ -0,0 +1,35 @@
+
+#pragma once
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+
+// Lays out an arbitrary number of primitives on a grid that is as close to a cube (or, with two dimensions,
+// a square) as possible; only the last layer is partially filled. Provides the noise the demos derive their
+// attributes from: the pre-generated data/noise files where they match the grid, value noise otherwise.
+class PrimitiveGrid
+{
+public:
+    PrimitiveGrid(size_t count, size_t dimensions = 3);
+
+    size_t count() const;
+    const glm::ivec3 & size() const;
+
+    glm::ivec3 position(size_t index) const;
+
+    // Loads or prepares noise components; values lie in [-1, 1] like the pre-generated files
+    void loadNoise(size_t componentCount);
+    float noise(size_t component, size_t index) const;
+
+    // Value noise in [-1, 1] with one lattice cell per unit, as generated for grids without pre-generated noise
+    static float valueNoise(const glm::vec3 & p, size_t component);
+
+protected:
+    size_t m_count;
+    glm::ivec3 m_size;
+
+    // Empty if the noise is generated
+    std::vector<std::vector<float>> m_noise;
+};
@@ -2,8 +2,10 @@
 #include "Rendering.h"
 
 #include <iostream>
+#include <fstream>
 #include <algorithm>
-#include <numeric>
+#include <limits>
+#include <cmath>
 
 #include <glm/gtc/type_ptr.hpp>
 
@@ -11,9 +13,12 @@
 
 #include "common.h"
 
+#include "Baseline.h"
 #include "Implementation.h"
 #include "Postprocessing.h"
+#include "ScalingAnalysis.h"
 #include "Screenshot.h"
+#include "Trace.h"
 
 
 using namespace gl;
@@ -26,6 +31,27 @@ static const auto warmupCount = size_t(1000);
 static const auto measureCount = size_t(1000);
 static const auto fpsSampleCount = size_t(100);
 
+// Relative drift of the median between the last two quarters of the warmup that still counts as steady state
+static const auto steadyStateTolerance = 0.05;
+
+static const auto benchmarkWarmupCount = size_t(100);
+static const auto benchmarkMeasureCount = size_t(500);
+
+// Number of frames a timer query result may lag behind before frames are no longer timed
+static const auto timerRingSize = size_t(8);
+static const auto continuousSampleCount = size_t(300);
+
+// Presets of cameraPosition; preset 0 is the frame-indexed camera path
+static const auto cameraPresetCount = 5;
+
+// Frames per time unit of the built-in camera path
+static const auto cameraPathFrameRate = 60.0f;
+
+// Vertical field of view in degrees
+static const auto fieldOfView = 45.0f;
+static const auto nearPlane = 0.05f;
+static const auto farPlane = 2.5f;
+
 static const auto screenshotWidth = size_t(3840 * 2);
 static const auto screenshotHeight = size_t(2160 * 2);
 
@@ -35,24 +61,77 @@ static const auto screenshotHeight = size_t(2160 * 2);
 static const float clearColor[] = { 0.81f, 0.81f, 0.81f, 1.0f };
 
 
+void writeStatistics(std::ostream & stream, const Measurement & warmup, const Measurement & measurement, size_t dropped)
+{
+    const auto statistics = measurement.statistics();
+
+    stream << statistics.min << ","
+        << statistics.median << ","
+        << statistics.p90 << ","
+        << statistics.p99 << ","
+        << statistics.max << ","
+        << statistics.stddev << ","
+        << statistics.outliers << ","
+        << (warmup.converged(steadyStateTolerance) ? 1 : 0) << ","
+        << dropped;
+}
+
+bool requiresSample(const GPUTimer & timer, const Measurement & warmup, const Measurement & measurement)
+{
+    return warmup.count() + measurement.count() + timer.pending() < warmup.capacity() + measurement.capacity();
+}
+
+void collectSamples(GPUTimer & timer, Measurement & warmup, Measurement & measurement, bool wait)
+{
+    const auto callback = [&warmup, &measurement](size_t time) {
+        if (!warmup.full())
+        {
+            warmup.add(time);
+        }
+        else
+        {
+            measurement.add(time);
+        }
+    };
+
+    if (wait)
+    {
+        timer.flush(callback);
+    }
+    else
+    {
+        timer.collect(callback);
+    }
+}
+
+
 } // namespace
 
 
 Rendering::Rendering(const std::string & name)
 : m_name(name)
+, m_cameraSetting(0)
 , m_current(nullptr)
 , m_postprocessing(nullptr)
+, m_screenshot(nullptr)
 , m_width(0)
 , m_height(0)
-, m_gridSize(32)
+, m_primitiveCount(32 * 32 * 32)
 , m_usePostprocessing(false)
 , m_rasterizerDiscard(false)
 , m_query(0)
+, m_frame(0)
+, m_cameraFrame(0)
+, m_recording(false)
+, m_recordingStart(0)
+, m_replaying(false)
 , m_fpsSamples(fpsSampleCount+1)
 , m_inMeasurement(false)
-, m_count(0)
-, m_warmupCount(0)
-, m_sum(0)
+, m_continuousTiming(false)
+, m_residentSetSizeBeforeGeometry(0)
+, m_residentSetSizeAfterGeometry(0)
+, m_peakResidentSetSizeDuringGeometry(0)
+, m_geometryTechnique(-1)
 {
 }
 
@@ -65,6 +144,16 @@ void Rendering::addImplementation(Implementation *implementation)
     m_implementations.push_back(implementation);
 }
 
+std::vector<Implementation *> Rendering::geometryImplementations() const
+{
+    if (m_geometryTechnique < 0 || m_geometryTechnique >= static_cast<int>(m_implementations.size()))
+    {
+        return m_implementations;
+    }
+
+    return { m_implementations[m_geometryTechnique] };
+}
+
 void Rendering::initialize()
 {
     glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
@@ -73,13 +162,26 @@ void Rendering::initialize()
 
     glGenQueries(1, &m_query);
 
+    m_timer.initialize(timerRingSize);
+    m_continuousTimer.initialize(timerRingSize);
+    m_pipelineStatistics.initialize();
+
     m_postprocessing = new Postprocessing;
     m_screenshot = new Screenshot;
 
     onInitialize();
-    onCreateGeometry();
 
-    m_start = std::chrono::high_resolution_clock::now();
+    m_residentSetSizeBeforeGeometry = currentResidentSetSize();
+    resetPeakResidentSetSize();
+
+    {
+        TraceZone zone("Rendering::onCreateGeometry", m_name);
+
+        onCreateGeometry();
+    }
+
+    m_peakResidentSetSizeDuringGeometry = peakResidentSetSize();
+    m_residentSetSizeAfterGeometry = currentResidentSetSize();
 
     setTechnique(0);
 }
@@ -91,12 +193,23 @@ void Rendering::deinitialize()
     // Flag all aquired resources for deletion (hint: driver decides when to actually delete them; see: shared contexts)
     glDeleteQueries(1, &m_query);
 
+    m_timer.deinitialize();
+    m_continuousTimer.deinitialize();
+    m_pipelineStatistics.deinitialize();
+
     delete m_postprocessing;
+    delete m_screenshot;
 
     for (auto implementation : m_implementations)
     {
         delete implementation;
     }
+
+    m_implementations.clear();
+
+    m_current = nullptr;
+    m_postprocessing = nullptr;
+    m_screenshot = nullptr;
 }
 
 void Rendering::reloadShaders()
@@ -127,20 +240,17 @@ void Rendering::cameraPosition(glm::vec3 & eye, glm::vec3 & center, glm::vec3 &
 
     static const auto up0 = glm::vec3(0.0f, 1.0f, 0.0f);
 
-    const auto f = static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - m_start).count()) / 1000.0f;
-
-    if (m_inMeasurement)
-    {
-        eye = eye0;
-        center = center0;
-        up = up0;
-
-        return;
-    }
+    const auto f = static_cast<float>(m_cameraFrame) / cameraPathFrameRate;
 
     switch (m_cameraSetting)
     {
     case 0:
+        if (!m_cameraPath.empty())
+        {
+            m_cameraPath.camera(m_cameraFrame, eye, center, up);
+            break;
+        }
+
         eye = cameraPath(eye0, f);
         center = center0;
         up = up0;
@@ -173,23 +283,40 @@ void Rendering::cameraPosition(glm::vec3 & eye, glm::vec3 & center, glm::vec3 &
     }
 }
 
-void Rendering::prepareRendering()
+void Rendering::camera(glm::vec3 & eye, glm::mat4 & viewProjection) const
 {
-    auto eye = glm::vec3(0.0f, 0.0f, 0.0f);
     auto center = glm::vec3(0.0f, 0.0f, 0.0f);
     auto up = glm::vec3(0.0f, 0.0f, 0.0f);
 
     cameraPosition(eye, center, up);
 
     const auto view = glm::lookAt(eye, center, up);
-    const auto viewProjection = glm::perspectiveFov(glm::radians(45.0f), float(m_width), float(m_height), 0.05f, 2.5f) * view;
+
+    viewProjection = glm::perspectiveFov(glm::radians(fieldOfView), float(m_width), float(m_height), nearPlane, farPlane) * view;
+}
+
+float Rendering::pixelsPerUnit() const
+{
+    return float(m_height) / (2.0f * std::tan(glm::radians(fieldOfView) / 2.0f));
+}
+
+void Rendering::prepareRendering()
+{
+    TraceZone zone("Rendering::prepareRendering");
+
+    auto eye = glm::vec3(0.0f, 0.0f, 0.0f);
+    auto viewProjection = glm::mat4(1.0f);
+
+    camera(eye, viewProjection);
 
     GLuint program = m_current->program();
     const auto viewProjectionLocation = glGetUniformLocation(program, "viewProjection");
     const auto gradientSamplerLocation = glGetUniformLocation(program, "gradient");
+    const auto eyeLocation = glGetUniformLocation(program, "eye");
     glUseProgram(program);
     glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
     glUniform1i(gradientSamplerLocation, 0);
+    glUniform3f(eyeLocation, eye.x, eye.y, eye.z);
 
     glUseProgram(0);
 
@@ -214,12 +341,14 @@ void Rendering::resize(int w, int h)
 
 void Rendering::setCameraTechnique(int i)
 {
-    if (i < 0 || i >= 4)
+    if (i < 0 || i >= cameraPresetCount)
     {
         return;
     }
 
     m_cameraSetting = i;
+
+    record("camera", i);
 }
 
 void Rendering::setTechnique(int i)
@@ -231,11 +360,58 @@ void Rendering::setTechnique(int i)
 
     m_current = m_implementations.at(static_cast<std::size_t>(i));
 
+    record("technique", i);
+
     std::cout << "Switch to " << m_current->name() << " implementation" << std::endl;
 }
 
 void Rendering::render()
+{
+    Trace::instance().collect();
+
+    TraceZone zone("Rendering::render");
+
+    if (m_replaying)
+    {
+        for (const auto & event : m_replayedInteraction.advance(m_frame))
+        {
+            replay(event);
+        }
+    }
+
+    renderFrame();
+
+    ++m_frame;
+    ++m_cameraFrame;
+}
+
+void Rendering::renderFrame()
 {
+    if (m_inMeasurement)
+    {
+        collectSamples(m_timer, m_warmup, m_measurement, false);
+
+        if (m_measurement.full())
+        {
+            printMeasurement("geometry processing", m_measurement);
+            printDropped("geometry processing", m_timer.dropped());
+
+            if (!m_warmup.converged(steadyStateTolerance))
+            {
+                std::cout << "  Warning: warmup did not reach a steady state" << std::endl;
+            }
+
+            // Counted with rasterization enabled, from the same camera as the timings
+            m_current->initialize();
+            measurePipelineStatistics(0);
+            printPipelineStatistics();
+
+            m_inMeasurement = false;
+
+            return;
+        }
+    }
+
     if (m_inMeasurement)
     {
         m_current->initialize();
@@ -246,24 +422,18 @@ void Rendering::render()
 
         prepareRendering();
 
-        m_sum += measureGPU([this]() {
-            m_current->render();
-        }, m_warmupCount == 0);
+        const auto timed = requiresSample(m_timer, m_warmup, m_measurement);
 
-        if (m_warmupCount > 0)
+        if (timed)
         {
-            --m_warmupCount;
+            m_timer.begin();
         }
-        else
-        {
-            ++m_count;
 
-            if (m_count == measureCount)
-            {
-                m_inMeasurement = false;
+        m_current->render();
 
-                std::cout << "Measured " << (m_sum / m_count / 1000) << "µs" << " for geometry processing" << std::endl;
-            }
+        if (timed)
+        {
+            m_timer.end();
         }
 
         finalizeRendering();
@@ -289,6 +459,20 @@ void Rendering::render()
         ++m_fpsSamples;
     }
 
+    if (m_continuousTiming)
+    {
+        m_continuousTimer.collect([this](size_t time) {
+            m_continuous.add(time);
+        });
+
+        if (m_continuous.full())
+        {
+            printMeasurement("rendering over the last " + std::to_string(m_continuous.count()) + " timed frames", m_continuous);
+
+            m_continuous.reset(continuousSampleCount);
+        }
+    }
+
     m_current->initialize();
 
     glViewport(0, 0, m_width, m_height);
@@ -321,8 +505,18 @@ void Rendering::render()
         glEnable(GL_RASTERIZER_DISCARD);
     }
 
+    if (m_continuousTiming)
+    {
+        m_continuousTimer.begin();
+    }
+
     m_current->render();
 
+    if (m_continuousTiming)
+    {
+        m_continuousTimer.end();
+    }
+
     if (m_rasterizerDiscard)
     {
         glDisable(GL_RASTERIZER_DISCARD);
@@ -379,30 +573,364 @@ void Rendering::takeScreenshot()
 
     m_postprocessing->render();
 
-    m_screenshot->saveScreenshot(m_name + "-" + std::to_string(m_gridSize) + ".ppm");
+    m_screenshot->saveScreenshot(m_name + "-" + std::to_string(m_primitiveCount) + ".ppm");
 }
 
-void Rendering::spaceMeasurement()
+void Rendering::benchmark(const std::vector<size_t> & primitiveCounts)
+{
+    const auto filename = benchmarkFilename();
+
+    auto stream = std::ofstream(filename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open output file '" << filename << "'." << std::endl;
+
+        return;
+    }
+
+    stream << "executable,technique,primitiveCount,cameraPreset,createGeometryNs,initializeNs,"
+        << "geometryMinNs,geometryMedianNs,geometryP90Ns,geometryP99Ns,geometryMaxNs,geometryStddevNs,geometryOutliers,geometrySteady,geometryDropped,"
+        << "frameMinNs,frameMedianNs,frameP90Ns,frameP99Ns,frameMaxNs,frameStddevNs,frameOutliers,frameSteady,frameDropped,"
+        << "estimatedByteSize,gpuByteSize,cpuByteSize,residentSetSizeBeforeGeometry,peakResidentSetSizeDuringGeometry";
+
+    for (auto i = size_t(0); i < PipelineStatistics::counterCount(); ++i)
+    {
+        stream << "," << PipelineStatistics::counterName(i);
+    }
+
+    stream << std::endl;
+
+    m_benchmarkTechniques.clear();
+    m_benchmarkBytesPerPrimitive.clear();
+
+    for (const auto primitiveCount : primitiveCounts)
+    {
+        setPrimitiveCount(primitiveCount);
+
+        benchmarkGeometry(stream);
+    }
+
+    std::cout << "Benchmark results written to " << filename << std::endl;
+}
+
+void Rendering::sweep(size_t minPrimitiveCount, size_t maxPrimitiveCount, size_t steps)
+{
+    auto primitiveCounts = std::vector<size_t>();
+
+    // Geometric progression, so each order of magnitude gets the same number of samples
+    for (auto i = size_t(0); i < steps; ++i)
+    {
+        const auto t = steps > 1 ? static_cast<double>(i) / (steps - 1) : 0.0;
+        const auto count = static_cast<size_t>(std::round(minPrimitiveCount * std::pow(static_cast<double>(maxPrimitiveCount) / minPrimitiveCount, t)));
+
+        if (primitiveCounts.empty() || count != primitiveCounts.back())
+        {
+            primitiveCounts.push_back(count);
+        }
+    }
+
+    benchmark(primitiveCounts);
+
+    auto analysis = ScalingAnalysis();
+
+    if (!analysis.load(benchmarkFilename()))
+    {
+        return;
+    }
+
+    analysis.print(std::cout);
+    analysis.write(m_name + "-scaling.csv");
+    analysis.writeCrossovers(m_name + "-crossovers.csv");
+}
+
+bool Rendering::saveBaseline(const std::string & filename) const
+{
+    auto results = Baseline();
+
+    return results.loadBenchmark(benchmarkFilename()) && results.save(filename);
+}
+
+BaselineComparison Rendering::compareToBaseline(const std::string & filename, double threshold, bool strict) const
+{
+    auto results = Baseline();
+    auto reference = Baseline();
+
+    if (!results.loadBenchmark(benchmarkFilename()) || !reference.load(filename))
+    {
+        return BaselineComparison::Unreadable;
+    }
+
+    std::cout << "Comparison against baseline " << filename << std::endl;
+
+    return results.compare(reference, threshold, strict, std::cout) == 0 ? BaselineComparison::Passed : BaselineComparison::Regressed;
+}
+
+std::string Rendering::benchmarkFilename() const
+{
+    return m_name + "-benchmark.csv";
+}
+
+void Rendering::benchmarkGeometry(std::ostream & stream)
+{
+    // Leaves room for the GPU buffers, which are as large again on integrated GPUs
+    const auto memoryBudget = static_cast<double>(physicalMemorySize()) / 2.0;
+
+    // The technique count is known once the first geometry is created
+    auto techniqueCount = std::max(m_benchmarkTechniques.size(), size_t(1));
+
+    // Only the benchmarked technique is filled, so large primitive counts need the memory of one technique, not of all
+    for (auto technique = size_t(0); technique < techniqueCount; ++technique)
+    {
+        if (technique < m_benchmarkBytesPerPrimitive.size())
+        {
+            const auto estimatedByteSize = m_benchmarkBytesPerPrimitive[technique] * m_primitiveCount;
+
+            if (memoryBudget > 0.0 && estimatedByteSize > memoryBudget)
+            {
+                std::cout << "Skip " << m_benchmarkTechniques[technique] << " at " << m_primitiveCount << " primitives: about "
+                    << static_cast<size_t>(estimatedByteSize / 1024 / 1024) << " MB exceed half of the memory" << std::endl;
+
+                continue;
+            }
+        }
+
+        m_geometryTechnique = static_cast<int>(technique);
+
+        const auto createGeometryTime = measureCPU([this]() {
+            initialize();
+            glFinish();
+        }, true);
+
+        techniqueCount = m_implementations.size();
+
+        m_postprocessing->initialize();
+        m_postprocessing->resize(m_width, m_height);
+
+        setTechnique(static_cast<int>(technique));
+
+        const auto initializeTime = measureCPU([this]() {
+            m_current->initialize();
+            glFinish();
+        }, true);
+
+        for (auto preset = 0; preset < cameraPresetCount; ++preset)
+        {
+            m_cameraSetting = preset;
+
+            stream << m_name << ","
+                << m_current->name() << ","
+                << primitiveCount() << ","
+                << preset << ","
+                << createGeometryTime << ","
+                << initializeTime << ",";
+
+            benchmarkFrames(true, m_warmup, m_measurement);
+            writeStatistics(stream, m_warmup, m_measurement, m_timer.dropped());
+            printDropped(m_current->name() + " geometry processing at preset " + std::to_string(preset), m_timer.dropped());
+
+            stream << ",";
+
+            benchmarkFrames(false, m_warmup, m_measurement);
+            writeStatistics(stream, m_warmup, m_measurement, m_timer.dropped());
+            printDropped(m_current->name() + " rendering at preset " + std::to_string(preset), m_timer.dropped());
+
+            stream << "," << m_current->fullByteSize()
+                << "," << m_current->gpuByteSize()
+                << "," << m_current->cpuByteSize()
+                << "," << m_residentSetSizeBeforeGeometry
+                << "," << m_peakResidentSetSizeDuringGeometry;
+
+            // At the first frame of the camera path
+            m_cameraFrame = 0;
+
+            measurePipelineStatistics(m_postprocessing->fbo());
+
+            for (auto i = size_t(0); i < PipelineStatistics::counterCount(); ++i)
+            {
+                stream << ",";
+
+                if (m_pipelineStatistics.available(i))
+                {
+                    stream << m_pipelineStatistics.result(i);
+                }
+            }
+
+            stream << std::endl;
+        }
+
+        m_benchmarkTechniques.resize(techniqueCount);
+        m_benchmarkBytesPerPrimitive.resize(techniqueCount, 0.0);
+
+        m_benchmarkTechniques[technique] = m_current->name();
+        m_benchmarkBytesPerPrimitive[technique] = static_cast<double>(m_current->cpuByteSize() + m_current->gpuByteSize()) / std::max(m_primitiveCount, size_t(1));
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        deinitialize();
+    }
+
+    m_geometryTechnique = -1;
+}
+
+void Rendering::benchmarkFrames(bool rasterizerDiscard, Measurement & warmup, Measurement & measurement)
 {
-    const auto reference = std::accumulate(m_implementations.begin(), m_implementations.end(),
-            std::accumulate(m_implementations.begin(), m_implementations.end(), 0, [](size_t currentSize, const Implementation * technique) {
-                return std::max(currentSize, technique->fullByteSize());
-            }), [](size_t currentSize, const Implementation * technique) {
-        return std::min(currentSize, technique->fullByteSize());
+    warmup.reset(benchmarkWarmupCount);
+    measurement.reset(benchmarkMeasureCount);
+
+    // Each run follows the camera path from its first frame, so preset 0 renders the same views for every technique
+    m_cameraFrame = 0;
+
+    m_timer.discard();
+
+    while (requiresSample(m_timer, warmup, measurement))
+    {
+        collectSamples(m_timer, warmup, measurement, false);
+        Trace::instance().collect();
+
+        glViewport(0, 0, m_width, m_height);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_postprocessing->fbo());
+
+        glClearBufferfv(GL_COLOR, 0, clearColor);
+        glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
+
+        prepareRendering();
+
+        if (rasterizerDiscard)
+        {
+            glEnable(GL_RASTERIZER_DISCARD);
+        }
+
+        m_timer.begin();
+
+        m_current->render();
+
+        m_timer.end();
+
+        if (rasterizerDiscard)
+        {
+            glDisable(GL_RASTERIZER_DISCARD);
+        }
+
+        finalizeRendering();
+
+        ++m_cameraFrame;
+    }
+
+    collectSamples(m_timer, warmup, measurement, true);
+}
+
+void Rendering::measurePipelineStatistics(GLuint fbo)
+{
+    glViewport(0, 0, m_width, m_height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    prepareRendering();
+
+    m_pipelineStatistics.measure([this]() {
+        m_current->render();
     });
 
-    const auto printSpaceMeasurement = [&reference](const std::string & techniqueName, size_t byteSize)
+    finalizeRendering();
+}
+
+void Rendering::printMeasurement(const std::string & name, const Measurement & measurement) const
+{
+    const auto statistics = measurement.statistics();
+
+    std::cout << "Measured " << (statistics.median / 1000.0) << "µs (median) for " << name << std::endl;
+    std::cout << "  min " << (statistics.min / 1000.0) << "µs"
+        << ", p90 " << (statistics.p90 / 1000.0) << "µs"
+        << ", p99 " << (statistics.p99 / 1000.0) << "µs"
+        << ", max " << (statistics.max / 1000.0) << "µs" << std::endl;
+    std::cout << "  mean " << (statistics.mean / 1000.0) << "µs"
+        << ", stddev " << (statistics.stddev / 1000.0) << "µs"
+        << " (" << statistics.outliers << " of " << statistics.count << " samples rejected as outliers)" << std::endl;
+}
+
+void Rendering::printDropped(const std::string & name, size_t dropped) const
+{
+    if (dropped == 0)
     {
-        std::cout << techniqueName << std::endl << (byteSize / 1024) << "kB (" << (static_cast<float>(byteSize) / reference) << "x)" << std::endl;
-    };
+        return;
+    }
+
+    std::cout << "  " << dropped << " frames of " << name << " not timed, all timer queries were still in flight" << std::endl;
+}
+
+void Rendering::printPipelineStatistics()
+{
+    const auto count = primitiveCount();
+
+    std::cout << "Pipeline statistics for one frame (per primitive)" << std::endl;
+
+    for (auto i = size_t(0); i < PipelineStatistics::counterCount(); ++i)
+    {
+        if (!m_pipelineStatistics.available(i))
+        {
+            continue;
+        }
+
+        std::cout << "  " << PipelineStatistics::counterName(i) << " " << m_pipelineStatistics.result(i)
+            << " (" << (static_cast<float>(m_pipelineStatistics.result(i)) / count) << ")" << std::endl;
+    }
+
+    if (!m_pipelineStatistics.available(PipelineStatistics::counterCount() - 1))
+    {
+        std::cout << "  Per-stage counters need ARB_pipeline_statistics_query" << std::endl;
+    }
+}
+
+void Rendering::spaceMeasurement()
+{
+    // Buffers are only allocated on initialization
+    auto reference = std::numeric_limits<size_t>::max();
+
+    for (const auto implementation : m_implementations)
+    {
+        implementation->initialize();
+
+        reference = std::min(reference, implementation->gpuByteSize());
+    }
 
     std::cout << "Count: " << primitiveCount() << std::endl;
+
+    if (m_residentSetSizeAfterGeometry > 0)
+    {
+        std::cout << "Resident set " << (m_residentSetSizeAfterGeometry / 1024) << "kB after geometry creation ("
+            << (m_residentSetSizeBeforeGeometry / 1024) << "kB before, peak " << (m_peakResidentSetSizeDuringGeometry / 1024) << "kB)" << std::endl;
+    }
+
     std::cout << std::endl;
 
     for (const auto implementation : m_implementations)
     {
-        printSpaceMeasurement(implementation->name(), implementation->fullByteSize());
+        const auto gpuByteSize = implementation->gpuByteSize();
+
+        std::cout << implementation->name() << std::endl
+            << "  GPU " << (gpuByteSize / 1024) << "kB (" << (static_cast<float>(gpuByteSize) / reference) << "x)" << std::endl
+            << "  CPU " << (implementation->cpuByteSize() / 1024) << "kB" << std::endl
+            << "  estimated " << (implementation->fullByteSize() / 1024) << "kB" << std::endl;
     }
+
+    onSpaceMeasurement();
+}
+
+void Rendering::onSpaceMeasurement()
+{
+}
+
+void Rendering::onStartRecording()
+{
+}
+
+bool Rendering::onReplay(const InteractionEvent & /*event*/)
+{
+    return false;
 }
 
 size_t Rendering::measureGPU(std::function<void()> callback, bool on) const
@@ -420,14 +948,9 @@ size_t Rendering::measureGPU(std::function<void()> callback, bool on) const
 
     glEndQuery(gl::GL_TIME_ELAPSED);
 
-    int available = 0;
-    while (!available)
-    {
-        glGetQueryObjectiv(m_query, gl::GL_QUERY_RESULT_AVAILABLE, &available);
-    }
-
-    int value;
-    glGetQueryObjectiv(m_query, gl::GL_QUERY_RESULT, &value);
+    // Synchronous on purpose; per-frame timings go through the pipelined GPUTimer instead
+    auto value = static_cast<GLuint64>(0);
+    glGetQueryObjectui64v(m_query, gl::GL_QUERY_RESULT, &value);
 
     return static_cast<std::size_t>(value);
 }
@@ -473,33 +996,237 @@ void Rendering::measureGPU(const std::string & name, std::function<void()> callb
 void Rendering::toggleRasterizerDiscard()
 {
     m_rasterizerDiscard = !m_rasterizerDiscard;
+
+    record("rasterizerDiscard", m_rasterizerDiscard);
 }
 
 void Rendering::startFPSMeasuring()
 {
+    record("fps");
+
     m_fpsSamples = 0;
     m_fpsMeasurementStart = std::chrono::high_resolution_clock::now();
+    m_cameraFrame = 0;
 }
 
 void Rendering::startPerformanceMeasuring()
 {
+    record("performance");
+
     m_inMeasurement = true;
-    m_count = 0;
-    m_warmupCount = warmupCount;
-    m_sum = 0;
+    m_cameraFrame = 0;
+    m_timer.discard();
+    m_warmup.reset(warmupCount);
+    m_measurement.reset(measureCount);
+}
+
+void Rendering::toggleContinuousTiming()
+{
+    m_continuousTiming = !m_continuousTiming;
+
+    record("continuousTiming", m_continuousTiming);
+
+    m_continuousTimer.discard();
+    m_continuous.reset(continuousSampleCount);
+
+    std::cout << "Continuous GPU timing " << (m_continuousTiming ? "on" : "off") << std::endl;
+}
+
+void Rendering::startTracing()
+{
+    std::cout << "Start tracing" << std::endl;
+
+    Trace::instance().start();
+
+    // Written even if no frame is dropped
+    Trace::instance().count("droppedTimerFrames", 0);
+}
+
+void Rendering::stopTracing()
+{
+    if (!Trace::instance().recording())
+    {
+        return;
+    }
+
+    Trace::instance().stop();
+    Trace::instance().write(m_name + "-trace.json");
+}
+
+void Rendering::toggleTracing()
+{
+    if (Trace::instance().recording())
+    {
+        stopTracing();
+    }
+    else
+    {
+        startTracing();
+    }
+}
+
+void Rendering::startRecording()
+{
+    std::cout << "Start recording interaction" << std::endl;
+
+    m_recordedInteraction.clear();
+    m_recordingStart = m_frame;
+    m_recording = true;
+
+    // Replays start from a fresh session, so the current state is recorded first
+    record("technique", static_cast<int>(std::find(m_implementations.begin(), m_implementations.end(), m_current) - m_implementations.begin()));
+    record("camera", m_cameraSetting);
+    record("cameraFrame", static_cast<int>(m_cameraFrame));
+    record("rasterizerDiscard", m_rasterizerDiscard);
+    record("postprocessing", m_usePostprocessing);
+
+    onStartRecording();
+}
+
+void Rendering::stopRecording()
+{
+    if (!m_recording)
+    {
+        return;
+    }
+
+    record("end");
+
+    m_recording = false;
+
+    m_recordedInteraction.save(m_name + "-interaction.txt");
+}
+
+void Rendering::toggleRecording()
+{
+    if (m_recording)
+    {
+        stopRecording();
+    }
+    else
+    {
+        startRecording();
+    }
+}
+
+bool Rendering::startReplay(const std::string & filename)
+{
+    if (!m_replayedInteraction.load(filename))
+    {
+        return false;
+    }
+
+    std::cout << "Replay " << m_replayedInteraction.size() << " events from " << filename << std::endl;
+
+    m_frame = 0;
+    m_cameraFrame = 0;
+    m_replaying = true;
+
+    return true;
+}
+
+bool Rendering::replayFinished() const
+{
+    return m_replaying && m_replayedInteraction.finished();
+}
+
+bool Rendering::loadCameraPath(const std::string & filename)
+{
+    return m_cameraPath.load(filename);
+}
+
+void Rendering::record(const std::string & command, int value)
+{
+    if (!m_recording)
+    {
+        return;
+    }
+
+    m_recordedInteraction.add(m_frame - m_recordingStart, command, value);
+}
+
+void Rendering::replay(const InteractionEvent & event)
+{
+    if (event.command == "technique")
+    {
+        setTechnique(event.value);
+    }
+    else if (event.command == "camera")
+    {
+        setCameraTechnique(event.value);
+    }
+    else if (event.command == "cameraFrame")
+    {
+        m_cameraFrame = static_cast<size_t>(event.value);
+    }
+    else if (event.command == "rasterizerDiscard")
+    {
+        if (m_rasterizerDiscard != (event.value != 0))
+        {
+            toggleRasterizerDiscard();
+        }
+    }
+    else if (event.command == "postprocessing")
+    {
+        if (m_usePostprocessing != (event.value != 0))
+        {
+            togglePostprocessing();
+        }
+    }
+    else if (event.command == "continuousTiming")
+    {
+        if (m_continuousTiming != (event.value != 0))
+        {
+            toggleContinuousTiming();
+        }
+    }
+    else if (event.command == "fps")
+    {
+        startFPSMeasuring();
+    }
+    else if (event.command == "performance")
+    {
+        startPerformanceMeasuring();
+    }
+    else if (event.command == "end")
+    {
+        std::cout << "Replay finished after " << event.frame << " frames" << std::endl;
+    }
+    else if (!onReplay(event))
+    {
+        std::cerr << "Unknown interaction '" << event.command << "' in frame " << event.frame << std::endl;
+    }
 }
 
 void Rendering::togglePostprocessing()
 {
     m_usePostprocessing = !m_usePostprocessing;
+
+    record("postprocessing", m_usePostprocessing);
+}
+
+void Rendering::setPrimitiveCount(size_t primitiveCount)
+{
+    m_primitiveCount = primitiveCount;
+}
+
+void Rendering::recreateGeometry()
+{
+    const auto current = std::find(m_implementations.begin(), m_implementations.end(), m_current);
+    const auto technique = static_cast<int>(current - m_implementations.begin());
+
+    deinitialize();
+    initialize();
+
+    setTechnique(technique);
 }
 
-void Rendering::setGridSize(int gridSize)
+size_t Rendering::gridPrimitiveCount(int gridSize) const
 {
-    m_gridSize = gridSize;
+    return static_cast<size_t>(gridSize) * gridSize * gridSize;
 }
 
 size_t Rendering::primitiveCount()
 {
-    return static_cast<std::size_t>(m_gridSize * m_gridSize * m_gridSize);
+    return m_primitiveCount;
 }
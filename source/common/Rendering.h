@@ -1,17 +1,36 @@
 
+#pragma once
+
 #include <chrono>
 #include <vector>
+#include <iosfwd>
 
 #include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
 
 #include <glbinding/gl/types.h>
 
+#include "CameraPath.h"
+#include "GPUTimer.h"
+#include "InteractionLog.h"
+#include "Measurement.h"
+#include "PipelineStatistics.h"
+
 
 class Implementation;
 class Postprocessing;
 class Screenshot;
 
 
+// Outcome of Rendering::compareToBaseline()
+enum class BaselineComparison
+{
+    Passed,
+    Regressed,      // A metric regressed beyond the threshold or, if strict, a baseline entry was not benchmarked
+    Unreadable      // The baseline or the benchmark results could not be loaded
+};
+
+
 class Rendering
 {
 public:
@@ -32,9 +51,29 @@ public:
     void reloadShaders();
     void startFPSMeasuring();
     void startPerformanceMeasuring();
+    void toggleContinuousTiming();
+    void startTracing();
+    void stopTracing();
+    void toggleTracing();
+    void startRecording();
+    void stopRecording();
+    void toggleRecording();
+    bool startReplay(const std::string & filename);
+    bool replayFinished() const;
+    bool loadCameraPath(const std::string & filename);
     void takeScreenshot();
+    void benchmark(const std::vector<size_t> & primitiveCounts);
+    void sweep(size_t minPrimitiveCount, size_t maxPrimitiveCount, size_t steps);
+    bool saveBaseline(const std::string & filename) const;
+    BaselineComparison compareToBaseline(const std::string & filename, double threshold, bool strict) const;
+
+    void setPrimitiveCount(size_t primitiveCount);
 
-    void setGridSize(int gridSize);
+    // Rebuilds all implementations, keeping the current technique
+    void recreateGeometry();
+
+    // Primitive count of the grid size presets; cubic by default
+    virtual size_t gridPrimitiveCount(int gridSize) const;
 
 protected:
     std::string m_name;
@@ -48,33 +87,72 @@ protected:
 
     int m_width;
     int m_height;
-    int m_gridSize;
+    size_t m_primitiveCount;
 
     bool m_usePostprocessing;
     bool m_rasterizerDiscard;
 
     // Performance helper
-    std::chrono::high_resolution_clock::time_point m_start;
     gl::GLuint m_query;
 
+    // Reproducible frame sequences; the camera frame restarts with each measurement
+    size_t m_frame;
+    size_t m_cameraFrame;
+    CameraPath m_cameraPath;
+    bool m_recording;
+    size_t m_recordingStart;
+    InteractionLog m_recordedInteraction;
+    bool m_replaying;
+    InteractionLog m_replayedInteraction;
+
     // FPS measuring
     size_t m_fpsSamples;
     std::chrono::high_resolution_clock::time_point m_fpsMeasurementStart;
 
     // Performance measuring
     bool m_inMeasurement;
-    size_t m_count;
-    size_t m_warmupCount;
-    size_t m_sum;
+    GPUTimer m_timer;
+    Measurement m_warmup;
+    Measurement m_measurement;
+    PipelineStatistics m_pipelineStatistics;
+
+    // Continuous measuring
+    bool m_continuousTiming;
+    GPUTimer m_continuousTimer;
+    Measurement m_continuous;
+
+    // Memory measuring
+    size_t m_residentSetSizeBeforeGeometry;
+    size_t m_residentSetSizeAfterGeometry;
+    size_t m_peakResidentSetSizeDuringGeometry;
+
+    // The only technique that gets geometry during benchmarks, or -1 for all
+    int m_geometryTechnique;
+    // Footprint of each benchmarked technique, to skip techniques that no longer fit into memory
+    std::vector<std::string> m_benchmarkTechniques;
+    std::vector<double> m_benchmarkBytesPerPrimitive;
 
 protected:
     void cameraPosition(glm::vec3 & eye, glm::vec3 & center, glm::vec3 & up) const;
+    void camera(glm::vec3 & eye, glm::mat4 & viewProjection) const;
+
+    // Projected height in pixels of a unit length at unit distance
+    float pixelsPerUnit() const;
+
+    void renderFrame();
+
+    // Adds a command to the recorded interaction, if recording; demos record their own commands and replay them in onReplay()
+    void record(const std::string & command, int value = 0);
+    void replay(const InteractionEvent & event);
 
     void prepareRendering();
     void finalizeRendering();
 
     void addImplementation(Implementation * implementation);
 
+    // The implementations onCreateGeometry() has to fill
+    std::vector<Implementation *> geometryImplementations() const;
+
     size_t measureGPU(std::function<void()> callback, bool on) const;
     size_t measureCPU(std::function<void()> callback, bool on) const;
     void measureGPU(const std::string & name, std::function<void()> callback, bool on) const;
@@ -82,6 +160,17 @@ protected:
 
     size_t primitiveCount();
 
+    std::string benchmarkFilename() const;
+    void benchmarkGeometry(std::ostream & stream);
+    void benchmarkFrames(bool rasterizerDiscard, Measurement & warmup, Measurement & measurement);
+
+    void measurePipelineStatistics(gl::GLuint fbo);
+
+    void printMeasurement(const std::string & name, const Measurement & measurement) const;
+    // Frames a GPUTimer skipped while a measurement ran, if any
+    void printDropped(const std::string & name, size_t dropped) const;
+    void printPipelineStatistics();
+
 protected:
     // Subclass interface
 
@@ -90,4 +179,12 @@ protected:
     virtual void onCreateGeometry() = 0;
     virtual void onPrepareRendering() = 0;
     virtual void onFinalizeRendering() = 0;
+
+    // Called at the end of the memory comparison for demo-specific reports
+    virtual void onSpaceMeasurement();
+
+    // Demo-specific interaction: onStartRecording() records the demo state a replay has to start from, and
+    // onReplay() applies the commands the demo recorded with record(); returns false for unknown commands
+    virtual void onStartRecording();
+    virtual bool onReplay(const InteractionEvent & event);
 };
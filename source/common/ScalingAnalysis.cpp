@@ -0,0 +1,333 @@
+
+#include "ScalingAnalysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+#include "common.h"
+
+
+namespace
+{
+
+
+static const char * fittedColumns[] = { "geometryMedianNs", "frameMedianNs" };
+
+
+class Samples
+{
+public:
+    std::vector<double> primitiveCounts;
+    std::vector<double> times;
+};
+
+
+// Weighted by 1/t², so every sample counts by its relative error; otherwise the largest primitive counts
+// of a geometric sweep would dominate and leave the overhead to the noise of the largest times
+ScalingFit fit(const Samples & samples)
+{
+    auto result = ScalingFit();
+
+    auto sumW = 0.0;
+    auto sumX = 0.0;
+    auto sumY = 0.0;
+
+    for (auto i = size_t(0); i < samples.times.size(); ++i)
+    {
+        const auto w = 1.0 / (samples.times[i] * samples.times[i]);
+
+        sumW += w;
+        sumX += w * samples.primitiveCounts[i];
+        sumY += w * samples.times[i];
+    }
+
+    const auto meanX = sumX / sumW;
+    const auto meanY = sumY / sumW;
+
+    auto covariance = 0.0;
+    auto varianceX = 0.0;
+    auto varianceY = 0.0;
+
+    for (auto i = size_t(0); i < samples.times.size(); ++i)
+    {
+        const auto w = 1.0 / (samples.times[i] * samples.times[i]);
+        const auto dx = samples.primitiveCounts[i] - meanX;
+        const auto dy = samples.times[i] - meanY;
+
+        covariance += w * dx * dy;
+        varianceX += w * dx * dx;
+        varianceY += w * dy * dy;
+    }
+
+    result.sampleCount = samples.times.size();
+    result.minPrimitiveCount = *std::min_element(samples.primitiveCounts.begin(), samples.primitiveCounts.end());
+    result.maxPrimitiveCount = *std::max_element(samples.primitiveCounts.begin(), samples.primitiveCounts.end());
+    result.nsPerPrimitive = varianceX > 0.0 ? covariance / varianceX : 0.0;
+    result.overheadNs = meanY - result.nsPerPrimitive * meanX;
+    result.r2 = varianceX > 0.0 && varianceY > 0.0 ? (covariance * covariance) / (varianceX * varianceY) : 1.0;
+
+    auto sumSquaredResiduals = 0.0;
+
+    for (auto i = size_t(0); i < samples.times.size(); ++i)
+    {
+        const auto predicted = result.overheadNs + result.nsPerPrimitive * samples.primitiveCounts[i];
+        const auto residual = std::abs(predicted - samples.times[i]) / samples.times[i];
+
+        sumSquaredResiduals += residual * residual;
+        result.maxResidual = std::max(result.maxResidual, residual);
+    }
+
+    result.rmsResidual = std::sqrt(sumSquaredResiduals / samples.times.size());
+
+    return result;
+}
+
+
+} // namespace
+
+
+ScalingFit::ScalingFit()
+: sampleCount(0)
+, minPrimitiveCount(0.0)
+, maxPrimitiveCount(0.0)
+, overheadNs(0.0)
+, nsPerPrimitive(0.0)
+, r2(0.0)
+, rmsResidual(0.0)
+, maxResidual(0.0)
+{
+}
+
+
+ScalingCrossover::ScalingCrossover()
+: primitiveCount(0.0)
+, measured(false)
+{
+}
+
+
+ScalingAnalysis::ScalingAnalysis()
+{
+}
+
+bool ScalingAnalysis::load(const std::string & benchmarkFilename)
+{
+    auto stream = std::ifstream(benchmarkFilename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open benchmark file '" << benchmarkFilename << "'." << std::endl;
+
+        return false;
+    }
+
+    auto line = std::string();
+    std::getline(stream, line);
+
+    const auto columns = splitLine(line, ',');
+    const auto column = [&columns](const std::string & name) {
+        return static_cast<size_t>(std::find(columns.begin(), columns.end(), name) - columns.begin());
+    };
+
+    const auto technique = column("technique");
+    const auto cameraPreset = column("cameraPreset");
+    const auto primitiveCount = column("primitiveCount");
+
+    if (technique >= columns.size() || cameraPreset >= columns.size() || primitiveCount >= columns.size())
+    {
+        std::cerr << "Benchmark file '" << benchmarkFilename << "' lacks technique, camera preset or primitive count." << std::endl;
+
+        return false;
+    }
+
+    // Keyed by metric, camera preset and technique
+    auto samples = std::map<std::vector<std::string>, Samples>();
+
+    while (std::getline(stream, line))
+    {
+        const auto values = splitLine(line, ',');
+
+        if (values.size() != columns.size())
+        {
+            continue;
+        }
+
+        for (const auto metric : fittedColumns)
+        {
+            const auto index = column(metric);
+
+            if (index >= columns.size() || values[index].empty())
+            {
+                continue;
+            }
+
+            const auto time = std::strtod(values[index].c_str(), nullptr);
+
+            // The relative weights need positive times
+            if (!(time > 0.0) || !std::isfinite(time))
+            {
+                continue;
+            }
+
+            auto & entry = samples[{ metric, values[cameraPreset], values[technique] }];
+
+            entry.primitiveCounts.push_back(std::strtod(values[primitiveCount].c_str(), nullptr));
+            entry.times.push_back(time);
+        }
+    }
+
+    m_fits.clear();
+
+    for (const auto & entry : samples)
+    {
+        auto result = fit(entry.second);
+
+        result.metric = entry.first[0];
+        result.cameraPreset = entry.first[1];
+        result.technique = entry.first[2];
+
+        m_fits.push_back(result);
+    }
+
+    return true;
+}
+
+const std::vector<ScalingFit> & ScalingAnalysis::fits() const
+{
+    return m_fits;
+}
+
+std::vector<ScalingCrossover> ScalingAnalysis::crossovers() const
+{
+    auto result = std::vector<ScalingCrossover>();
+
+    for (auto i = size_t(0); i < m_fits.size(); ++i)
+    {
+        for (auto j = i + 1; j < m_fits.size(); ++j)
+        {
+            const auto & a = m_fits[i];
+            const auto & b = m_fits[j];
+
+            if (a.metric != b.metric || a.cameraPreset != b.cameraPreset || a.nsPerPrimitive == b.nsPerPrimitive)
+            {
+                continue;
+            }
+
+            const auto count = (b.overheadNs - a.overheadNs) / (a.nsPerPrimitive - b.nsPerPrimitive);
+
+            if (count <= 0.0)
+            {
+                continue;
+            }
+
+            auto crossover = ScalingCrossover();
+            crossover.cameraPreset = a.cameraPreset;
+            crossover.metric = a.metric;
+            crossover.smallCountTechnique = a.overheadNs < b.overheadNs ? a.technique : b.technique;
+            crossover.largeCountTechnique = a.overheadNs < b.overheadNs ? b.technique : a.technique;
+            crossover.primitiveCount = count;
+            crossover.measured = count >= std::max(a.minPrimitiveCount, b.minPrimitiveCount)
+                && count <= std::min(a.maxPrimitiveCount, b.maxPrimitiveCount);
+
+            result.push_back(crossover);
+        }
+    }
+
+    return result;
+}
+
+bool ScalingAnalysis::write(const std::string & filename) const
+{
+    auto stream = std::ofstream(filename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open output file '" << filename << "'." << std::endl;
+
+        return false;
+    }
+
+    stream << "technique,cameraPreset,metric,samples,minPrimitiveCount,maxPrimitiveCount,overheadNs,nsPerPrimitive,r2,rmsResidual,maxResidual" << std::endl;
+
+    for (const auto & fit : m_fits)
+    {
+        stream << fit.technique << ","
+            << fit.cameraPreset << ","
+            << fit.metric << ","
+            << fit.sampleCount << ","
+            << fit.minPrimitiveCount << ","
+            << fit.maxPrimitiveCount << ","
+            << fit.overheadNs << ","
+            << fit.nsPerPrimitive << ","
+            << fit.r2 << ","
+            << fit.rmsResidual << ","
+            << fit.maxResidual << std::endl;
+    }
+
+    std::cout << "Scaling fits written to " << filename << std::endl;
+
+    return true;
+}
+
+bool ScalingAnalysis::writeCrossovers(const std::string & filename) const
+{
+    auto stream = std::ofstream(filename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open output file '" << filename << "'." << std::endl;
+
+        return false;
+    }
+
+    stream << "cameraPreset,metric,smallCountTechnique,largeCountTechnique,primitiveCount,measured" << std::endl;
+
+    for (const auto & crossover : crossovers())
+    {
+        stream << crossover.cameraPreset << ","
+            << crossover.metric << ","
+            << crossover.smallCountTechnique << ","
+            << crossover.largeCountTechnique << ","
+            << static_cast<size_t>(crossover.primitiveCount) << ","
+            << (crossover.measured ? 1 : 0) << std::endl;
+    }
+
+    std::cout << "Scaling crossovers written to " << filename << std::endl;
+
+    return true;
+}
+
+void ScalingAnalysis::print(std::ostream & stream) const
+{
+    const auto flags = stream.flags();
+    const auto precision = stream.precision();
+
+    stream << std::left << std::setw(28) << "technique" << std::setw(8) << "preset" << std::setw(20) << "metric"
+        << std::right << std::setw(14) << "overhead µs" << std::setw(16) << "ns/primitive" << std::setw(8) << "r2"
+        << std::setw(12) << "rms res %" << std::setw(12) << "max res %" << std::endl;
+
+    for (const auto & fit : m_fits)
+    {
+        stream << std::left << std::setw(28) << fit.technique << std::setw(8) << fit.cameraPreset << std::setw(20) << fit.metric
+            << std::right << std::fixed << std::setprecision(2) << std::setw(13) << (fit.overheadNs / 1000.0)
+            << std::setprecision(4) << std::setw(16) << fit.nsPerPrimitive
+            << std::setprecision(3) << std::setw(8) << fit.r2
+            << std::setprecision(1) << std::setw(12) << (fit.rmsResidual * 100.0) << std::setw(12) << (fit.maxResidual * 100.0) << std::endl;
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+
+    for (const auto & crossover : crossovers())
+    {
+        stream << "Preset " << crossover.cameraPreset << ", " << crossover.metric << ": "
+            << crossover.smallCountTechnique << " is faster below, " << crossover.largeCountTechnique << " above "
+            << static_cast<size_t>(crossover.primitiveCount) << " primitives"
+            << (crossover.measured ? "" : " (extrapolated)") << std::endl;
+    }
+}
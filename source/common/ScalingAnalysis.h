@@ -0,0 +1,67 @@
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+// Linear model of a median GPU time: overheadNs + nsPerPrimitive * primitiveCount, fitted to the relative errors
+class ScalingFit
+{
+public:
+    ScalingFit();
+
+    std::string technique;
+    std::string cameraPreset;
+    std::string metric;
+
+    size_t sampleCount;
+    double minPrimitiveCount;
+    double maxPrimitiveCount;
+
+    double overheadNs;
+    double nsPerPrimitive;
+    double r2;
+
+    // Deviations of the measured times from the model, relative to the times
+    double rmsResidual;
+    double maxResidual;
+};
+
+
+// Primitive count at which the cheaper of two techniques changes
+class ScalingCrossover
+{
+public:
+    ScalingCrossover();
+
+    std::string cameraPreset;
+    std::string metric;
+    std::string smallCountTechnique;
+    std::string largeCountTechnique;
+    double primitiveCount;
+
+    // Whether the crossover lies within the measured primitive counts of both fits
+    bool measured;
+};
+
+
+// Fits the benchmark results of a sweep over primitive counts per technique, camera preset and metric
+class ScalingAnalysis
+{
+public:
+    ScalingAnalysis();
+
+    bool load(const std::string & benchmarkFilename);
+
+    const std::vector<ScalingFit> & fits() const;
+    std::vector<ScalingCrossover> crossovers() const;
+
+    bool write(const std::string & filename) const;
+    bool writeCrossovers(const std::string & filename) const;
+    void print(std::ostream & stream) const;
+
+protected:
+    std::vector<ScalingFit> m_fits;
+};
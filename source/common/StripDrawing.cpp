@@ -0,0 +1,171 @@
+
+#include "StripDrawing.h"
+
+#include <glbinding/gl/gl.h>
+
+using namespace gl;
+
+
+const GLuint StripDrawing::restartIndex;
+
+StripDrawing::StripDrawing(StripDrawMode mode)
+: m_mode(mode)
+, m_indices(0)
+, m_count(0)
+{
+}
+
+StripDrawing::~StripDrawing()
+{
+    if (m_indices == 0)
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_indices);
+}
+
+std::string StripDrawing::name(const std::string & techniqueName, StripDrawMode mode)
+{
+    switch (mode)
+    {
+    case StripDrawMode::PrimitiveRestart: return techniqueName + " (Primitive Restart)";
+    case StripDrawMode::Degenerate: return techniqueName + " (Degenerate)";
+    default: return techniqueName;
+    }
+}
+
+StripDrawMode StripDrawing::mode() const
+{
+    return m_mode;
+}
+
+std::vector<GLuint> StripDrawing::vertexOrder(const std::vector<GLint> & starts, const std::vector<GLint> & counts) const
+{
+    auto order = std::vector<GLuint>();
+
+    if (m_mode != StripDrawMode::Degenerate)
+    {
+        return order;
+    }
+
+    auto vertexCount = size_t(0);
+
+    for (const auto count : counts)
+    {
+        vertexCount += count + 3;
+    }
+
+    order.reserve(vertexCount);
+
+    for (auto i = size_t(0); i < starts.size(); ++i)
+    {
+        if (counts[i] == 0)
+        {
+            continue;
+        }
+
+        const auto first = static_cast<GLuint>(starts[i]);
+
+        // Each connecting triangle repeats a vertex; the strip itself starts at an even position
+        if (!order.empty())
+        {
+            order.push_back(order.back());
+            order.push_back(first);
+
+            if (order.size() % 2 == 1)
+            {
+                order.push_back(first);
+            }
+        }
+
+        for (auto j = GLuint(0); j < static_cast<GLuint>(counts[i]); ++j)
+        {
+            order.push_back(first + j);
+        }
+    }
+
+    return order;
+}
+
+std::vector<GLuint> StripDrawing::restartIndices(const std::vector<GLint> & starts, const std::vector<GLint> & counts)
+{
+    auto indices = std::vector<GLuint>();
+
+    for (auto i = size_t(0); i < starts.size(); ++i)
+    {
+        if (counts[i] == 0)
+        {
+            continue;
+        }
+
+        for (auto j = GLint(0); j < counts[i]; ++j)
+        {
+            indices.push_back(static_cast<GLuint>(starts[i] + j));
+        }
+
+        indices.push_back(restartIndex);
+    }
+
+    return indices;
+}
+
+void StripDrawing::initialize(const std::vector<GLint> & starts, const std::vector<GLint> & counts, size_t vertexCount)
+{
+    if (m_mode == StripDrawMode::Degenerate)
+    {
+        m_count = static_cast<GLsizei>(vertexCount);
+    }
+
+    if (m_mode != StripDrawMode::PrimitiveRestart)
+    {
+        return;
+    }
+
+    const auto indices = restartIndices(starts, counts);
+
+    m_count = static_cast<GLsizei>(indices.size());
+
+    // Reinitialization after a refill reuses the buffer
+    if (m_indices == 0)
+    {
+        glGenBuffers(1, &m_indices);
+    }
+
+    // The element array binding is part of the VAO state
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indices);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+}
+
+void StripDrawing::draw(const std::vector<GLint> & starts, const std::vector<GLint> & counts) const
+{
+    switch (m_mode)
+    {
+    case StripDrawMode::PrimitiveRestart:
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(restartIndex);
+
+        glDrawElements(GL_TRIANGLE_STRIP, m_count, GL_UNSIGNED_INT, nullptr);
+
+        glDisable(GL_PRIMITIVE_RESTART);
+        break;
+
+    case StripDrawMode::Degenerate:
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, m_count);
+        break;
+
+    default:
+        glMultiDrawArrays(GL_TRIANGLE_STRIP, starts.data(), counts.data(), static_cast<GLsizei>(starts.size()));
+        break;
+    }
+}
+
+GLuint StripDrawing::buffer() const
+{
+    return m_indices;
+}
+
+size_t StripDrawing::byteSize() const
+{
+    return m_mode == StripDrawMode::PrimitiveRestart ? m_count * sizeof(GLuint) : 0;
+}
@@ -0,0 +1,74 @@
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glbinding/gl/types.h>
+
+
+// How a technique submits its triangle strips, which are stored back to back in one vertex buffer
+enum class StripDrawMode
+{
+    MultiDraw,          // glMultiDrawArrays with one entry per strip
+    PrimitiveRestart,   // one glDrawElements over an index buffer with a restart index after each strip
+    Degenerate          // one glDrawArrays over all strips, stitched by degenerate triangles
+};
+
+
+// Draw data of the strip draw modes; the multi-draw arrays stay with the technique
+class StripDrawing
+{
+public:
+    static const gl::GLuint restartIndex = 0xffffffff;
+
+    StripDrawing(StripDrawMode mode);
+    ~StripDrawing();
+
+    // The technique name with the mode appended, e.g., "Triangle Strip (Primitive Restart)"
+    static std::string name(const std::string & techniqueName, StripDrawMode mode);
+
+    StripDrawMode mode() const;
+
+    // Order to gather the vertex attributes in before their upload; empty if they stay in place.
+    // Stitching duplicates the last vertex of a strip and the first of the next, the latter twice where needed to keep the winding.
+    std::vector<gl::GLuint> vertexOrder(const std::vector<gl::GLint> & starts, const std::vector<gl::GLint> & counts) const;
+
+    // Indices of the strips, each followed by the restart index
+    static std::vector<gl::GLuint> restartIndices(const std::vector<gl::GLint> & starts, const std::vector<gl::GLint> & counts);
+
+    // Creates the index buffer for primitive restart; expects the technique's VAO to be bound
+    void initialize(const std::vector<gl::GLint> & starts, const std::vector<gl::GLint> & counts, size_t vertexCount);
+
+    void draw(const std::vector<gl::GLint> & starts, const std::vector<gl::GLint> & counts) const;
+
+    // Index buffer, zero for the other modes
+    gl::GLuint buffer() const;
+    size_t byteSize() const;
+
+protected:
+    StripDrawMode m_mode;
+
+    gl::GLuint m_indices;
+    gl::GLsizei m_count;
+};
+
+
+// Reorders values, e.g., a vertex attribute, by the given order
+template <typename T>
+void gatherVertices(std::vector<T> & values, const std::vector<gl::GLuint> & order);
+
+
+template <typename T>
+void gatherVertices(std::vector<T> & values, const std::vector<gl::GLuint> & order)
+{
+    auto gathered = std::vector<T>(order.size());
+
+#pragma omp parallel for
+    for (long i = 0; i < static_cast<long>(order.size()); ++i)
+    {
+        gathered[i] = values[order[i]];
+    }
+
+    values.swap(gathered);
+}
@@ -0,0 +1,281 @@
+
+#include "Trace.h"
+
+#include <fstream>
+#include <iostream>
+
+#include <glbinding/gl/gl.h>
+
+#include "common.h"
+
+
+using namespace gl;
+
+
+namespace
+{
+
+
+// Thread ids of the two timelines in the trace
+static const auto cpuThread = 1;
+static const auto gpuThread = 2;
+
+
+void writeEvent(std::ostream & stream, const TraceEvent & event, int thread, long long begin, long long end)
+{
+    stream << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+        << ",\"ts\":" << (begin / 1000.0) << ",\"dur\":" << ((end - begin) / 1000.0);
+
+    if (!event.detail.empty())
+    {
+        stream << ",\"args\":{\"detail\":\"" << event.detail << "\"}";
+    }
+
+    stream << "}";
+}
+
+
+} // namespace
+
+
+TraceEvent::TraceEvent()
+: name(nullptr)
+, cpuBegin(0)
+, cpuEnd(0)
+, gpuBegin(0)
+, gpuEnd(0)
+, gpuBeginQuery(0)
+, gpuEndQuery(0)
+{
+}
+
+
+Trace & Trace::instance()
+{
+    static Trace trace;
+
+    return trace;
+}
+
+Trace::Trace()
+: m_recording(false)
+, m_debugGroupsSupported(false)
+, m_gpuStart(0)
+{
+}
+
+Trace::~Trace()
+{
+}
+
+bool Trace::recording() const
+{
+    return m_recording;
+}
+
+void Trace::start()
+{
+    if (m_recording)
+    {
+        return;
+    }
+
+    auto major = static_cast<GLint>(0);
+    auto minor = static_cast<GLint>(0);
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+    m_debugGroupsSupported = major > 4 || (major == 4 && minor >= 3) || hasExtension("GL_KHR_debug");
+
+    m_events.clear();
+    m_counts.clear();
+
+    // Both clocks are sampled back to back to align the GPU timeline with the CPU timeline
+    glGetInteger64v(GL_TIMESTAMP, &m_gpuStart);
+    m_cpuStart = std::chrono::high_resolution_clock::now();
+
+    m_recording = true;
+}
+
+void Trace::stop()
+{
+    if (!m_recording)
+    {
+        return;
+    }
+
+    m_recording = false;
+
+    collect(true);
+
+    glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+
+    m_queries.clear();
+}
+
+void Trace::collect()
+{
+    collect(false);
+}
+
+void Trace::count(const std::string & name, size_t value)
+{
+    if (!m_recording)
+    {
+        return;
+    }
+
+    m_counts[name] += value;
+}
+
+void Trace::collect(bool wait)
+{
+    while (!m_pending.empty())
+    {
+        auto & event = m_pending.front();
+
+        if (!wait)
+        {
+            auto available = static_cast<GLint>(0);
+            glGetQueryObjectiv(event.gpuEndQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+
+            if (!available)
+            {
+                return;
+            }
+        }
+
+        resolve(event);
+
+        m_events.push_back(event);
+        m_pending.pop_front();
+    }
+}
+
+void Trace::resolve(TraceEvent & event)
+{
+    auto begin = static_cast<GLuint64>(0);
+    auto end = static_cast<GLuint64>(0);
+
+    glGetQueryObjectui64v(event.gpuBeginQuery, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(event.gpuEndQuery, GL_QUERY_RESULT, &end);
+
+    event.gpuBegin = static_cast<long long>(begin) - m_gpuStart;
+    event.gpuEnd = static_cast<long long>(end) - m_gpuStart;
+
+    m_queries.push_back(event.gpuBeginQuery);
+    m_queries.push_back(event.gpuEndQuery);
+}
+
+long long Trace::cpuTime() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - m_cpuStart).count();
+}
+
+GLuint Trace::acquireQuery()
+{
+    if (m_queries.empty())
+    {
+        auto query = static_cast<GLuint>(0);
+        glGenQueries(1, &query);
+
+        return query;
+    }
+
+    const auto query = m_queries.back();
+    m_queries.pop_back();
+
+    return query;
+}
+
+bool Trace::write(const std::string & filename) const
+{
+    auto stream = std::ofstream(filename);
+
+    if (stream.fail())
+    {
+        std::cerr << "Cannot open output file '" << filename << "'." << std::endl;
+
+        return false;
+    }
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << cpuThread << ",\"args\":{\"name\":\"CPU\"}},\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << gpuThread << ",\"args\":{\"name\":\"GPU\"}}";
+
+    for (const auto & event : m_events)
+    {
+        writeEvent(stream, event, cpuThread, event.cpuBegin, event.cpuEnd);
+        writeEvent(stream, event, gpuThread, event.gpuBegin, event.gpuEnd);
+    }
+
+    stream << "\n],\"otherData\":{";
+
+    for (auto count = m_counts.begin(); count != m_counts.end(); ++count)
+    {
+        stream << (count == m_counts.begin() ? "" : ",") << "\"" << count->first << "\":" << count->second;
+    }
+
+    stream << "}}" << std::endl;
+
+    std::cout << "Trace with " << m_events.size() << " zones written to " << filename << std::endl;
+
+    return true;
+}
+
+
+TraceZone::TraceZone(const char * name, const std::string & detail)
+: m_active(Trace::instance().recording())
+{
+    if (!m_active)
+    {
+        return;
+    }
+
+    auto & trace = Trace::instance();
+
+    m_event.name = name;
+    m_event.detail = detail;
+
+    if (trace.m_debugGroupsSupported)
+    {
+        const auto label = detail.empty() ? std::string(name) : std::string(name) + " " + detail;
+
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(label.size()), label.c_str());
+    }
+
+    m_event.gpuBeginQuery = trace.acquireQuery();
+    m_event.gpuEndQuery = trace.acquireQuery();
+
+    m_event.cpuBegin = trace.cpuTime();
+    glQueryCounter(m_event.gpuBeginQuery, GL_TIMESTAMP);
+}
+
+TraceZone::~TraceZone()
+{
+    if (!m_active)
+    {
+        return;
+    }
+
+    auto & trace = Trace::instance();
+
+    // The recording was stopped within this zone
+    if (!trace.recording())
+    {
+        glDeleteQueries(1, &m_event.gpuBeginQuery);
+        glDeleteQueries(1, &m_event.gpuEndQuery);
+    }
+    else
+    {
+        glQueryCounter(m_event.gpuEndQuery, GL_TIMESTAMP);
+        m_event.cpuEnd = trace.cpuTime();
+
+        trace.m_pending.push_back(m_event);
+    }
+
+    if (trace.m_debugGroupsSupported)
+    {
+        glPopDebugGroup();
+    }
+}
@@ -0,0 +1,94 @@
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glbinding/gl/types.h>
+
+
+class TraceEvent
+{
+public:
+    TraceEvent();
+
+    const char * name;
+    std::string detail;
+
+    // Nanoseconds since the start of the recording
+    long long cpuBegin;
+    long long cpuEnd;
+    long long gpuBegin;
+    long long gpuEnd;
+
+    gl::GLuint gpuBeginQuery;
+    gl::GLuint gpuEndQuery;
+};
+
+
+// Records scoped zones with CPU timestamps and GL_TIMESTAMP queries and writes them
+// as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+// GPU timestamps are resolved without blocking while recording; stop() waits for the rest.
+class Trace
+{
+public:
+    static Trace & instance();
+
+    bool recording() const;
+
+    void start();
+    void stop();
+
+    // Resolves the GPU timestamps that are already available
+    void collect();
+
+    // Adds to a count written as metadata of the trace, e.g., frames a GPUTimer could not time; does nothing while not recording
+    void count(const std::string & name, size_t value = 1);
+
+    bool write(const std::string & filename) const;
+
+protected:
+    friend class TraceZone;
+
+    bool m_recording;
+    bool m_debugGroupsSupported;
+
+    std::chrono::high_resolution_clock::time_point m_cpuStart;
+    gl::GLint64 m_gpuStart;
+
+    std::vector<gl::GLuint> m_queries;
+    std::deque<TraceEvent> m_pending;
+    std::vector<TraceEvent> m_events;
+    std::map<std::string, size_t> m_counts;
+
+    Trace();
+    ~Trace();
+
+    long long cpuTime() const;
+
+    gl::GLuint acquireQuery();
+    void resolve(TraceEvent & event);
+
+    void collect(bool wait);
+};
+
+
+// Records the lifetime of the object as a zone of the current trace; does nothing while not recording.
+// Zones have to be created on the thread owning the GL context.
+class TraceZone
+{
+public:
+    TraceZone(const char * name, const std::string & detail = std::string());
+    ~TraceZone();
+
+protected:
+    bool m_active;
+    TraceEvent m_event;
+
+private:
+    TraceZone(const TraceZone &);
+    TraceZone & operator=(const TraceZone &);
+};
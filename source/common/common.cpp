@@ -3,8 +3,11 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -17,6 +20,13 @@
 
 #include <cpplocate/cpplocate.h>
 
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/sysctl.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
 #include <glbinding/gl32core/gl.h>  // this is a OpenGL feature include; it declares all OpenGL 3.2 Core symbols
 
 using namespace gl;
@@ -28,6 +38,25 @@ namespace
 {
 
 
+#if defined(__linux__)
+size_t procStatusValue(const std::string & key)
+{
+    auto stream = std::ifstream("/proc/self/status");
+    auto line = std::string();
+
+    while (std::getline(stream, line))
+    {
+        if (line.compare(0, key.size(), key) == 0)
+        {
+            // Values are given in kB, e.g., "VmRSS:     1234 kB"
+            return static_cast<size_t>(std::strtoull(line.c_str() + key.size(), nullptr, 10)) * 1024;
+        }
+    }
+
+    return 0;
+}
+#endif
+
 std::string determineDataPath()
 {
     std::string path = cpplocate::locatePath("data/shaders", "share/attributedvertexclouds/shaders", reinterpret_cast<void *>(&dataPath));
@@ -96,6 +125,87 @@ std::string textFromFile(const std::string & filePath)
     return std::string(text.begin(), text.end());
 }
 
+std::vector<std::string> splitLine(const std::string & line, char separator)
+{
+    auto values = std::vector<std::string>();
+    auto stream = std::istringstream(line);
+    auto value = std::string();
+
+    while (std::getline(stream, value, separator))
+    {
+        values.push_back(value);
+    }
+
+    return values;
+}
+
+size_t parseCount(const std::string & text)
+{
+    auto end = static_cast<char *>(nullptr);
+    auto value = std::strtod(text.c_str(), &end);
+
+    if (end == text.c_str() || !(value >= 0.0))
+    {
+        return 0;
+    }
+
+    const auto suffix = std::string(end);
+
+    if (suffix == "k" || suffix == "K")
+    {
+        value *= 1e3;
+    }
+    else if (suffix == "M")
+    {
+        value *= 1e6;
+    }
+    else if (suffix == "G")
+    {
+        value *= 1e9;
+    }
+    else if (!suffix.empty())
+    {
+        return 0;
+    }
+
+    // Converting values beyond the range of size_t, or NaN, to an integer is undefined
+    if (!std::isfinite(value) || !(value + 0.5 < static_cast<double>(std::numeric_limits<size_t>::max())))
+    {
+        return 0;
+    }
+
+    return static_cast<size_t>(value + 0.5);
+}
+
+bool parseNonNegative(const std::string & text, double & value)
+{
+    auto end = static_cast<char *>(nullptr);
+    const auto parsed = std::strtod(text.c_str(), &end);
+
+    // Also rejects NaN, which fails every comparison
+    if (end == text.c_str() || *end != '\0' || !std::isfinite(parsed) || !(parsed >= 0.0))
+    {
+        return false;
+    }
+
+    value = parsed;
+
+    return true;
+}
+
+float hashValue(size_t index, size_t seed)
+{
+    auto x = static_cast<std::uint32_t>(index) * 0x9e3779b1u ^ static_cast<std::uint32_t>(seed) * 0x85ebca77u;
+
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+
+    return static_cast<float>(x) / 4294967295.0f;
+}
+
 std::string loadShaderSource(const std::string & shaderPath)
 {
     return textFromFile(dataPath() + "/shaders" + shaderPath);
@@ -166,6 +276,88 @@ bool checkForLinkerError(GLuint program, const std::string & identifier)
 
 }
 
+bool hasExtension(const std::string & extension)
+{
+    auto count = static_cast<GLint>(0);
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (auto i = 0; i < count; ++i)
+    {
+        const auto name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+
+        if (name != nullptr && extension == name)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t currentResidentSetSize()
+{
+#if defined(__linux__)
+    return procStatusValue("VmRSS:");
+#elif defined(__APPLE__)
+    auto info = mach_task_basic_info();
+    auto count = mach_msg_type_number_t(MACH_TASK_BASIC_INFO_COUNT);
+
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+    {
+        return 0;
+    }
+
+    return static_cast<size_t>(info.resident_size);
+#else
+    return 0;
+#endif
+}
+
+size_t peakResidentSetSize()
+{
+#if defined(__linux__)
+    return procStatusValue("VmHWM:");
+#elif defined(__APPLE__)
+    auto info = mach_task_basic_info();
+    auto count = mach_msg_type_number_t(MACH_TASK_BASIC_INFO_COUNT);
+
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+    {
+        return 0;
+    }
+
+    return static_cast<size_t>(info.resident_size_max);
+#else
+    return 0;
+#endif
+}
+
+void resetPeakResidentSetSize()
+{
+#if defined(__linux__)
+    // Resets VmHWM to the current resident set size (Linux 4.0 and later)
+    auto stream = std::ofstream("/proc/self/clear_refs");
+    stream << "5";
+#endif
+}
+
+size_t physicalMemorySize()
+{
+#if defined(__linux__)
+    const auto pages = sysconf(_SC_PHYS_PAGES);
+    const auto pageSize = sysconf(_SC_PAGESIZE);
+
+    return pages > 0 && pageSize > 0 ? static_cast<size_t>(pages) * static_cast<size_t>(pageSize) : 0;
+#elif defined(__APPLE__)
+    auto size = std::uint64_t(0);
+    auto length = sizeof(size);
+
+    return sysctlbyname("hw.memsize", &size, &length, nullptr, 0) == 0 ? static_cast<size_t>(size) : 0;
+#else
+    return 0;
+#endif
+}
+
 glm::vec3 cameraPath(const glm::vec3 & eye, float f)
 {
     auto eyeRotation = glm::mat4(1.0f);
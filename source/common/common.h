@@ -26,6 +26,17 @@ bool rawToFile(const std::string & filePath, const std::vector<char> & raw);
 
 std::string textFromFile(const std::string & filePath);
 
+std::vector<std::string> splitLine(const std::string & line, char separator);
+
+// Parses counts like "250000", "10k", "1.5M" or "2G"; returns zero for malformed input
+size_t parseCount(const std::string & text);
+
+// Parses a finite, non-negative number like "5" or "2.5"; returns false for malformed input
+bool parseNonNegative(const std::string & text, double & value);
+
+// Uniform value in [0, 1] per index and seed, for random choices that replay identically
+float hashValue(size_t index, size_t seed);
+
 std::string loadShaderSource(const std::string & shaderPath);
 std::vector<float> loadNoise(const std::string & noisePath);
 
@@ -35,4 +46,16 @@ bool createProgram(const std::string & name, gl::GLuint vertexShader, gl::GLuint
 bool checkForCompilationError(gl::GLuint shader, const std::string & identifier);
 bool checkForLinkerError(gl::GLuint program, const std::string & identifier);
 
+// Checks the extension list of the current context
+bool hasExtension(const std::string & extension);
+
+// Resident set size of this process in bytes, or zero where unsupported.
+// Resetting the peak needs Linux; elsewhere the peak covers the whole process lifetime.
+size_t currentResidentSetSize();
+size_t peakResidentSetSize();
+void resetPeakResidentSetSize();
+
+// Installed memory in bytes, or zero where unsupported
+size_t physicalMemorySize();
+
 glm::vec3 cameraPath(const glm::vec3 & eye, float f);